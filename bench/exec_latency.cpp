@@ -0,0 +1,63 @@
+#include "container_manager.hpp"
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+#define EXEC_LATENCY_ID "exec_latency"
+static unsigned long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + (unsigned long long)ts.tv_nsec;
+}
+int main(int argc, char *argv[]) {
+    int runs = argc > 1 ? atoi(argv[1]) : 500;
+    if (runs <= 0) {
+        fprintf(stderr, "Usage: %s [runs]\n", argv[0]);
+        return 1;
+    }
+    container_manager_t cm;
+    if (container_manager_init(&cm, 4) != 0) {
+        fprintf(stderr, "Error: container_manager_init failed\n");
+        return 1;
+    }
+    char *sleeper[] = {(char *)"/bin/sleep", (char *)"600", nullptr};
+    container_config_t config;
+    memset(&config, 0, sizeof(config));
+    namespace_config_init(&config.ns_config);
+    resource_limits_init(&config.res_limits);
+    fs_config_init(&config.fs_config);
+    config.id = (char *)EXEC_LATENCY_ID;
+    config.root_path = (char *)"/";
+    config.fs_config.root_path = (char *)"/";
+    config.command = sleeper;
+    config.command_argc = 2;
+    if (container_manager_run(&cm, &config) != 0) {
+        fprintf(stderr, "Error: failed to start the container\n");
+        container_manager_cleanup(&cm);
+        return 1;
+    }
+    char *command[] = {(char *)"/bin/true", nullptr};
+    std::vector<double> samples;
+    int result = 0;
+    for (int i = 0; i < runs; i++) {
+        unsigned long long begin = now_ns();
+        int ret = container_manager_exec(&cm, EXEC_LATENCY_ID, command, 1);
+        samples.push_back((now_ns() - begin) / 1e3);
+        if (ret != 0) {
+            fprintf(stderr, "Error: exec %d returned %d\n", i, ret);
+            result = 1;
+            break;
+        }
+    }
+    if (result == 0) {
+        std::sort(samples.begin(), samples.end());
+        size_t n = samples.size();
+        printf("exec /bin/true x%d: p50 %.0f us, p90 %.0f us, p99 %.0f us\n",
+               runs, samples[n / 2], samples[n * 9 / 10], samples[n * 99 / 100]);
+    }
+    container_manager_destroy(&cm, EXEC_LATENCY_ID);
+    container_manager_cleanup(&cm);
+    return result;
+}
@@ -0,0 +1,77 @@
+#include "container_manager.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#define GET_STATS_ID "get_stats"
+static unsigned long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + (unsigned long long)ts.tv_nsec;
+}
+static void config_init(container_config_t *config, char *id, char **command, int argc) {
+    memset(config, 0, sizeof(*config));
+    namespace_config_init(&config->ns_config);
+    resource_limits_init(&config->res_limits);
+    fs_config_init(&config->fs_config);
+    config->id = id;
+    config->root_path = (char *)"/";
+    config->fs_config.root_path = (char *)"/";
+    config->command = command;
+    config->command_argc = argc;
+}
+int main(int argc, char *argv[]) {
+    int calls = argc > 1 ? atoi(argv[1]) : 20000;
+    int churn = argc > 2 ? atoi(argv[2]) : 2000;
+    if (calls <= 0 || churn < 0) {
+        fprintf(stderr, "Usage: %s [calls] [containers]\n", argv[0]);
+        return 1;
+    }
+    container_manager_t cm;
+    if (container_manager_init(&cm, 16) != 0) {
+        fprintf(stderr, "Error: container_manager_init failed\n");
+        return 1;
+    }
+    char *sleeper[] = {(char *)"/bin/sleep", (char *)"60", nullptr};
+    container_config_t config;
+    config_init(&config, (char *)GET_STATS_ID, sleeper, 2);
+    if (container_manager_run(&cm, &config) != 0) {
+        fprintf(stderr, "Error: failed to start the container\n");
+        container_manager_cleanup(&cm);
+        return 1;
+    }
+    int result = 0;
+    unsigned long cpu_usage = 0;
+    unsigned long memory_usage = 0;
+    int failed = 0;
+    unsigned long long begin = now_ns();
+    for (int i = 0; i < calls; i++) {
+        if (resource_manager_get_stats(cm.rm, GET_STATS_ID, &cpu_usage, &memory_usage) != 0) {
+            failed++;
+        }
+    }
+    unsigned long long elapsed = now_ns() - begin;
+    printf("resource_manager_get_stats: %.2f us per call, %d calls\n", elapsed / 1e3 / calls, calls);
+    if (failed) {
+        fprintf(stderr, "Error: %d of %d calls failed\n", failed, calls);
+        result = 1;
+    }
+    container_manager_destroy(&cm, GET_STATS_ID);
+    char id[32];
+    char *command[] = {(char *)"/bin/true", nullptr};
+    begin = now_ns();
+    for (int i = 0; i < churn && result == 0; i++) {
+        snprintf(id, sizeof(id), "get_stats%d", i);
+        config_init(&config, id, command, 1);
+        if (container_manager_create(&cm, &config) != 0 || container_manager_destroy(&cm, id) != 0) {
+            fprintf(stderr, "Error: create and destroy of container %s failed\n", id);
+            result = 1;
+        }
+    }
+    elapsed = now_ns() - begin;
+    if (churn > 0) {
+        printf("create+destroy: %.1f ms for %d containers\n", elapsed / 1e6, churn);
+    }
+    container_manager_cleanup(&cm);
+    return result;
+}
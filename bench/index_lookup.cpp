@@ -0,0 +1,80 @@
+#include "container_index.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+static unsigned long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + (unsigned long long)ts.tv_nsec;
+}
+static int run(int n, long lookups) {
+    container_index_t idx;
+    if (container_index_init(&idx, n) != 0) {
+        fprintf(stderr, "Error: container_index_init failed\n");
+        return -1;
+    }
+    char **ids = static_cast<char**>(calloc((size_t)n, sizeof(char*)));
+    if (!ids) {
+        perror("calloc failed");
+        container_index_cleanup(&idx);
+        return -1;
+    }
+    int result = 0;
+    for (int i = 0; i < n && result == 0; i++) {
+        ids[i] = static_cast<char*>(malloc(16));
+        if (!ids[i]) {
+            perror("malloc failed");
+            result = -1;
+            break;
+        }
+        snprintf(ids[i], 16, "%d", i + 1);
+        if (container_index_put_id(&idx, ids[i], i) != 0 || container_index_put_pid(&idx, 1000 + i, i) != 0) {
+            fprintf(stderr, "Error: container_index_put failed at %d\n", i);
+            result = -1;
+        }
+    }
+    if (result == 0) {
+        long misses = 0;
+        unsigned long long begin = now_ns();
+        for (long i = 0; i < lookups; i++) {
+            int slot = (int)(i % n);
+            if (container_index_lookup_id(&idx, ids[slot]) != slot) {
+                misses++;
+            }
+        }
+        unsigned long long by_id = now_ns() - begin;
+        begin = now_ns();
+        for (long i = 0; i < lookups; i++) {
+            int slot = (int)(i % n);
+            if (container_index_lookup_pid(&idx, 1000 + slot) != slot) {
+                misses++;
+            }
+        }
+        unsigned long long by_pid = now_ns() - begin;
+        printf("n=%-7d by id %6.1f ns  by pid %6.1f ns\n", n, (double)by_id / lookups, (double)by_pid / lookups);
+        if (misses) {
+            fprintf(stderr, "Error: %ld lookups returned the wrong slot\n", misses);
+            result = -1;
+        }
+    }
+    for (int i = 0; i < n; i++) {
+        free(ids[i]);
+    }
+    free(ids);
+    container_index_cleanup(&idx);
+    return result;
+}
+int main(int argc, char *argv[]) {
+    long lookups = argc > 1 ? atol(argv[1]) : 1000000;
+    if (lookups <= 0) {
+        fprintf(stderr, "Usage: %s [lookups]\n", argv[0]);
+        return 1;
+    }
+    static const int sizes[] = {10, 1000, 100000};
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        if (run(sizes[i], lookups) != 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
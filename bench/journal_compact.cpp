@@ -0,0 +1,279 @@
+#include "container_manager.hpp"
+#include "state_journal.hpp"
+#include <fcntl.h>
+#include <limits.h>
+#include <map>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+typedef std::map<std::string, int> live_set_t;
+static char snapshot_path[PATH_MAX];
+static char journal_path[PATH_MAX];
+static char rotated_path[PATH_MAX];
+static int append(state_journal_t *journal, live_set_t *live, state_record_op_t op, const char *id, int pid) {
+    state_record_t rec;
+    state_record_init(&rec, op, id);
+    rec.pid = pid;
+    if (state_journal_append(journal, &rec) != 0) {
+        fprintf(stderr, "Error: failed to append a record for %s\n", id);
+        return -1;
+    }
+    if (op == STATE_RECORD_REMOVE) {
+        live->erase(id);
+    } else {
+        (*live)[id] = pid;
+    }
+    return 0;
+}
+static int compact(state_journal_t *journal, const live_set_t &live, int wait) {
+    std::vector<state_record_t> records;
+    for (live_set_t::const_iterator it = live.begin(); it != live.end(); ++it) {
+        state_record_t rec;
+        state_record_init(&rec, STATE_RECORD_UPSERT, it->first.c_str());
+        rec.pid = it->second;
+        records.push_back(rec);
+    }
+    return state_journal_compact(journal, records.data(), (int)records.size(), wait);
+}
+static int check_load(const char *what, const live_set_t &expected) {
+    state_journal_t *journal = state_journal_open(snapshot_path, journal_path);
+    if (!journal) {
+        fprintf(stderr, "Error: %s: failed to reopen the journal\n", what);
+        return -1;
+    }
+    state_record_t *records = nullptr;
+    int count = 0;
+    int result = 0;
+    if (state_journal_load(journal, &records, &count) != 0) {
+        fprintf(stderr, "Error: %s: failed to load the journal\n", what);
+        result = -1;
+    } else if (count != (int)expected.size()) {
+        fprintf(stderr, "Error: %s: loaded %d records, expected %zu\n", what, count, expected.size());
+        result = -1;
+    }
+    for (int i = 0; i < count && result == 0; i++) {
+        live_set_t::const_iterator it = expected.find(records[i].id);
+        if (it == expected.end() || it->second != records[i].pid) {
+            fprintf(stderr, "Error: %s: unexpected record %s pid %d\n", what, records[i].id, records[i].pid);
+            result = -1;
+        }
+    }
+    free(records);
+    state_journal_close(journal);
+    if (result == 0) {
+        printf("%s: %zu records\n", what, expected.size());
+    }
+    return result;
+}
+static int check_journal(int records, live_set_t &live) {
+    state_journal_t *journal = state_journal_open(snapshot_path, journal_path);
+    if (!journal) {
+        fprintf(stderr, "Error: failed to open the journal\n");
+        return -1;
+    }
+    char id[32];
+    int compactions = 0;
+    int result = 0;
+    for (int i = 0; i < records && result == 0; i++) {
+        snprintf(id, sizeof(id), "c%d", i % 700);
+        result = append(journal, &live, i % 3 == 2 ? STATE_RECORD_REMOVE : STATE_RECORD_UPSERT, id, i);
+        if (result == 0 && state_journal_should_compact(journal, (int)live.size())) {
+            result = compact(journal, live, i % 2);
+            compactions++;
+        }
+    }
+    state_journal_close(journal);
+    if (result != 0 || check_load("append and compact", live) != 0) {
+        return -1;
+    }
+    printf("%d compactions\n", compactions);
+    journal = state_journal_open(snapshot_path, journal_path);
+    if (!journal) {
+        fprintf(stderr, "Error: failed to reopen the journal\n");
+        return -1;
+    }
+    state_record_t *loaded = nullptr;
+    int count = 0;
+    if (state_journal_load(journal, &loaded, &count) != 0) {
+        fprintf(stderr, "Error: failed to load the journal\n");
+        state_journal_close(journal);
+        return -1;
+    }
+    free(loaded);
+    for (int i = 0; i < 50 && result == 0; i++) {
+        snprintf(id, sizeof(id), "r%d", i);
+        result = append(journal, &live, STATE_RECORD_UPSERT, id, i);
+    }
+    state_journal_close(journal);
+    if (result != 0 || rename(journal_path, rotated_path) != 0) {
+        perror("rename journal failed");
+        return -1;
+    }
+    if (check_load("leftover rotated journal", live) != 0) {
+        return -1;
+    }
+    if (access(rotated_path, F_OK) == 0) {
+        fprintf(stderr, "Error: the rotated journal was not folded into the snapshot\n");
+        return -1;
+    }
+    int fd = open(journal_path, O_WRONLY | O_APPEND);
+    if (fd < 0 || write(fd, "torn", 4) != 4) {
+        perror("write torn tail failed");
+        if (fd >= 0) {
+            close(fd);
+        }
+        return -1;
+    }
+    close(fd);
+    return check_load("torn tail", live);
+}
+static int check_failed_snapshot(live_set_t &live) {
+    state_journal_t *journal = state_journal_open(snapshot_path, journal_path);
+    if (!journal) {
+        fprintf(stderr, "Error: failed to reopen the journal\n");
+        return -1;
+    }
+    state_record_t *loaded = nullptr;
+    int count = 0;
+    if (state_journal_load(journal, &loaded, &count) != 0) {
+        fprintf(stderr, "Error: failed to load the journal\n");
+        state_journal_close(journal);
+        return -1;
+    }
+    free(loaded);
+    std::string blocker = std::string(snapshot_path) + ".tmp";
+    if (mkdir(blocker.c_str(), 0755) != 0) {
+        perror("mkdir failed");
+        state_journal_close(journal);
+        return -1;
+    }
+    char id[32];
+    int result = 0;
+    for (int round = 0; round < 2 && result == 0; round++) {
+        for (int i = 0; i < 50 && result == 0; i++) {
+            snprintf(id, sizeof(id), "f%d", round * 50 + i);
+            result = append(journal, &live, STATE_RECORD_UPSERT, id, i);
+        }
+        if (result == 0) {
+            result = compact(journal, live, 1);
+        }
+    }
+    state_journal_close(journal);
+    rmdir(blocker.c_str());
+    if (result != 0) {
+        fprintf(stderr, "Error: compaction failed while the snapshot could not be written\n");
+        return -1;
+    }
+    return check_load("failed snapshot writes", live);
+}
+static int check_lock() {
+    state_journal_t *journal = state_journal_open(snapshot_path, journal_path);
+    if (!journal) {
+        fprintf(stderr, "Error: failed to reopen the journal\n");
+        return -1;
+    }
+    state_journal_t *second = state_journal_open(snapshot_path, journal_path);
+    state_journal_close(journal);
+    if (second) {
+        fprintf(stderr, "Error: a second open of a held journal succeeded\n");
+        state_journal_close(second);
+        return -1;
+    }
+    second = state_journal_open(snapshot_path, journal_path);
+    if (!second) {
+        fprintf(stderr, "Error: the journal stayed locked after close\n");
+        return -1;
+    }
+    state_journal_close(second);
+    printf("lock: second manager refused\n");
+    return 0;
+}
+static int check_manager(int containers) {
+    container_manager_t cm;
+    if (container_manager_init(&cm, 16) != 0) {
+        fprintf(stderr, "Error: container_manager_init failed\n");
+        return -1;
+    }
+    int existing = cm.container_count;
+    char id[32];
+    char *command[] = {(char *)"/bin/true", nullptr};
+    int result = 0;
+    int created = 0;
+    for (int i = 0; i < containers && result == 0; i++) {
+        container_config_t config;
+        memset(&config, 0, sizeof(config));
+        namespace_config_init(&config.ns_config);
+        resource_limits_init(&config.res_limits);
+        fs_config_init(&config.fs_config);
+        snprintf(id, sizeof(id), "journal%d", i);
+        config.id = id;
+        config.root_path = (char *)"/";
+        config.fs_config.root_path = (char *)"/";
+        config.command = command;
+        config.command_argc = 1;
+        if (container_manager_create(&cm, &config) != 0) {
+            fprintf(stderr, "Error: failed to create container %s\n", id);
+            result = -1;
+            break;
+        }
+        created++;
+    }
+    for (int i = 0; i < created; i++) {
+        snprintf(id, sizeof(id), "journal%d", i);
+        if (container_manager_destroy(&cm, id) != 0) {
+            fprintf(stderr, "Error: failed to destroy container %s\n", id);
+            result = -1;
+        }
+    }
+    container_manager_cleanup(&cm);
+    if (container_manager_init(&cm, 16) != 0) {
+        fprintf(stderr, "Error: container_manager_init failed\n");
+        return -1;
+    }
+    if (cm.container_count != existing) {
+        fprintf(stderr, "Error: %d destroyed containers came back from the state file\n",
+                cm.container_count - existing);
+        result = -1;
+    }
+    container_manager_cleanup(&cm);
+    if (result == 0) {
+        printf("manager: %d containers created and destroyed, none reloaded\n", created);
+    }
+    return result;
+}
+int main(int argc, char *argv[]) {
+    int records = argc > 1 ? atoi(argv[1]) : 20000;
+    int containers = argc > 2 ? atoi(argv[2]) : 1200;
+    if (records <= 0 || containers < 0) {
+        fprintf(stderr, "Usage: %s [records] [containers]\n", argv[0]);
+        return 1;
+    }
+    char dir[] = "/tmp/journal_compact.XXXXXX";
+    if (!mkdtemp(dir)) {
+        perror("mkdtemp failed");
+        return 1;
+    }
+    snprintf(snapshot_path, sizeof(snapshot_path), "%s/state.snap", dir);
+    snprintf(journal_path, sizeof(journal_path), "%s/state.journal", dir);
+    snprintf(rotated_path, sizeof(rotated_path), "%s/state.journal.1", dir);
+    live_set_t live;
+    int result = check_journal(records, live);
+    if (result == 0) {
+        result = check_failed_snapshot(live);
+    }
+    if (result == 0) {
+        result = check_lock();
+    }
+    unlink(snapshot_path);
+    unlink(journal_path);
+    unlink(rotated_path);
+    rmdir(dir);
+    if (result == 0 && containers > 0) {
+        result = check_manager(containers);
+    }
+    return result == 0 ? 0 : 1;
+}
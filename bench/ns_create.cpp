@@ -0,0 +1,114 @@
+#include "ns_pool.hpp"
+#include <algorithm>
+#include <sched.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mount.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+static char child_stack[64 * 1024];
+static unsigned long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + (unsigned long long)ts.tv_nsec;
+}
+static int child_main(void *arg) {
+    (void)arg;
+    return 0;
+}
+static void report(const char *what, const char *kind, std::vector<double> *samples) {
+    std::sort(samples->begin(), samples->end());
+    size_t n = samples->size();
+    printf("%-11s %-7s p50 %8.1f us  p90 %8.1f us\n", what, kind, (*samples)[n / 2], (*samples)[n * 9 / 10]);
+}
+int main(int argc, char *argv[]) {
+    int runs = argc > 1 ? atoi(argv[1]) : 200;
+    if (runs < 2) {
+        fprintf(stderr, "Usage: %s [runs]\n", argv[0]);
+        return 1;
+    }
+    static const int clone_types[] = {0, NS_PID, NS_MNT, NS_UTS, NS_IPC, NS_CGROUP, NS_NET, NS_USER};
+    std::vector<double> samples;
+    for (size_t k = 0; k < sizeof(clone_types) / sizeof(clone_types[0]); k++) {
+        samples.clear();
+        for (int i = 0; i < runs; i++) {
+            unsigned long long begin = now_ns();
+            pid_t pid = clone(child_main, child_stack + sizeof(child_stack), clone_types[k] | SIGCHLD, nullptr);
+            if (pid < 0) {
+                perror("clone failed");
+                return 1;
+            }
+            waitpid(pid, nullptr, 0);
+            samples.push_back((now_ns() - begin) / 1e3);
+        }
+        report("clone+wait", clone_types[k] ? namespace_kind_name(clone_types[k]) : "none", &samples);
+    }
+    static const int detached_types[] = {NS_UTS, NS_IPC, NS_CGROUP, NS_NET, NS_USER};
+    for (size_t k = 0; k < sizeof(detached_types) / sizeof(detached_types[0]); k++) {
+        samples.clear();
+        for (int i = 0; i < runs; i++) {
+            unsigned long long begin = now_ns();
+            int fd = namespace_create_detached(detached_types[k]);
+            samples.push_back((now_ns() - begin) / 1e3);
+            if (fd < 0) {
+                fprintf(stderr, "Error: failed to create a %s namespace\n", namespace_kind_name(detached_types[k]));
+                return 1;
+            }
+            close(fd);
+        }
+        report("detached", namespace_kind_name(detached_types[k]), &samples);
+    }
+    char dir[] = "/tmp/ns_create.XXXXXX";
+    if (!mkdtemp(dir)) {
+        perror("mkdtemp failed");
+        return 1;
+    }
+    int result = 0;
+    ns_pool_t *pool = ns_pool_create(dir, runs);
+    if (!pool) {
+        fprintf(stderr, "Error: ns_pool_create failed\n");
+        result = 1;
+    }
+    static const int pooled_types[] = {NS_NET, NS_USER};
+    for (size_t k = 0; pool && k < sizeof(pooled_types) / sizeof(pooled_types[0]); k++) {
+        int fd = ns_pool_acquire(pool, pooled_types[k]);
+        if (fd >= 0) {
+            close(fd);
+        }
+        ns_pool_stats_t stats;
+        unsigned long long deadline = now_ns() + 30ULL * 1000000000ULL;
+        do {
+            usleep(10000);
+            ns_pool_get_stats(pool, &stats);
+        } while ((pooled_types[k] == NS_NET ? stats.idle_net : stats.idle_user) < runs && now_ns() < deadline);
+        samples.clear();
+        for (int i = 0; i < runs / 2; i++) {
+            unsigned long long begin = now_ns();
+            fd = ns_pool_acquire(pool, pooled_types[k]);
+            samples.push_back((now_ns() - begin) / 1e3);
+            if (fd < 0) {
+                fprintf(stderr, "Error: ns_pool_acquire failed\n");
+                result = 1;
+                break;
+            }
+            close(fd);
+        }
+        if (result == 0) {
+            report("pooled", namespace_kind_name(pooled_types[k]), &samples);
+        }
+    }
+    if (pool) {
+        ns_pool_stats_t stats;
+        ns_pool_get_stats(pool, &stats);
+        printf("pool hits %lu, misses %lu\n", stats.hits, stats.misses);
+        ns_pool_destroy(pool);
+    }
+    umount2(dir, MNT_DETACH);
+    if (rmdir(dir) != 0) {
+        perror("rmdir failed");
+    }
+    return result;
+}
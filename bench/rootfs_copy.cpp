@@ -0,0 +1,100 @@
+#include "filesystem_manager.hpp"
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+static const char *const rootfs_files[] = {
+    "/bin/dash",
+    "/bin/bash",
+    "/lib64/ld-linux-x86-64.so.2",
+    "/lib/x86_64-linux-gnu/libc.so.6",
+};
+#define ROOTFS_FILE_COUNT (int)(sizeof(rootfs_files) / sizeof(rootfs_files[0]))
+static unsigned long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + (unsigned long long)ts.tv_nsec;
+}
+static int copy_root(const char *dir, int run, fs_copy_method_t *method) {
+    char root[PATH_MAX / 2];
+    char dst[PATH_MAX];
+    snprintf(root, sizeof(root), "%s/root%d", dir, run);
+    if (mkdir(root, 0755) != 0) {
+        perror("mkdir failed");
+        return -1;
+    }
+    int result = 0;
+    for (int i = 0; i < ROOTFS_FILE_COUNT && result == 0; i++) {
+        snprintf(dst, sizeof(dst), "%s/%d", root, i);
+        if (fs_copy_file(rootfs_files[i], dst, method) != 0) {
+            fprintf(stderr, "Error: failed to copy %s\n", rootfs_files[i]);
+            result = -1;
+        }
+    }
+    for (int i = 0; i < ROOTFS_FILE_COUNT; i++) {
+        snprintf(dst, sizeof(dst), "%s/%d", root, i);
+        unlink(dst);
+    }
+    rmdir(root);
+    return result;
+}
+static int check_sparse(const char *dir) {
+    char src[PATH_MAX];
+    char dst[PATH_MAX];
+    snprintf(src, sizeof(src), "%s/sparse", dir);
+    snprintf(dst, sizeof(dst), "%s/sparse.copy", dir);
+    int fd = open(src, O_WRONLY | O_CREAT | O_TRUNC, 0640);
+    if (fd < 0) {
+        perror("open failed");
+        return -1;
+    }
+    int result = 0;
+    if (pwrite(fd, "x", 1, 0) != 1 || pwrite(fd, "y", 1, 64L << 20) != 1) {
+        perror("pwrite failed");
+        result = -1;
+    }
+    close(fd);
+    fs_copy_method_t method = FS_COPY_BUFFERED;
+    struct stat src_st;
+    struct stat dst_st;
+    if (result == 0 && (fs_copy_file(src, dst, &method) != 0 || stat(src, &src_st) != 0 || stat(dst, &dst_st) != 0)) {
+        fprintf(stderr, "Error: failed to copy the sparse file\n");
+        result = -1;
+    }
+    if (result == 0) {
+        printf("64 MiB sparse file: %ld blocks -> %ld blocks, mode %o -> %o, via %s\n",
+               (long)src_st.st_blocks, (long)dst_st.st_blocks, src_st.st_mode & 07777, dst_st.st_mode & 07777,
+               fs_copy_method_name(method));
+        if (dst_st.st_size != src_st.st_size || dst_st.st_blocks > 2 * src_st.st_blocks ||
+            (dst_st.st_mode & 07777) != (src_st.st_mode & 07777)) {
+            fprintf(stderr, "Error: the copy lost its holes, size or mode\n");
+            result = -1;
+        }
+    }
+    unlink(src);
+    unlink(dst);
+    return result;
+}
+int main(int argc, char *argv[]) {
+    const char *dir = argc > 1 ? argv[1] : "/tmp";
+    int runs = argc > 2 ? atoi(argv[2]) : 200;
+    if (runs <= 0) {
+        fprintf(stderr, "Usage: %s [dir] [runs]\n", argv[0]);
+        return 1;
+    }
+    fs_copy_method_t method = FS_COPY_BUFFERED;
+    unsigned long long begin = now_ns();
+    for (int i = 0; i < runs; i++) {
+        if (copy_root(dir, i, &method) != 0) {
+            return 1;
+        }
+    }
+    unsigned long long elapsed = now_ns() - begin;
+    printf("%s: %.0f us per root of %d files, via %s\n", dir, elapsed / 1e3 / runs, ROOTFS_FILE_COUNT,
+           fs_copy_method_name(method));
+    return check_sparse(dir) == 0 ? 0 : 1;
+}
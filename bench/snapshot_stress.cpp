@@ -0,0 +1,145 @@
+#include "container_manager.hpp"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#define STRESS_READERS 4
+typedef struct {
+    container_manager_t *cm;
+    volatile int *stop;
+    long reads;
+    long torn;
+    long regressions;
+} reader_t;
+static unsigned long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + (unsigned long long)ts.tv_nsec;
+}
+static void *reader_thread(void *arg) {
+    reader_t *reader = static_cast<reader_t*>(arg);
+    uint64_t last_version = 0;
+    while (!__atomic_load_n(reader->stop, __ATOMIC_ACQUIRE)) {
+        uint64_t ticket;
+        const container_snapshot_t *snap = container_manager_snapshot_acquire(reader->cm, &ticket);
+        if (snap) {
+            if (snap->version < last_version) {
+                reader->regressions++;
+            }
+            last_version = snap->version;
+            for (int i = 0; i < snap->count; i++) {
+                const container_view_t *view = &snap->containers[i];
+                if (view->id[0] == '\0' || view->state < CONTAINER_CREATED || view->state > CONTAINER_DESTROYED) {
+                    reader->torn++;
+                }
+            }
+        }
+        container_manager_snapshot_release(reader->cm, ticket);
+        reader->reads++;
+    }
+    return nullptr;
+}
+int main(int argc, char *argv[]) {
+    int rounds = argc > 1 ? atoi(argv[1]) : 2000;
+    if (rounds <= 0) {
+        fprintf(stderr, "Usage: %s [containers]\n", argv[0]);
+        return 1;
+    }
+    container_manager_t cm;
+    if (container_manager_init(&cm, 16) != 0) {
+        fprintf(stderr, "Error: container_manager_init failed\n");
+        return 1;
+    }
+    int existing = cm.container_count;
+    volatile int stop = 0;
+    reader_t readers[STRESS_READERS];
+    pthread_t threads[STRESS_READERS];
+    int started = 0;
+    for (int i = 0; i < STRESS_READERS; i++) {
+        memset(&readers[i], 0, sizeof(readers[i]));
+        readers[i].cm = &cm;
+        readers[i].stop = &stop;
+        if (pthread_create(&threads[i], nullptr, reader_thread, &readers[i]) != 0) {
+            perror("pthread_create failed");
+            break;
+        }
+        started++;
+    }
+    int result = started == STRESS_READERS ? 0 : 1;
+    char id[32];
+    char *command[] = {(char *)"/bin/true", nullptr};
+    unsigned long long begin = now_ns();
+    int created = 0;
+    for (int i = 0; i < rounds && result == 0; i++) {
+        container_config_t config;
+        memset(&config, 0, sizeof(config));
+        namespace_config_init(&config.ns_config);
+        resource_limits_init(&config.res_limits);
+        fs_config_init(&config.fs_config);
+        snprintf(id, sizeof(id), "stress%d", i);
+        config.id = id;
+        config.root_path = (char *)"/";
+        config.fs_config.root_path = (char *)"/";
+        config.command = command;
+        config.command_argc = 1;
+        if (container_manager_create(&cm, &config) != 0) {
+            fprintf(stderr, "Error: failed to create container %s\n", id);
+            result = 1;
+            break;
+        }
+        created++;
+        if (i % 3 == 0 && container_manager_destroy(&cm, id) != 0) {
+            fprintf(stderr, "Error: failed to destroy container %s\n", id);
+            result = 1;
+        }
+    }
+    for (int i = 0; i < created; i++) {
+        if (i % 3 == 0) {
+            continue;
+        }
+        snprintf(id, sizeof(id), "stress%d", i);
+        if (container_manager_destroy(&cm, id) != 0) {
+            fprintf(stderr, "Error: failed to destroy container %s\n", id);
+            result = 1;
+        }
+    }
+    unsigned long long elapsed = now_ns() - begin;
+    __atomic_store_n(&stop, 1, __ATOMIC_RELEASE);
+    long reads = 0;
+    long torn = 0;
+    long regressions = 0;
+    for (int i = 0; i < started; i++) {
+        pthread_join(threads[i], nullptr);
+        reads += readers[i].reads;
+        torn += readers[i].torn;
+        regressions += readers[i].regressions;
+    }
+    int count = 0;
+    int left = 0;
+    container_info_t **containers = container_manager_list(&cm, &count);
+    for (int i = 0; i < count; i++) {
+        if (strncmp(containers[i]->id, "stress", 6) == 0) {
+            left++;
+        }
+    }
+    printf("%d creates and destroys in %.1f ms, %llu versions, %ld reads\n",
+           created, elapsed / 1e6, (unsigned long long)cm.snapshot_version, reads);
+    if (torn || regressions || left) {
+        fprintf(stderr, "Error: %ld torn views, %ld version regressions, %d containers left\n",
+                torn, regressions, left);
+        result = 1;
+    }
+    container_manager_cleanup(&cm);
+    if (container_manager_init(&cm, 16) != 0) {
+        fprintf(stderr, "Error: container_manager_init failed\n");
+        return 1;
+    }
+    if (cm.container_count != existing) {
+        fprintf(stderr, "Error: %d destroyed containers came back from the state file\n",
+                cm.container_count - existing);
+        result = 1;
+    }
+    container_manager_cleanup(&cm);
+    return result;
+}
@@ -0,0 +1,104 @@
+#include "container_manager.hpp"
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+#define STOP_TREE_ID "stop_tree"
+static unsigned long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + (unsigned long long)ts.tv_nsec;
+}
+static int read_procs(container_manager_t *cm, std::vector<pid_t> *pids) {
+    char path[512];
+    if (cm->rm->version == CGROUP_V2) {
+        snprintf(path, sizeof(path), "/sys/fs/cgroup/%s_%s/cgroup.procs", cm->rm->cgroup_path, STOP_TREE_ID);
+    } else {
+        snprintf(path, sizeof(path), "/sys/fs/cgroup/memory/%s_%s/cgroup.procs", cm->rm->cgroup_path, STOP_TREE_ID);
+    }
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+        return -1;
+    }
+    pids->clear();
+    pid_t pid;
+    while (fscanf(fp, "%d", &pid) == 1) {
+        pids->push_back(pid);
+    }
+    fclose(fp);
+    return 0;
+}
+int main(int argc, char *argv[]) {
+    int children = argc > 1 ? atoi(argv[1]) : 1000;
+    int timeout_ms = argc > 2 ? atoi(argv[2]) : 200;
+    if (children <= 0 || timeout_ms < 0) {
+        fprintf(stderr, "Usage: %s [children] [stop_timeout_ms]\n", argv[0]);
+        return 1;
+    }
+    container_manager_t cm;
+    if (container_manager_init(&cm, 4) != 0) {
+        fprintf(stderr, "Error: container_manager_init failed\n");
+        return 1;
+    }
+    container_manager_set_stop_timeout(&cm, timeout_ms);
+    char script[256];
+    snprintf(script, sizeof(script),
+             "i=0; while [ $i -lt %d ]; do sleep 600 & i=$((i+1)); done; wait", children);
+    char *command[] = {(char *)"/bin/sh", (char *)"-c", script, nullptr};
+    container_config_t config;
+    memset(&config, 0, sizeof(config));
+    namespace_config_init(&config.ns_config);
+    resource_limits_init(&config.res_limits);
+    config.res_limits.memory.limit_bytes = 1024UL * 1024 * 1024;
+    fs_config_init(&config.fs_config);
+    config.id = (char *)STOP_TREE_ID;
+    config.root_path = (char *)"/";
+    config.fs_config.root_path = (char *)"/";
+    config.command = command;
+    config.command_argc = 3;
+    if (container_manager_run(&cm, &config) != 0) {
+        fprintf(stderr, "Error: failed to start the container\n");
+        container_manager_cleanup(&cm);
+        return 1;
+    }
+    std::vector<pid_t> pids;
+    unsigned long long deadline = now_ns() + 60ULL * 1000000000ULL;
+    while (read_procs(&cm, &pids) == 0 && (int)pids.size() < children + 1 && now_ns() < deadline) {
+        usleep(10000);
+    }
+    int result = 0;
+    if ((int)pids.size() < children + 1) {
+        fprintf(stderr, "Error: only %zu of %d processes started\n", pids.size(), children + 1);
+        result = 1;
+    }
+    unsigned long long begin = now_ns();
+    if (container_manager_stop(&cm, STOP_TREE_ID) != 0) {
+        fprintf(stderr, "Error: container_manager_stop failed\n");
+        result = 1;
+    }
+    unsigned long long elapsed = now_ns() - begin;
+    std::vector<pid_t> left;
+    if (read_procs(&cm, &left) == 0 && !left.empty()) {
+        fprintf(stderr, "Error: %zu processes left in the cgroup\n", left.size());
+        result = 1;
+    }
+    size_t alive = 0;
+    for (size_t i = 0; i < pids.size(); i++) {
+        if (kill(pids[i], 0) == 0 || errno != ESRCH) {
+            alive++;
+        }
+    }
+    if (alive) {
+        fprintf(stderr, "Error: %zu processes of the tree are still alive\n", alive);
+        result = 1;
+    }
+    printf("cgroup v%d: stopped %zu processes in %.1f ms (stop timeout %d ms)\n",
+           cm.rm->version == CGROUP_V2 ? 2 : 1, pids.size(), elapsed / 1e6, timeout_ms);
+    container_manager_destroy(&cm, STOP_TREE_ID);
+    container_manager_cleanup(&cm);
+    return result;
+}
@@ -0,0 +1,32 @@
+#ifndef CONTAINER_INDEX_HPP
+#define CONTAINER_INDEX_HPP
+#include <sys/types.h>
+typedef struct {
+    const char *key;
+    unsigned int hash;
+    int slot;
+} container_index_entry_t;
+typedef struct {
+    container_index_entry_t *entries;
+    int capacity;
+    int count;
+} container_index_table_t;
+typedef struct {
+    container_index_table_t by_id;
+    container_index_table_t by_pid;
+} container_index_t;
+#ifdef __cplusplus
+extern "C" {
+#endif
+int container_index_init(container_index_t *idx, int expected);
+void container_index_cleanup(container_index_t *idx);
+int container_index_lookup_id(const container_index_t *idx, const char *id);
+int container_index_lookup_pid(const container_index_t *idx, pid_t pid);
+int container_index_put_id(container_index_t *idx, const char *id, int slot);
+int container_index_put_pid(container_index_t *idx, pid_t pid, int slot);
+void container_index_erase_id(container_index_t *idx, const char *id);
+void container_index_erase_pid(container_index_t *idx, pid_t pid, int slot);
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -3,12 +3,28 @@
 #include "namespace_handler.hpp"
 #include "resource_manager.hpp"
 #include "filesystem_manager.hpp"
+#include "container_index.hpp"
+#include "state_journal.hpp"
+#include "reaper.hpp"
+#include "slab_allocator.hpp"
+#include "container_pool.hpp"
+#include "ns_pool.hpp"
+#include "event_bus.hpp"
+#include "start_trace.hpp"
+#include "rootfs_cache.hpp"
+#include "zygote.hpp"
 #include <sys/types.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <time.h>
+#define CONTAINER_VIEW_ID_MAX 64
+#define CONTAINER_NOT_FOUND -2
 typedef enum {
     CONTAINER_CREATED,
     CONTAINER_RUNNING,
     CONTAINER_STOPPED,
-    CONTAINER_DESTROYED
+    CONTAINER_DESTROYED,
+    CONTAINER_PAUSED
 } container_state_t;
 typedef struct {
     char *id;
@@ -27,13 +43,55 @@ typedef struct {
     time_t started_at;
     time_t stopped_at;
     container_config_t *saved_config;
+    namespace_fds_t ns_fds;
+    start_trace_t start_trace;
 } container_info_t;
+typedef struct {
+    char id[CONTAINER_VIEW_ID_MAX];
+    pid_t pid;
+    container_state_t state;
+    time_t created_at;
+    time_t started_at;
+    time_t stopped_at;
+    start_trace_t start_trace;
+    fs_isolation_method_t fs_method;
+} container_view_t;
+typedef struct container_snapshot {
+    container_view_t *containers;
+    int count;
+    uint64_t version;
+    uint64_t retired_epoch;
+    struct container_snapshot *next_retired;
+} container_snapshot_t;
 typedef struct container_manager {
     resource_manager_t *rm;
     container_info_t **containers;
     int container_count;
     int max_containers;
+    container_index_t index;
+    int max_numeric_id;
+    state_journal_t *journal;
+    reaper_t *reaper;
+    slab_allocator_t *slab;
+    container_pool_t *pool;
+    ns_pool_t *ns_pool;
+    rootfs_cache_t *rootfs_cache;
+    zygote_t *zygote;
+    int zygote_flags;
+    event_bus_t *events;
+    start_histogram_t start_stats;
+    pthread_t exit_watcher;
+    int stop_timeout_ms;
+    pthread_mutex_t lock;
+    int lock_depth;
+    int snapshot_dirty;
+    uint64_t snapshot_version;
+    container_snapshot_t *snapshot;
+    container_snapshot_t *retired;
+    uint64_t epoch;
+    long readers[2];
 } container_manager_t;
+typedef void (*container_batch_callback_t)(const char *container_id, int result, void *user_data);
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -43,15 +101,38 @@ int container_manager_create(container_manager_t *cm,
 int container_manager_start(container_manager_t *cm, const char *container_id);
 int container_manager_stop(container_manager_t *cm, const char *container_id);
 int container_manager_destroy(container_manager_t *cm, const char *container_id);
+int container_manager_pause(container_manager_t *cm, const char *container_id);
+int container_manager_resume(container_manager_t *cm, const char *container_id);
+int container_manager_wait(container_manager_t *cm, const char *container_id, int timeout_ms, int *status);
+void container_manager_set_stop_timeout(container_manager_t *cm, int timeout_ms);
+int container_manager_start_many(container_manager_t *cm, const char *const *container_ids, int count,
+                                 int *results, container_batch_callback_t callback, void *user_data);
+int container_manager_stop_many(container_manager_t *cm, const char *const *container_ids, int count,
+                                int timeout_ms, int *results, container_batch_callback_t callback,
+                                void *user_data);
+int container_manager_destroy_many(container_manager_t *cm, const char *const *container_ids, int count,
+                                   int *results, container_batch_callback_t callback, void *user_data);
 int container_manager_exec(container_manager_t *cm,
                           const char *container_id,
                           char **command,
                           int argc);
+pid_t container_manager_exec_spawn(container_manager_t *cm, const char *container_id, char **command,
+                                   const int *stdio_fds, int *pidfd);
 container_info_t **container_manager_list(container_manager_t *cm, int *count);
 container_info_t *container_manager_get_info(container_manager_t *cm,
                                            const char *container_id);
+const container_snapshot_t *container_manager_snapshot_acquire(container_manager_t *cm, uint64_t *ticket);
+void container_manager_snapshot_release(container_manager_t *cm, uint64_t ticket);
 void container_manager_cleanup(container_manager_t *cm);
 int container_manager_run(container_manager_t *cm, container_config_t *config);
+int container_manager_run_attached(container_manager_t *cm, container_config_t *config,
+                                   const int *stdio_fds);
+int container_manager_enable_pool(container_manager_t *cm, int low_watermark, int high_watermark);
+int container_manager_enable_ns_pool(container_manager_t *cm, int target);
+void container_manager_get_start_stats(container_manager_t *cm, start_histogram_t *stats);
+int container_manager_enable_zygote(container_manager_t *cm);
+int container_manager_enable_rootfs_cache(container_manager_t *cm, unsigned long long budget);
+void container_manager_get_rootfs_cache_stats(container_manager_t *cm, rootfs_cache_stats_t *stats);
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,29 @@
+#ifndef CONTAINER_POOL_HPP
+#define CONTAINER_POOL_HPP
+#include "namespace_handler.hpp"
+#include "resource_manager.hpp"
+#include <sys/types.h>
+#define CONTAINER_POOL_DEFAULT_LOW 2
+#define CONTAINER_POOL_DEFAULT_HIGH 8
+typedef struct container_pool container_pool_t;
+typedef struct {
+    int profiles;
+    int parked;
+    unsigned long claims;
+    unsigned long misses;
+} container_pool_stats_t;
+#ifdef __cplusplus
+extern "C" {
+#endif
+container_pool_t *container_pool_create(resource_manager_t *rm, int low_watermark, int high_watermark);
+void container_pool_destroy(container_pool_t *pool);
+int container_pool_add_profile(container_pool_t *pool, const namespace_config_t *ns_config,
+                               const resource_limits_t *limits);
+pid_t container_pool_claim(container_pool_t *pool, const namespace_config_t *ns_config,
+                           const resource_limits_t *limits, const char *container_id,
+                           char **command, const int *stdio_fds);
+void container_pool_get_stats(container_pool_t *pool, container_pool_stats_t *stats);
+#ifdef __cplusplus
+}
+#endif
+#endif
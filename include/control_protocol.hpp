@@ -0,0 +1,69 @@
+#ifndef CONTROL_PROTOCOL_HPP
+#define CONTROL_PROTOCOL_HPP
+#include <stdint.h>
+#include <sys/types.h>
+#define CONTROL_SOCKET_PATH "/var/run/mini-container/control.sock"
+#define CONTROL_SOCKET_PATH_FALLBACK "/tmp/mini-container-control.sock"
+#define CONTROL_ENV_SOCKET "MINI_CONTAINER_SOCKET"
+#define CONTROL_MAGIC 0x4d434350u
+#define CONTROL_VERSION 1
+#define CONTROL_MAX_PAYLOAD (1024 * 1024)
+#define CONTROL_MAX_FDS 3
+#define CONTROL_RUN_DETACH 0x1
+#define CONTROL_RUN_ATTACH_STDIO 0x2
+#define CONTROL_RUN_NET 0x4
+#define CONTROL_RUN_USERNS 0x8
+#define CONTROL_RUN_BIND_RO 0x10
+#define CONTROL_RUN_OVERLAY 0x20
+#define CONTROL_RUN_MINIMAL 0x40
+typedef enum {
+    CONTROL_OP_PING = 1,
+    CONTROL_OP_RUN = 2,
+    CONTROL_OP_START = 3,
+    CONTROL_OP_STOP = 4,
+    CONTROL_OP_DESTROY = 5,
+    CONTROL_OP_LIST = 6,
+    CONTROL_OP_INFO = 7,
+    CONTROL_OP_WAIT = 8,
+    CONTROL_OP_PAUSE = 9,
+    CONTROL_OP_RESUME = 10,
+    CONTROL_OP_EXEC = 11
+} control_op_t;
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t op;
+    int32_t status;
+    uint32_t length;
+} control_header_t;
+typedef struct {
+    char *data;
+    uint32_t size;
+    uint32_t capacity;
+    uint32_t offset;
+    int failed;
+} control_buffer_t;
+#ifdef __cplusplus
+extern "C" {
+#endif
+void control_buffer_init(control_buffer_t *buf);
+void control_buffer_reset(control_buffer_t *buf);
+void control_buffer_free(control_buffer_t *buf);
+void control_put_u32(control_buffer_t *buf, uint32_t value);
+void control_put_u64(control_buffer_t *buf, uint64_t value);
+void control_put_string(control_buffer_t *buf, const char *str);
+uint32_t control_get_u32(control_buffer_t *buf);
+uint64_t control_get_u64(control_buffer_t *buf);
+const char *control_get_string(control_buffer_t *buf);
+int control_send(int fd, uint16_t op, int32_t status, const control_buffer_t *payload,
+                 const int *fds, int fd_count);
+int control_recv(int fd, control_header_t *header, control_buffer_t *payload,
+                 int *fds, int *fd_count);
+const char *control_socket_path(void);
+int control_connect(void);
+int control_connect_path(const char *path);
+int control_listen(const char *path);
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,14 @@
+#ifndef CONTROL_SERVER_HPP
+#define CONTROL_SERVER_HPP
+#include "container_manager.hpp"
+#include "control_protocol.hpp"
+typedef struct control_server control_server_t;
+#ifdef __cplusplus
+extern "C" {
+#endif
+control_server_t *control_server_start(container_manager_t *cm, const char *path);
+void control_server_stop(control_server_t *server);
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,24 @@
+#ifndef ELF_CLOSURE_HPP
+#define ELF_CLOSURE_HPP
+#define ELF_CLOSURE_MAX_LINKS 40
+#define ELF_CLOSURE_CACHE_MAX 4096
+typedef struct {
+    char **paths;
+    int count;
+} elf_closure_t;
+typedef struct {
+    unsigned long hits;
+    unsigned long misses;
+    unsigned long objects;
+} elf_closure_stats_t;
+#ifdef __cplusplus
+extern "C" {
+#endif
+int elf_closure_resolve(const char *host_root, const char *const *binaries, int count, elf_closure_t *closure);
+void elf_closure_free(elf_closure_t *closure);
+void elf_closure_get_stats(elf_closure_stats_t *stats);
+void elf_closure_cache_clear(void);
+#ifdef __cplusplus
+}
+#endif
+#endif
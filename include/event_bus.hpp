@@ -0,0 +1,46 @@
+#ifndef EVENT_BUS_HPP
+#define EVENT_BUS_HPP
+#include <stdint.h>
+#include <sys/types.h>
+#define EVENT_BUS_DEFAULT_CAPACITY 1024
+#define CONTAINER_EVENT_ID_MAX 64
+typedef enum {
+    CONTAINER_EVENT_CREATED = 1,
+    CONTAINER_EVENT_STARTED,
+    CONTAINER_EVENT_EXITED,
+    CONTAINER_EVENT_STOPPED,
+    CONTAINER_EVENT_DESTROYED,
+    CONTAINER_EVENT_OOM,
+    CONTAINER_EVENT_PAUSED,
+    CONTAINER_EVENT_RESUMED
+} container_event_type_t;
+typedef struct {
+    uint64_t seq;
+    int32_t type;
+    int32_t pid;
+    int32_t exit_code;
+    int32_t signal;
+    int64_t time_ns;
+    char id[CONTAINER_EVENT_ID_MAX];
+} container_event_t;
+typedef struct {
+    uint64_t next;
+    uint64_t dropped;
+} event_cursor_t;
+typedef struct event_bus event_bus_t;
+#ifdef __cplusplus
+extern "C" {
+#endif
+event_bus_t *event_bus_create(unsigned int capacity);
+void event_bus_destroy(event_bus_t *bus);
+void event_bus_publish(event_bus_t *bus, container_event_type_t type, const char *container_id,
+                       pid_t pid, int exit_code, int signal);
+void event_bus_subscribe(event_bus_t *bus, event_cursor_t *cursor);
+int event_bus_poll(event_bus_t *bus, event_cursor_t *cursor, container_event_t *events, int max_events);
+int event_bus_wait(event_bus_t *bus, event_cursor_t *cursor, container_event_t *events, int max_events,
+                   int timeout_ms);
+const char *container_event_name(int type);
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -1,12 +1,26 @@
 #ifndef FILESYSTEM_MANAGER_HPP
 #define FILESYSTEM_MANAGER_HPP
+#include <stddef.h>
+#define FS_BIND_STAGING_DIR "/tmp"
+#define FS_OVERLAY_DIR "/var/lib/mini-container/overlay"
 typedef enum {
-    FS_CHROOT
+    FS_CHROOT,
+    FS_BIND_RO,
+    FS_OVERLAY
 } fs_isolation_method_t;
+typedef enum {
+    FS_COPY_CLONE,
+    FS_COPY_RANGE,
+    FS_COPY_SENDFILE,
+    FS_COPY_BUFFERED
+} fs_copy_method_t;
 typedef struct {
     char *root_path;
     fs_isolation_method_t method;
     int create_minimal_fs;
+    int enter_root;
+    int read_only_root;
+    char *lower_dirs;
 } fs_config_t;
 #ifdef __cplusplus
 extern "C" {
@@ -15,7 +29,26 @@ void fs_config_init(fs_config_t *config);
 int fs_create_minimal_root(const char *root_path);
 int fs_setup_chroot(const char *root_path);
 int fs_mount_container_filesystems(const char *root_path);
+int fs_enter_bind_root(const char *root_path);
+int fs_overlay_root_path(const fs_config_t *config, const char *container_id, char *path, size_t size);
+int fs_mount_overlay_root(const fs_config_t *config, const char *container_id);
+int fs_enter_root(const char *root_path);
+int fs_enter_read_only_root(const char *root_path);
+int fs_overlay_usage(const char *container_id, unsigned long long *bytes);
+int fs_unmount_overlay(const char *container_id);
+int fs_remove_overlay(const char *container_id);
+int fs_copy_file(const char *src, const char *dst, fs_copy_method_t *method);
+const char *fs_copy_method_name(fs_copy_method_t method);
+int fs_open_in_root(int root_fd, const char *path, int flags);
 int fs_populate_container_root(const char *root_path, const char *host_root);
+int fs_populate_container_binaries(const char *root_path, const char *host_root,
+                                   const char *const *binaries, int count);
+int fs_build_container_root(const char *root_path, const char *host_root,
+                            const char *const *binaries, int count);
+int fs_root_recipe(const char *host_root, const char *const *binaries, int count, char **recipe);
+int fs_mkdir_p(const char *path);
+int fs_tree_usage(const char *path, unsigned long long *bytes);
+int fs_remove_tree(const char *path);
 int fs_cleanup_container_root(const char *root_path);
 #ifdef __cplusplus
 }
@@ -0,0 +1,44 @@
+#ifndef LOGGER_HPP
+#define LOGGER_HPP
+#define LOG_LEVEL_TRACE 0
+#define LOG_LEVEL_DEBUG 1
+#define LOG_LEVEL_INFO 2
+#define LOG_LEVEL_WARN 3
+#define LOG_LEVEL_ERROR 4
+#define LOG_LEVEL_OFF 5
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL LOG_LEVEL_DEBUG
+#endif
+#define LOG_ENV_LEVEL "MINI_CONTAINER_LOG"
+#define LOG_ENV_FORMAT "MINI_CONTAINER_LOG_FORMAT"
+typedef enum {
+    LOG_FORMAT_TEXT,
+    LOG_FORMAT_JSON
+} log_format_t;
+#ifdef __cplusplus
+extern "C" {
+#endif
+int log_enabled(int level);
+void log_set_level(int level);
+int log_get_level(void);
+void log_set_format(log_format_t format);
+int log_parse_level(const char *name);
+void log_write(int level, const char *file, int line, const char *func, const char *fmt, ...)
+    __attribute__((format(printf, 5, 6)));
+void log_flush(void);
+void log_shutdown(void);
+#ifdef __cplusplus
+}
+#endif
+#define LOG_AT(level, fmt, ...) \
+    do { \
+        if ((level) >= LOG_COMPILE_LEVEL && log_enabled(level)) { \
+            log_write(level, __FILE__, __LINE__, __FUNCTION__, fmt, ##__VA_ARGS__); \
+        } \
+    } while (0)
+#define LOG_TRACE(fmt, ...) LOG_AT(LOG_LEVEL_TRACE, fmt, ##__VA_ARGS__)
+#define LOG_DEBUG(fmt, ...) LOG_AT(LOG_LEVEL_DEBUG, fmt, ##__VA_ARGS__)
+#define LOG_INFO(fmt, ...) LOG_AT(LOG_LEVEL_INFO, fmt, ##__VA_ARGS__)
+#define LOG_WARN(fmt, ...) LOG_AT(LOG_LEVEL_WARN, fmt, ##__VA_ARGS__)
+#define LOG_ERROR(fmt, ...) LOG_AT(LOG_LEVEL_ERROR, fmt, ##__VA_ARGS__)
+#endif
@@ -3,14 +3,36 @@
 #include <sched.h>
 #include <unistd.h>
 #include <sys/types.h>
+#include <stdint.h>
 typedef enum {
     NS_PID = CLONE_NEWPID,
-    NS_MNT = CLONE_NEWNS
+    NS_MNT = CLONE_NEWNS,
+    NS_UTS = CLONE_NEWUTS,
+    NS_IPC = CLONE_NEWIPC,
+    NS_NET = CLONE_NEWNET,
+    NS_USER = CLONE_NEWUSER,
+    NS_CGROUP = CLONE_NEWCGROUP
 } namespace_type_t;
-#define CONTAINER_NAMESPACES (NS_PID | NS_MNT)
+#define CONTAINER_NAMESPACES (NS_PID | NS_MNT | NS_UTS | NS_IPC | NS_CGROUP)
+#define NAMESPACE_KIND_COUNT 7
+#define NAMESPACE_USERNS_BASE 100000
+#define NAMESPACE_USERNS_RANGE 65536
 typedef struct {
     int flags;
+    const char *bind_root;
+    const char *enter_root;
+    int read_only_root;
 } namespace_config_t;
+typedef struct {
+    int flags;
+    int fds[NAMESPACE_KIND_COUNT];
+} namespace_fds_t;
+typedef struct {
+    uint64_t clone_ns;
+    uint64_t cgroup_attach_ns;
+    uint64_t mount_ns;
+    uint64_t exec_ns;
+} namespace_start_trace_t;
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -22,9 +44,34 @@ pid_t namespace_create_container(const namespace_config_t *config,
                                char **command, int argc);
 pid_t namespace_create_container_with_cgroup(const namespace_config_t *config,
                                             char **command, int argc,
-                                            void (*add_to_cgroup_callback)(pid_t pid, void *user_data),
+                                            int (*add_to_cgroup_callback)(pid_t pid, void *user_data),
                                             void *cgroup_user_data);
+pid_t namespace_create_container_with_stdio(const namespace_config_t *config,
+                                           char **command, int argc, const int *stdio_fds,
+                                           int (*add_to_cgroup_callback)(pid_t pid, void *user_data),
+                                           void *cgroup_user_data);
+pid_t namespace_create_container_in_cgroup(const namespace_config_t *config,
+                                           char **command, int argc, const int *stdio_fds, int cgroup_fd,
+                                           const namespace_fds_t *join, namespace_start_trace_t *trace,
+                                           int (*add_to_cgroup_callback)(pid_t pid, void *user_data),
+                                           void *cgroup_user_data);
+pid_t namespace_create_parked(const namespace_config_t *config, int *channel_fd);
+int namespace_release_parked(int channel_fd, char **command, const int *stdio_fds);
 int namespace_join(pid_t target_pid, int ns_type);
+int namespace_create_detached(int ns_type);
+const char *namespace_kind_name(int ns_type);
+int namespace_exec(pid_t target_pid, char **command);
+void namespace_fds_init(namespace_fds_t *fds);
+int namespace_fds_get(const namespace_fds_t *fds, int ns_type);
+void namespace_fds_set(namespace_fds_t *fds, int ns_type, int fd);
+int namespace_fds_count(const namespace_fds_t *fds);
+int namespace_open_fds(pid_t target_pid, int flags, namespace_fds_t *fds);
+void namespace_close_fds(namespace_fds_t *fds);
+int namespace_pin_fds(const namespace_fds_t *fds, const char *dir, const char *name);
+int namespace_open_pinned(const char *dir, const char *name, namespace_fds_t *fds);
+void namespace_unpin(const char *dir, const char *name);
+pid_t namespace_spawn(const namespace_fds_t *fds, const int *cgroup_fds, int cgroup_fd_count,
+                      char **command, const int *stdio_fds, int *pidfd);
 #ifdef __cplusplus
 }
 #endif
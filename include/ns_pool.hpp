@@ -0,0 +1,25 @@
+#ifndef NS_POOL_HPP
+#define NS_POOL_HPP
+#include "namespace_handler.hpp"
+#define NS_POOL_DIR "/var/run/mini-container/nspool"
+#define NS_POOL_DIR_FALLBACK "/tmp/mini-container-nspool"
+#define NS_POOL_DEFAULT_TARGET 4
+#define NS_POOL_KINDS (NS_NET | NS_USER)
+typedef struct ns_pool ns_pool_t;
+typedef struct {
+    int idle_net;
+    int idle_user;
+    unsigned long hits;
+    unsigned long misses;
+} ns_pool_stats_t;
+#ifdef __cplusplus
+extern "C" {
+#endif
+ns_pool_t *ns_pool_create(const char *dir, int target);
+void ns_pool_destroy(ns_pool_t *pool);
+int ns_pool_acquire(ns_pool_t *pool, int ns_type);
+void ns_pool_get_stats(ns_pool_t *pool, ns_pool_stats_t *stats);
+#ifdef __cplusplus
+}
+#endif
+#endif
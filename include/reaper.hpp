@@ -0,0 +1,23 @@
+#ifndef REAPER_HPP
+#define REAPER_HPP
+#include <sys/types.h>
+typedef struct reaper reaper_t;
+typedef int (*reaper_status_fn)(pid_t pid, int *status, void *user_data);
+#ifdef __cplusplus
+extern "C" {
+#endif
+reaper_t *reaper_create(void);
+void reaper_destroy(reaper_t *reaper);
+void reaper_shutdown(reaper_t *reaper);
+int reaper_watch(reaper_t *reaper, pid_t pid);
+int reaper_watch_pidfd(reaper_t *reaper, pid_t pid, int pidfd);
+void reaper_forget(reaper_t *reaper, pid_t pid);
+int reaper_signal(reaper_t *reaper, pid_t pid, int sig);
+int reaper_wait(reaper_t *reaper, pid_t pid, int timeout_ms, int *status);
+int reaper_next_exit(reaper_t *reaper, pid_t *pid, int *status);
+int reaper_is_alive(reaper_t *reaper, pid_t pid);
+void reaper_set_status_source(reaper_t *reaper, reaper_status_fn fn, void *user_data);
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -1,6 +1,7 @@
 #ifndef RESOURCE_MANAGER_HPP
 #define RESOURCE_MANAGER_HPP
 #include <sys/types.h>
+#define RESOURCE_MANAGER_MAX_PROCS_FDS 5
 typedef enum {
     RESOURCE_CPU,
     RESOURCE_MEMORY
@@ -36,14 +37,29 @@ int resource_manager_init(resource_manager_t *rm, const char *base_path);
 int resource_manager_create_cgroup(resource_manager_t *rm,
                                   const char *container_id,
                                   const resource_limits_t *limits);
+int resource_manager_make_cgroup(resource_manager_t *rm, const char *container_id);
+int resource_manager_apply_limits(resource_manager_t *rm,
+                                  const char *container_id,
+                                  const resource_limits_t *limits);
 int resource_manager_add_process(resource_manager_t *rm,
                                 const char *container_id,
                                 pid_t pid);
+int resource_manager_open_cgroup(resource_manager_t *rm, const char *container_id);
+int resource_manager_open_procs(resource_manager_t *rm,
+                               const char *container_id,
+                               int *fds,
+                               int max_fds);
 int resource_manager_remove_process(resource_manager_t *rm,
                                    const char *container_id,
                                    pid_t pid);
 int resource_manager_destroy_cgroup(resource_manager_t *rm,
                                    const char *container_id);
+int resource_manager_rename_cgroup(resource_manager_t *rm,
+                                  const char *from_id,
+                                  const char *to_id);
+int resource_manager_freeze(resource_manager_t *rm, const char *container_id, int frozen);
+int resource_manager_kill(resource_manager_t *rm, const char *container_id, int timeout_ms);
+int resource_manager_oom_kills(resource_manager_t *rm, const char *container_id);
 int resource_manager_get_stats(resource_manager_t *rm,
                               const char *container_id,
                               unsigned long *cpu_usage,
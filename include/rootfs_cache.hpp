@@ -0,0 +1,26 @@
+#ifndef ROOTFS_CACHE_HPP
+#define ROOTFS_CACHE_HPP
+#define ROOTFS_CACHE_DIR "/var/lib/mini-container/rootfs"
+#define ROOTFS_CACHE_DEFAULT_BUDGET (256ULL * 1024 * 1024)
+typedef struct rootfs_cache rootfs_cache_t;
+typedef struct {
+    unsigned long hits;
+    unsigned long misses;
+    unsigned long evictions;
+    int templates;
+    unsigned long long bytes;
+    unsigned long long budget;
+    int reflink;
+} rootfs_cache_stats_t;
+#ifdef __cplusplus
+extern "C" {
+#endif
+rootfs_cache_t *rootfs_cache_create(const char *dir, unsigned long long budget);
+void rootfs_cache_destroy(rootfs_cache_t *cache);
+int rootfs_cache_instantiate(rootfs_cache_t *cache, const char *root_path, const char *host_root,
+                             const char *const *binaries, int count, int allow_links, int *shared);
+void rootfs_cache_get_stats(rootfs_cache_t *cache, rootfs_cache_stats_t *stats);
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,22 @@
+#ifndef SLAB_ALLOCATOR_HPP
+#define SLAB_ALLOCATOR_HPP
+#include <stddef.h>
+typedef struct slab_allocator slab_allocator_t;
+typedef struct {
+    size_t chunks;
+    size_t blocks_in_use;
+    size_t blocks_free;
+    size_t large_in_use;
+} slab_stats_t;
+#ifdef __cplusplus
+extern "C" {
+#endif
+slab_allocator_t *slab_create(void);
+void slab_destroy(slab_allocator_t *slab);
+void *slab_alloc(slab_allocator_t *slab, size_t size);
+void slab_free(slab_allocator_t *slab, void *ptr);
+void slab_get_stats(slab_allocator_t *slab, slab_stats_t *stats);
+#ifdef __cplusplus
+}
+#endif
+#endif
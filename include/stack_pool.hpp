@@ -0,0 +1,25 @@
+#ifndef STACK_POOL_HPP
+#define STACK_POOL_HPP
+#include <stddef.h>
+#define STACK_POOL_ENV_PREFAULT "MINI_CONTAINER_STACK_PREFAULT"
+#define STACK_POOL_DEFAULT_CACHED 16
+#define STACK_POOL_PREFAULT_TOP_BYTES (64 * 1024)
+typedef struct stack_pool stack_pool_t;
+typedef enum {
+    STACK_PREFAULT_NONE,
+    STACK_PREFAULT_TOP,
+    STACK_PREFAULT_FULL
+} stack_prefault_t;
+#ifdef __cplusplus
+extern "C" {
+#endif
+stack_pool_t *stack_pool_create(size_t stack_size, int max_cached, stack_prefault_t prefault);
+void stack_pool_destroy(stack_pool_t *pool);
+void *stack_pool_acquire(stack_pool_t *pool);
+void stack_pool_release(stack_pool_t *pool, void *stack);
+size_t stack_pool_stack_size(const stack_pool_t *pool);
+stack_prefault_t stack_prefault_parse(const char *name);
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,40 @@
+#ifndef START_TRACE_HPP
+#define START_TRACE_HPP
+#include <stdint.h>
+#define START_HISTOGRAM_SUB_BUCKETS 4
+#define START_HISTOGRAM_BUCKETS (64 * START_HISTOGRAM_SUB_BUCKETS)
+typedef enum {
+    START_PHASE_CGROUP_MKDIR,
+    START_PHASE_CGROUP_LIMITS,
+    START_PHASE_ROOTFS_CREATE,
+    START_PHASE_ROOTFS_POPULATE,
+    START_PHASE_CLONE,
+    START_PHASE_CGROUP_ATTACH,
+    START_PHASE_MOUNT_SETUP,
+    START_PHASE_EXEC,
+    START_PHASE_TOTAL,
+    START_PHASE_COUNT
+} start_phase_t;
+typedef struct {
+    uint64_t begin_ns;
+    uint64_t phase_ns[START_PHASE_COUNT];
+    int32_t pooled;
+} start_trace_t;
+typedef struct {
+    uint64_t count;
+    uint64_t buckets[START_PHASE_COUNT][START_HISTOGRAM_BUCKETS];
+} start_histogram_t;
+#ifdef __cplusplus
+extern "C" {
+#endif
+uint64_t start_trace_now(void);
+void start_trace_begin(start_trace_t *trace);
+void start_trace_finish(start_trace_t *trace);
+const char *start_phase_name(int phase);
+void start_histogram_init(start_histogram_t *histogram);
+void start_histogram_record(start_histogram_t *histogram, const start_trace_t *trace);
+uint64_t start_histogram_percentile(const start_histogram_t *histogram, int phase, double percentile);
+#ifdef __cplusplus
+}
+#endif
+#endif
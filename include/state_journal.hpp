@@ -0,0 +1,41 @@
+#ifndef STATE_JOURNAL_HPP
+#define STATE_JOURNAL_HPP
+#include <stdint.h>
+#include <sys/types.h>
+#define STATE_RECORD_ID_MAX 64
+typedef enum {
+    STATE_RECORD_UPSERT = 1,
+    STATE_RECORD_REMOVE = 2
+} state_record_op_t;
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t op;
+    uint64_t sequence;
+    int32_t pid;
+    int32_t state;
+    int64_t created_at;
+    int64_t started_at;
+    int64_t stopped_at;
+    char id[STATE_RECORD_ID_MAX];
+    uint32_t reserved;
+    uint32_t checksum;
+} state_record_t;
+typedef struct state_journal state_journal_t;
+#ifdef __cplusplus
+extern "C" {
+#endif
+void state_record_init(state_record_t *record, state_record_op_t op, const char *id);
+state_journal_t *state_journal_open(const char *snapshot_path, const char *journal_path);
+int state_journal_load(state_journal_t *journal, state_record_t **records, int *count);
+int state_journal_append(state_journal_t *journal, state_record_t *record);
+int state_journal_append_batch(state_journal_t *journal, state_record_t *records, int count);
+int state_journal_sync(state_journal_t *journal);
+int state_journal_should_compact(state_journal_t *journal, int live_count);
+int state_journal_compact(state_journal_t *journal, const state_record_t *records,
+                          int count, int wait);
+void state_journal_close(state_journal_t *journal);
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,47 @@
+#ifndef STATE_SNAPSHOT_HPP
+#define STATE_SNAPSHOT_HPP
+#include <stdint.h>
+#include "state_journal.hpp"
+#define STATE_SNAPSHOT_VERSION 1
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t record_size;
+    uint32_t record_count;
+    uint32_t flags;
+    uint64_t sequence;
+    uint64_t strings_offset;
+    uint64_t strings_size;
+    uint32_t reserved;
+    uint32_t checksum;
+} state_snapshot_header_t;
+typedef struct {
+    uint32_t id_offset;
+    uint32_t id_length;
+    int32_t pid;
+    int32_t state;
+    int64_t created_at;
+    int64_t started_at;
+    int64_t stopped_at;
+} state_snapshot_record_t;
+typedef struct {
+    void *base;
+    size_t size;
+    const state_snapshot_header_t *header;
+    const unsigned char *records;
+    const char *strings;
+} state_snapshot_t;
+#ifdef __cplusplus
+extern "C" {
+#endif
+int state_snapshot_open(state_snapshot_t *snapshot, const char *path);
+int state_snapshot_count(const state_snapshot_t *snapshot);
+uint64_t state_snapshot_sequence(const state_snapshot_t *snapshot);
+int state_snapshot_get(const state_snapshot_t *snapshot, int index, state_record_t *record);
+void state_snapshot_close(state_snapshot_t *snapshot);
+int state_snapshot_write(const char *path, const state_record_t *records, int count, uint64_t sequence);
+int state_snapshot_import_json(const char *json_path, const char *snapshot_path);
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -4,8 +4,17 @@
 #include <string>
 #include <thread>
 #include <atomic>
+#include <mutex>
+#include <vector>
+#include <chrono>
 #include "container_manager.hpp"
 
+struct EventWaiter {
+    int socket;
+    event_cursor_t cursor;
+    std::chrono::steady_clock::time_point deadline;
+};
+
 class SimpleWebServer {
 public:
     SimpleWebServer(container_manager_t* cm, int port = 808);
@@ -15,7 +24,11 @@ public:
 
 private:
     void serverThread();
+    void eventsThread();
+    bool parkEventWaiter(int client_socket, const std::string& request);
     std::string handleRequest(const std::string& request);
+    std::string handleContainerAction(const std::string& path);
+    std::string handleContainerInfo(const std::string& path);
     std::string generateHTML();
     std::string getContainerListJSON();
     std::string getSystemInfoJSON();
@@ -26,8 +39,11 @@ private:
     container_manager_t* cm_;
     int port_;
     std::thread server_thread_;
+    std::thread events_thread_;
+    std::mutex events_lock_;
+    std::vector<EventWaiter> event_waiters_;
     std::atomic<bool> running_;
-    int server_socket_;
+    std::atomic<int> server_socket_;
 };
 
 #endif
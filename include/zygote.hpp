@@ -0,0 +1,20 @@
+#ifndef ZYGOTE_HPP
+#define ZYGOTE_HPP
+#include "namespace_handler.hpp"
+#include <sys/types.h>
+#define ZYGOTE_MAX_WORKERS 4096
+#define ZYGOTE_MAX_CGROUP_FDS 8
+typedef struct zygote zygote_t;
+#ifdef __cplusplus
+extern "C" {
+#endif
+zygote_t *zygote_create(const namespace_config_t *config);
+void zygote_destroy(zygote_t *zygote);
+pid_t zygote_pid(const zygote_t *zygote);
+pid_t zygote_spawn(zygote_t *zygote, char **command, char **env, const int *cgroup_fds, int cgroup_fd_count,
+                   const int *stdio_fds, int *pidfd);
+int zygote_wait(zygote_t *zygote, pid_t pid, int timeout_ms, int *status);
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,150 @@
+#include <cstdlib>
+#include <cstring>
+#include "../include/container_index.hpp"
+using namespace std;
+#define INDEX_MIN_CAPACITY 16
+static unsigned int hash_id(const char *id) {
+    unsigned int h = 2166136261u;
+    for (const unsigned char *p = reinterpret_cast<const unsigned char*>(id); *p; p++) {
+        h ^= *p;
+        h *= 16777619u;
+    }
+    return h;
+}
+static unsigned int hash_pid(pid_t pid) {
+    return (unsigned int)pid * 2654435761u;
+}
+static int table_init(container_index_table_t *table, int capacity) {
+    table->entries = static_cast<container_index_entry_t*>(malloc(capacity * sizeof(container_index_entry_t)));
+    if (!table->entries) {
+        return -1;
+    }
+    for (int i = 0; i < capacity; i++) {
+        table->entries[i].key = nullptr;
+        table->entries[i].hash = 0;
+        table->entries[i].slot = -1;
+    }
+    table->capacity = capacity;
+    table->count = 0;
+    return 0;
+}
+static int table_probe(const container_index_table_t *table, unsigned int hash, const char *key) {
+    unsigned int mask = table->capacity - 1;
+    for (unsigned int i = hash & mask;; i = (i + 1) & mask) {
+        const container_index_entry_t *e = &table->entries[i];
+        if (e->slot == -1) {
+            return -(int)i - 1;
+        }
+        if (e->hash == hash && (!key || strcmp(e->key, key) == 0)) {
+            return (int)i;
+        }
+    }
+}
+static int table_grow(container_index_table_t *table) {
+    container_index_table_t grown;
+    if (table_init(&grown, table->capacity * 2) != 0) {
+        return -1;
+    }
+    for (int i = 0; i < table->capacity; i++) {
+        container_index_entry_t *e = &table->entries[i];
+        if (e->slot == -1) continue;
+        unsigned int mask = grown.capacity - 1;
+        unsigned int pos = e->hash & mask;
+        while (grown.entries[pos].slot != -1) {
+            pos = (pos + 1) & mask;
+        }
+        grown.entries[pos] = *e;
+        grown.count++;
+    }
+    free(table->entries);
+    *table = grown;
+    return 0;
+}
+static int table_put(container_index_table_t *table, unsigned int hash, const char *key, int slot) {
+    if ((table->count + 1) * 2 > table->capacity && table_grow(table) != 0) {
+        return -1;
+    }
+    int pos = table_probe(table, hash, key);
+    if (pos >= 0) {
+        table->entries[pos].key = key;
+        table->entries[pos].slot = slot;
+        return 0;
+    }
+    pos = -pos - 1;
+    table->entries[pos].key = key;
+    table->entries[pos].hash = hash;
+    table->entries[pos].slot = slot;
+    table->count++;
+    return 0;
+}
+static void table_erase_at(container_index_table_t *table, unsigned int pos) {
+    unsigned int mask = table->capacity - 1;
+    unsigned int hole = pos;
+    for (unsigned int i = (pos + 1) & mask; table->entries[i].slot != -1; i = (i + 1) & mask) {
+        unsigned int home = table->entries[i].hash & mask;
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            table->entries[hole] = table->entries[i];
+            hole = i;
+        }
+    }
+    table->entries[hole].key = nullptr;
+    table->entries[hole].hash = 0;
+    table->entries[hole].slot = -1;
+    table->count--;
+}
+int container_index_init(container_index_t *idx, int expected) {
+    if (!idx) return -1;
+    int capacity = INDEX_MIN_CAPACITY;
+    while (capacity < expected * 2) {
+        capacity *= 2;
+    }
+    if (table_init(&idx->by_id, capacity) != 0) {
+        return -1;
+    }
+    if (table_init(&idx->by_pid, capacity) != 0) {
+        free(idx->by_id.entries);
+        idx->by_id.entries = nullptr;
+        return -1;
+    }
+    return 0;
+}
+void container_index_cleanup(container_index_t *idx) {
+    if (!idx) return;
+    free(idx->by_id.entries);
+    free(idx->by_pid.entries);
+    idx->by_id.entries = nullptr;
+    idx->by_pid.entries = nullptr;
+    idx->by_id.count = idx->by_pid.count = 0;
+}
+int container_index_lookup_id(const container_index_t *idx, const char *id) {
+    if (!idx || !id) return -1;
+    int pos = table_probe(&idx->by_id, hash_id(id), id);
+    return pos >= 0 ? idx->by_id.entries[pos].slot : -1;
+}
+int container_index_lookup_pid(const container_index_t *idx, pid_t pid) {
+    if (!idx || pid <= 0) return -1;
+    int pos = table_probe(&idx->by_pid, hash_pid(pid), nullptr);
+    return pos >= 0 ? idx->by_pid.entries[pos].slot : -1;
+}
+int container_index_put_id(container_index_t *idx, const char *id, int slot) {
+    if (!idx || !id || slot < 0) return -1;
+    return table_put(&idx->by_id, hash_id(id), id, slot);
+}
+int container_index_put_pid(container_index_t *idx, pid_t pid, int slot) {
+    if (!idx || pid <= 0 || slot < 0) return -1;
+    return table_put(&idx->by_pid, hash_pid(pid), nullptr, slot);
+}
+void container_index_erase_id(container_index_t *idx, const char *id) {
+    if (!idx || !id) return;
+    int pos = table_probe(&idx->by_id, hash_id(id), id);
+    if (pos >= 0) {
+        table_erase_at(&idx->by_id, (unsigned int)pos);
+    }
+}
+void container_index_erase_pid(container_index_t *idx, pid_t pid, int slot) {
+    if (!idx || pid <= 0) return;
+    int pos = table_probe(&idx->by_pid, hash_pid(pid), nullptr);
+    if (pos >= 0 && idx->by_pid.entries[pos].slot == slot) {
+        table_erase_at(&idx->by_pid, (unsigned int)pos);
+    }
+}
@@ -2,6 +2,7 @@
 #include <cstdlib>
 #include <cstring>
 #include <cerrno>
+#include <climits>
 #include <unistd.h>
 #include <sys/types.h>
 #include <sys/wait.h>
@@ -10,24 +11,30 @@
 #include <ctime>
 #include <csignal>
 #include <dirent.h>
+#include <vector>
+#include <deque>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <functional>
+#include <unordered_set>
+#include <condition_variable>
 #include "../include/container_manager.hpp"
+#include "../include/state_snapshot.hpp"
+#include "../include/logger.hpp"
 using namespace std;
 #define MAX_CONTAINER_ID 64
 #define DEFAULT_MAX_CONTAINERS 10
-#define STATE_FILE_PATH "/var/run/mini-container/state.json"
-#define STATE_FILE_PATH_FALLBACK "/tmp/mini-container-state.json"
-
-#define DEBUG_LOG(fmt, ...) \
-    do { \
-        fprintf(stderr, "[DEBUG] %s:%d [%s] " fmt "\n", __FILE__, __LINE__, __FUNCTION__, ##__VA_ARGS__); \
-        fflush(stderr); \
-    } while(0)
-
-#define ERROR_LOG(fmt, ...) \
-    do { \
-        fprintf(stderr, "[ERROR] %s:%d [%s] " fmt "\n", __FILE__, __LINE__, __FUNCTION__, ##__VA_ARGS__); \
-        fflush(stderr); \
-    } while(0)
+#define DEFAULT_STOP_TIMEOUT_MS 100
+#define BATCH_MAX_WORKERS 32
+#define STATE_FILE_PATH "/var/run/mini-container/state.snap"
+#define STATE_FILE_PATH_FALLBACK "/tmp/mini-container-state.snap"
+#define LEGACY_STATE_FILE_PATH "/var/run/mini-container/state.json"
+#define LEGACY_STATE_FILE_PATH_FALLBACK "/tmp/mini-container-state.json"
+#define STATE_JOURNAL_PATH "/var/run/mini-container/state.journal"
+#define STATE_JOURNAL_PATH_FALLBACK "/tmp/mini-container-state.journal"
+#define NAMESPACE_PIN_DIR "/var/run/mini-container/ns"
+#define NAMESPACE_PIN_DIR_FALLBACK "/tmp/mini-container-ns"
 static int extract_numeric_id(const char *id) {
     if (!id) return -1;
     char *endptr;
@@ -37,383 +44,500 @@ static int extract_numeric_id(const char *id) {
     }
     return -1;
 }
+static const char *format_container_id(container_manager_t *cm, char *id) {
+    int next_id = cm->max_numeric_id;
+    do {
+        next_id++;
+        snprintf(id, MAX_CONTAINER_ID, "%d", next_id);
+    } while (container_index_lookup_id(&cm->index, id) != -1);
+    return id;
+}
 static char *generate_container_id(container_manager_t *cm) {
     char *id = static_cast<char*>(malloc(MAX_CONTAINER_ID));
     if (!id) {
         return nullptr;
     }
-    int max_id = 0;
-    for (int i = 0; i < cm->container_count; i++) {
-        int num_id = extract_numeric_id(cm->containers[i]->id);
-        if (num_id > max_id) {
-            max_id = num_id;
-        }
-    }
-    int next_id = max_id + 1;
-    snprintf(id, MAX_CONTAINER_ID, "%d", next_id);
+    format_container_id(cm, id);
     return id;
 }
 static container_info_t *find_container(container_manager_t *cm, const char *container_id) {
-    for (int i = 0; i < cm->container_count; i++) {
-        if (strcmp(cm->containers[i]->id, container_id) == 0) {
-            return cm->containers[i];
-        }
-    }
-    return nullptr;
+    int slot = container_index_lookup_id(&cm->index, container_id);
+    return slot >= 0 ? cm->containers[slot] : nullptr;
 }
 static int add_container(container_manager_t *cm, container_info_t *info) {
-    DEBUG_LOG("add_container called: container_count=%d, max_containers=%d", cm->container_count, cm->max_containers);
+    LOG_DEBUG("add_container called: container_count=%d, max_containers=%d", cm->container_count, cm->max_containers);
     if (cm->container_count >= cm->max_containers) {
-        DEBUG_LOG("Reallocating containers array");
+        LOG_DEBUG("Reallocating containers array");
         size_t new_size = cm->max_containers * 2;
         container_info_t **new_containers = static_cast<container_info_t**>(realloc(cm->containers, new_size * sizeof(container_info_t *)));
         if (!new_containers) {
-            ERROR_LOG("realloc failed for containers array");
+            LOG_ERROR("realloc failed for containers array");
             fprintf(stderr, "Error: failed to reallocate containers array\n");
             return -1;
         }
-        DEBUG_LOG("realloc succeeded, new_size=%zu", new_size);
+        LOG_DEBUG("realloc succeeded, new_size=%zu", new_size);
         cm->containers = new_containers;
         cm->max_containers = new_size;
     }
-    DEBUG_LOG("Adding container at index %d", cm->container_count);
+    int slot = cm->container_count;
+    if (container_index_lookup_id(&cm->index, info->id) != -1) {
+        LOG_ERROR("container %s is already registered", info->id);
+        return -1;
+    }
+    if (container_index_put_id(&cm->index, info->id, slot) != 0) {
+        LOG_ERROR("failed to index container %s", info->id);
+        return -1;
+    }
+    if (info->pid > 0) {
+        container_index_put_pid(&cm->index, info->pid, slot);
+    }
+    LOG_DEBUG("Adding container at index %d", slot);
     cm->containers[cm->container_count++] = info;
-    DEBUG_LOG("Container added successfully, new count=%d", cm->container_count);
+    cm->snapshot_dirty = 1;
+    int num_id = extract_numeric_id(info->id);
+    if (num_id > cm->max_numeric_id) {
+        cm->max_numeric_id = num_id;
+    }
+    LOG_DEBUG("Container added successfully, new count=%d", cm->container_count);
     return 0;
 }
-static void free_container_config(container_config_t *config);
+static void set_container_pid(container_manager_t *cm, container_info_t *info, pid_t pid, int pidfd) {
+    int slot = container_index_lookup_id(&cm->index, info->id);
+    if (slot >= 0) {
+        container_index_erase_pid(&cm->index, info->pid, slot);
+        container_index_put_pid(&cm->index, pid, slot);
+    }
+    if (info->pid != pid) {
+        reaper_forget(cm->reaper, info->pid);
+    }
+    if ((pidfd >= 0 ? reaper_watch_pidfd(cm->reaper, pid, pidfd) : reaper_watch(cm->reaper, pid)) != 0) {
+        fprintf(stderr, "Warning: failed to watch pid %d: %s\n", pid, strerror(errno));
+    }
+    info->pid = pid;
+    cm->snapshot_dirty = 1;
+}
+static void free_container(container_manager_t *cm, container_info_t *info);
+static container_info_t *find_container_by_pid(container_manager_t *cm, pid_t pid);
+static void mark_exited(container_manager_t *cm, container_info_t *info, int status);
+static void release_namespaces(container_info_t *info);
 static void remove_container(container_manager_t *cm, const char *container_id) {
-    for (int i = 0; i < cm->container_count; i++) {
-        if (strcmp(cm->containers[i]->id, container_id) == 0) {
-            free_container_config(cm->containers[i]->saved_config);
-            free(cm->containers[i]->id);
-            free(cm->containers[i]);
-            for (int j = i; j < cm->container_count - 1; j++) {
-                cm->containers[j] = cm->containers[j + 1];
-            }
-            cm->container_count--;
-            break;
+    int slot = container_index_lookup_id(&cm->index, container_id);
+    if (slot < 0) {
+        return;
+    }
+    container_info_t *info = cm->containers[slot];
+    reaper_forget(cm->reaper, info->pid);
+    container_index_erase_pid(&cm->index, info->pid, slot);
+    container_index_erase_id(&cm->index, info->id);
+    int last = cm->container_count - 1;
+    if (slot != last) {
+        container_info_t *moved = cm->containers[last];
+        cm->containers[slot] = moved;
+        container_index_put_id(&cm->index, moved->id, slot);
+        if (container_index_lookup_pid(&cm->index, moved->pid) == last) {
+            container_index_put_pid(&cm->index, moved->pid, slot);
         }
     }
+    cm->containers[last] = nullptr;
+    cm->container_count--;
+    cm->snapshot_dirty = 1;
+    if (namespace_fds_count(&info->ns_fds) > 0) {
+        release_namespaces(info);
+    }
+    free_container(cm, info);
 }
-static int is_pid_alive(pid_t pid) {
-    if (pid <= 0) return 0;
-    if (kill(pid, 0) == 0) {
-        return 1;
+static void free_snapshot(container_snapshot_t *snapshot) {
+    if (!snapshot) return;
+    free(snapshot->containers);
+    free(snapshot);
+}
+static void reclaim_snapshots(container_manager_t *cm) {
+    for (int i = 0; i < 2; i++) {
+        uint64_t epoch = __atomic_load_n(&cm->epoch, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&cm->readers[(epoch + 1) & 1], __ATOMIC_SEQ_CST) != 0) {
+            break;
+        }
+        __atomic_store_n(&cm->epoch, epoch + 1, __ATOMIC_SEQ_CST);
+    }
+    uint64_t epoch = __atomic_load_n(&cm->epoch, __ATOMIC_SEQ_CST);
+    container_snapshot_t **link = &cm->retired;
+    while (*link) {
+        container_snapshot_t *snapshot = *link;
+        if (snapshot->retired_epoch + 2 <= epoch) {
+            *link = snapshot->next_retired;
+            free_snapshot(snapshot);
+        } else {
+            link = &snapshot->next_retired;
+        }
     }
-    return (errno == ESRCH) ? 0 : 1;
 }
-static container_config_t* copy_container_config(const container_config_t *src) {
-    fprintf(stderr, "[DEBUG] copy_container_config: called with src=%p\n", (void*)src);
-    fflush(stderr);
-    if (!src) {
-        ERROR_LOG("copy_container_config: src is NULL");
-        return nullptr;
+static int publish_snapshot(container_manager_t *cm) {
+    container_snapshot_t *snapshot = static_cast<container_snapshot_t*>(calloc(1, sizeof(container_snapshot_t)));
+    if (!snapshot) {
+        perror("calloc container snapshot failed");
+        return -1;
     }
-    fprintf(stderr, "[DEBUG] copy_container_config: src->id=%p, src->root_path=%p, src->command=%p, src->command_argc=%d\n",
-            (void*)src->id, (void*)src->root_path, (void*)src->command, src->command_argc);
-    fflush(stderr);
-    fprintf(stderr, "[DEBUG] copy_container_config: About to access src->fs_config\n");
-    fflush(stderr);
-    fprintf(stderr, "[DEBUG] copy_container_config: src->fs_config address: %p\n", (void*)&src->fs_config);
-    fflush(stderr);
-    fprintf(stderr, "[DEBUG] copy_container_config: About to access src->fs_config.root_path\n");
-    fflush(stderr);
-    fprintf(stderr, "[DEBUG] copy_container_config: src->fs_config.root_path=%p\n", (void*)src->fs_config.root_path);
-    fflush(stderr);
-    DEBUG_LOG("copy_container_config: Allocating dst");
-    container_config_t *dst = static_cast<container_config_t*>(calloc(1, sizeof(container_config_t)));
-    if (!dst) {
-        ERROR_LOG("copy_container_config: calloc failed for dst");
-        return nullptr;
+    if (cm->container_count > 0) {
+        snapshot->containers = static_cast<container_view_t*>(calloc(cm->container_count, sizeof(container_view_t)));
+        if (!snapshot->containers) {
+            perror("calloc container snapshot failed");
+            free(snapshot);
+            return -1;
+        }
     }
-    DEBUG_LOG("copy_container_config: dst allocated: %p", (void*)dst);
-    if (src->id) {
-        DEBUG_LOG("copy_container_config: Copying id: %s", src->id);
-        dst->id = strdup(src->id);
-        if (!dst->id) {
-            ERROR_LOG("copy_container_config: strdup failed for id");
-            free(dst);
-            return nullptr;
-        }
-        DEBUG_LOG("copy_container_config: id copied successfully");
-    }
-    if (src->root_path) {
-        DEBUG_LOG("copy_container_config: Copying root_path: %s", src->root_path);
-        dst->root_path = strdup(src->root_path);
-        if (!dst->root_path) {
-            ERROR_LOG("copy_container_config: strdup failed for root_path");
-            free_container_config(dst);
-            return nullptr;
-        }
-        DEBUG_LOG("copy_container_config: root_path copied successfully");
-    }
-    DEBUG_LOG("copy_container_config: Copying ns_config");
-    dst->ns_config = src->ns_config;
-    DEBUG_LOG("copy_container_config: Copying res_limits");
-    dst->res_limits = src->res_limits;
-    DEBUG_LOG("copy_container_config: About to copy fs_config");
-    DEBUG_LOG("copy_container_config: src->fs_config.root_path pointer: %p", (void*)src->fs_config.root_path);
-    if (src->fs_config.root_path) {
-        DEBUG_LOG("copy_container_config: src->fs_config.root_path value: %s", src->fs_config.root_path);
-    }
-    DEBUG_LOG("copy_container_config: About to copy fs_config struct");
-    DEBUG_LOG("copy_container_config: src->fs_config address: %p", (void*)&src->fs_config);
-    DEBUG_LOG("copy_container_config: dst->fs_config address: %p", (void*)&dst->fs_config);
-    DEBUG_LOG("copy_container_config: src->fs_config.root_path pointer: %p", (void*)src->fs_config.root_path);
-    DEBUG_LOG("copy_container_config: src->fs_config.method: %d", src->fs_config.method);
-    DEBUG_LOG("copy_container_config: src->fs_config.create_minimal_fs: %d", src->fs_config.create_minimal_fs);
-    fflush(stderr);
-    DEBUG_LOG("copy_container_config: Copying fs_config struct (memcpy)");
-    fflush(stderr);
-    memcpy(&dst->fs_config, &src->fs_config, sizeof(fs_config_t));
-    fflush(stderr);
-    DEBUG_LOG("copy_container_config: fs_config struct copied");
-    fflush(stderr);
-    DEBUG_LOG("copy_container_config: dst->fs_config.root_path after copy: %p", (void*)dst->fs_config.root_path);
-    fflush(stderr);
-    if (src->fs_config.root_path) {
-        DEBUG_LOG("copy_container_config: About to strdup fs_config.root_path: %s", src->fs_config.root_path);
-        fflush(stderr);
-        dst->fs_config.root_path = strdup(src->fs_config.root_path);
-        fflush(stderr);
-        if (!dst->fs_config.root_path) {
-            ERROR_LOG("copy_container_config: strdup failed for fs_config.root_path");
-            free_container_config(dst);
-            return nullptr;
-        }
-        DEBUG_LOG("copy_container_config: fs_config.root_path copied successfully: %s", dst->fs_config.root_path);
-    } else {
-        DEBUG_LOG("copy_container_config: src->fs_config.root_path is NULL, skipping");
-        dst->fs_config.root_path = nullptr;
-    }
-    DEBUG_LOG("copy_container_config: About to copy command array");
-    fflush(stderr);
-    if (src->command && src->command_argc > 0) {
-        DEBUG_LOG("copy_container_config: Copying command array, argc=%d", src->command_argc);
-        DEBUG_LOG("copy_container_config: src->command pointer: %p", (void*)src->command);
-        fflush(stderr);
-        for (int i = 0; i < src->command_argc; i++) {
-            DEBUG_LOG("copy_container_config: src->command[%d] = %p", i, (void*)src->command[i]);
-            if (src->command[i]) {
-                DEBUG_LOG("copy_container_config: src->command[%d] value: %s", i, src->command[i]);
-            } else {
-                DEBUG_LOG("copy_container_config: src->command[%d] is NULL", i);
-            }
+    for (int i = 0; i < cm->container_count; i++) {
+        const container_info_t *info = cm->containers[i];
+        container_view_t *view = &snapshot->containers[i];
+        strncpy(view->id, info->id, CONTAINER_VIEW_ID_MAX - 1);
+        view->pid = info->pid;
+        view->state = info->state;
+        view->created_at = info->created_at;
+        view->started_at = info->started_at;
+        view->stopped_at = info->stopped_at;
+        view->start_trace = info->start_trace;
+        view->fs_method = info->saved_config ? info->saved_config->fs_config.method : FS_CHROOT;
+    }
+    snapshot->count = cm->container_count;
+    snapshot->version = ++cm->snapshot_version;
+    container_snapshot_t *old = __atomic_exchange_n(&cm->snapshot, snapshot, __ATOMIC_SEQ_CST);
+    if (old) {
+        old->retired_epoch = __atomic_load_n(&cm->epoch, __ATOMIC_SEQ_CST);
+        old->next_retired = cm->retired;
+        cm->retired = old;
+    }
+    cm->snapshot_dirty = 0;
+    reclaim_snapshots(cm);
+    return 0;
+}
+class manager_guard {
+public:
+    explicit manager_guard(container_manager_t *cm) : cm_(cm) {
+        pthread_mutex_lock(&cm_->lock);
+        cm_->lock_depth++;
+    }
+    ~manager_guard() {
+        if (cm_->lock_depth == 1 && cm_->snapshot_dirty) {
+            publish_snapshot(cm_);
         }
-        fflush(stderr);
-        dst->command_argc = src->command_argc;
-        DEBUG_LOG("copy_container_config: About to calloc command array");
-        fflush(stderr);
-        dst->command = static_cast<char**>(calloc(src->command_argc + 1, sizeof(char*)));
-        if (!dst->command) {
-            ERROR_LOG("copy_container_config: calloc failed for command array");
-            free_container_config(dst);
-            return nullptr;
-        }
-        DEBUG_LOG("copy_container_config: command array allocated: %p", (void*)dst->command);
-        fflush(stderr);
-        for (int i = 0; i < src->command_argc; i++) {
-            DEBUG_LOG("copy_container_config: Processing command[%d]", i);
-            fflush(stderr);
-            if (src->command && src->command[i]) {
-                DEBUG_LOG("copy_container_config: Copying command[%d] = %s", i, src->command[i]);
-                fflush(stderr);
-                errno = 0;
-                dst->command[i] = strdup(src->command[i]);
-                fflush(stderr);
-                if (!dst->command[i]) {
-                    ERROR_LOG("copy_container_config: strdup failed for command[%d], errno=%d", i, errno);
-                    perror("strdup failed");
-                    for (int j = 0; j < i; j++) {
-                        if (dst->command[j]) {
-                            free(dst->command[j]);
-                        }
-                    }
-                    free(dst->command);
-                    free_container_config(dst);
-                    return nullptr;
-                }
-                DEBUG_LOG("copy_container_config: Copied command[%d] = %s (dst=%p)", i, dst->command[i], (void*)dst->command[i]);
-                fflush(stderr);
-            } else {
-                DEBUG_LOG("copy_container_config: command[%d] is NULL", i);
-                dst->command[i] = nullptr;
+        cm_->lock_depth--;
+        pthread_mutex_unlock(&cm_->lock);
+    }
+private:
+    container_manager_t *cm_;
+};
+static size_t pooled_length(const char *str) {
+    return str ? strlen(str) + 1 : 0;
+}
+static char *pool_copy(char **pool, const char *str) {
+    if (!str) return nullptr;
+    size_t len = strlen(str) + 1;
+    char *dst = *pool;
+    memcpy(dst, str, len);
+    *pool += len;
+    return dst;
+}
+static container_info_t *alloc_container(container_manager_t *cm, const char *id,
+                                         const container_config_t *config) {
+    int argc = config && config->command ? config->command_argc : 0;
+    if (argc < 0) argc = 0;
+    size_t size = sizeof(container_info_t) + pooled_length(id);
+    if (config) {
+        size += sizeof(container_config_t);
+        size += pooled_length(config->root_path) + pooled_length(config->fs_config.root_path);
+        size += pooled_length(config->fs_config.lower_dirs);
+        if (argc > 0) {
+            size += (argc + 1) * sizeof(char*);
+            for (int i = 0; i < argc; i++) {
+                size += pooled_length(config->command[i]);
             }
         }
-        dst->command[src->command_argc] = nullptr;
-        DEBUG_LOG("copy_container_config: Command array copied successfully");
-        fflush(stderr);
-    } else {
-        DEBUG_LOG("copy_container_config: No command to copy");
-        dst->command = nullptr;
-        dst->command_argc = 0;
-        fflush(stderr);
     }
-    DEBUG_LOG("copy_container_config: About to return dst=%p", (void*)dst);
-    fflush(stderr);
-    return dst;
-}
-static void free_container_config(container_config_t *config) {
-    if (!config) return;
-    if (config->id) free(config->id);
-    if (config->root_path) free(config->root_path);
-    if (config->fs_config.root_path) free(config->fs_config.root_path);
-    if (config->command) {
-        for (int i = 0; i < config->command_argc && config->command[i]; i++) {
-            free(config->command[i]);
+    container_info_t *info = static_cast<container_info_t*>(slab_alloc(cm->slab, size));
+    if (!info) {
+        LOG_ERROR("slab_alloc failed for container %s (%zu bytes)", id, size);
+        return nullptr;
+    }
+    memset(info, 0, sizeof(container_info_t));
+    namespace_fds_init(&info->ns_fds);
+    char *cursor = reinterpret_cast<char*>(info + 1);
+    container_config_t *dst = nullptr;
+    char **argv = nullptr;
+    if (config) {
+        dst = reinterpret_cast<container_config_t*>(cursor);
+        cursor += sizeof(container_config_t);
+        if (argc > 0) {
+            argv = reinterpret_cast<char**>(cursor);
+            cursor += (argc + 1) * sizeof(char*);
         }
-        free(config->command);
     }
-    free(config);
+    info->id = pool_copy(&cursor, id);
+    if (!config) {
+        return info;
+    }
+    *dst = *config;
+    dst->id = config->id ? info->id : nullptr;
+    dst->root_path = pool_copy(&cursor, config->root_path);
+    dst->fs_config.root_path = pool_copy(&cursor, config->fs_config.root_path);
+    dst->fs_config.lower_dirs = pool_copy(&cursor, config->fs_config.lower_dirs);
+    dst->command = argv;
+    dst->command_argc = argc;
+    for (int i = 0; i < argc; i++) {
+        argv[i] = pool_copy(&cursor, config->command[i]);
+    }
+    if (argv) {
+        argv[argc] = nullptr;
+    }
+    info->saved_config = dst;
+    return info;
 }
-static void kill_process_tree(pid_t pid) {
-    if (pid <= 0) return;
-    kill(pid, SIGTERM);
-    usleep(100000);
-    if (kill(pid, 0) == 0) {
-        kill(pid, SIGKILL);
-        usleep(50000);
+static void release_overlay(const container_info_t *info) {
+    if (info->saved_config && info->saved_config->fs_config.method != FS_OVERLAY) {
+        return;
     }
-    char proc_path[256];
-    snprintf(proc_path, sizeof(proc_path), "/proc/%d/task", pid);
-    DIR *dir = opendir(proc_path);
-    if (dir) {
-        struct dirent *entry;
-        while ((entry = readdir(dir)) != nullptr) {
-            if (entry->d_name[0] == '.') continue;
-            pid_t tid = atoi(entry->d_name);
-            if (tid > 0 && tid != pid) {
-                kill(tid, SIGKILL);
-            }
-        }
-        closedir(dir);
+    char root[PATH_MAX];
+    if (info->saved_config &&
+        fs_overlay_root_path(&info->saved_config->fs_config, info->id, root, sizeof(root)) == 0) {
+        fs_cleanup_container_root(root);
     }
+    fs_unmount_overlay(info->id);
+    fs_remove_overlay(info->id);
+}
+static void free_container(container_manager_t *cm, container_info_t *info) {
+    namespace_close_fds(&info->ns_fds);
+    slab_free(cm->slab, info);
+}
+static void signal_process_tree(pid_t pid, int sig) {
+    if (pid <= 0) return;
+    kill(pid, sig);
+    char proc_path[256];
     snprintf(proc_path, sizeof(proc_path), "/proc/%d/task/%d/children", pid, pid);
     FILE *fp = fopen(proc_path, "r");
     if (fp) {
         pid_t child_pid;
         while (fscanf(fp, "%d", &child_pid) == 1) {
             if (child_pid > 0) {
-                kill_process_tree(child_pid);
+                signal_process_tree(child_pid, sig);
+            }
+        }
+        fclose(fp);
+    }
+}
+static void signal_container_cgroup(container_manager_t *cm, const char *container_id, int sig) {
+    char cgroup_procs_path[512];
+    if (cm->rm->version == CGROUP_V2) {
+        snprintf(cgroup_procs_path, sizeof(cgroup_procs_path),
+                 "/sys/fs/cgroup/%s_%s/cgroup.procs", cm->rm->cgroup_path, container_id);
+    } else {
+        snprintf(cgroup_procs_path, sizeof(cgroup_procs_path),
+                 "/sys/fs/cgroup/cpu,cpuacct/%s_%s/tasks", cm->rm->cgroup_path, container_id);
+    }
+    FILE *fp = fopen(cgroup_procs_path, "r");
+    if (fp) {
+        pid_t pid;
+        while (fscanf(fp, "%d", &pid) == 1) {
+            if (pid > 0) {
+                signal_process_tree(pid, sig);
             }
         }
         fclose(fp);
     }
 }
-static const char* get_state_file_path() {
+static void kill_container(container_manager_t *cm, const char *container_id, pid_t pid, int timeout_ms) {
+    int ret = resource_manager_kill(cm->rm, container_id, timeout_ms);
+    if (ret < 0) {
+        reaper_signal(cm->reaper, pid, SIGKILL);
+        signal_container_cgroup(cm, container_id, SIGKILL);
+    } else if (ret > 0) {
+        fprintf(stderr, "Warning: cgroup of container %s still populated after kill\n", container_id);
+    }
+}
+static bool is_active(const container_info_t *info) {
+    return info->state == CONTAINER_RUNNING || info->state == CONTAINER_PAUSED;
+}
+static void thaw_if_paused(container_manager_t *cm, const container_info_t *info) {
+    if (info->state == CONTAINER_PAUSED && resource_manager_freeze(cm->rm, info->id, 0) != 0) {
+        fprintf(stderr, "Warning: failed to resume container %s before stopping it\n", info->id);
+    }
+}
+static void stop_container_processes(container_manager_t *cm, const char *container_id, pid_t pid,
+                                     int timeout_ms) {
+    if (reaper_watch(cm->reaper, pid) == 0) {
+        reaper_signal(cm->reaper, pid, SIGTERM);
+        signal_container_cgroup(cm, container_id, SIGTERM);
+        if (reaper_wait(cm->reaper, pid, timeout_ms, nullptr) == 1) {
+            kill_container(cm, container_id, pid, timeout_ms);
+            if (reaper_wait(cm->reaper, pid, timeout_ms, nullptr) == 1) {
+                fprintf(stderr, "Warning: container %s did not exit after SIGKILL\n", container_id);
+            }
+        }
+    }
+    kill_container(cm, container_id, pid, timeout_ms);
+}
+static bool use_state_dir() {
     struct stat st;
-    if (stat("/var/run/mini-container", &st) == 0 || mkdir("/var/run/mini-container", 0755) == 0) {
-        return STATE_FILE_PATH;
+    return stat("/var/run/mini-container", &st) == 0 || mkdir("/var/run/mini-container", 0755) == 0;
+}
+static const char *namespace_pin_dir() {
+    return use_state_dir() ? NAMESPACE_PIN_DIR : NAMESPACE_PIN_DIR_FALLBACK;
+}
+static int namespace_flags(const container_info_t *info) {
+    return info->saved_config ? info->saved_config->ns_config.flags : CONTAINER_NAMESPACES;
+}
+static int open_namespaces(container_info_t *info, namespace_fds_t *joined) {
+    if (namespace_fds_count(&info->ns_fds) > 0) {
+        namespace_close_fds(joined);
+        return 0;
+    }
+    if (joined) {
+        info->ns_fds = *joined;
+        namespace_fds_init(joined);
+    }
+    if (namespace_open_fds(info->pid, namespace_flags(info), &info->ns_fds) != 0) {
+        if (errno == ENOENT || errno == ESRCH) {
+            return -1;
+        }
+        fprintf(stderr, "Warning: failed to open namespaces of container %s: %s\n", info->id, strerror(errno));
+        return -1;
+    }
+    if (namespace_pin_fds(&info->ns_fds, namespace_pin_dir(), info->id) != 0) {
+        fprintf(stderr, "Warning: namespaces of container %s will not survive a restart\n", info->id);
     }
-    return STATE_FILE_PATH_FALLBACK;
+    return 0;
 }
-static void save_state(container_manager_t *cm) {
-    const char* state_file = get_state_file_path();
-    FILE* fp = fopen(state_file, "w");
-    if (!fp) {
-        return;
+static void release_namespaces(container_info_t *info) {
+    namespace_close_fds(&info->ns_fds);
+    namespace_unpin(namespace_pin_dir(), info->id);
+}
+static void fill_state_record(state_record_t *rec, const container_info_t *info) {
+    rec->pid = info->pid;
+    rec->state = info->state;
+    rec->created_at = info->created_at;
+    rec->started_at = info->started_at;
+    rec->stopped_at = info->stopped_at;
+}
+static void compact_state(container_manager_t *cm, int wait, const container_info_t *removed) {
+    state_record_t *records = nullptr;
+    if (cm->container_count > 0) {
+        records = static_cast<state_record_t*>(malloc(cm->container_count * sizeof(state_record_t)));
+        if (!records) {
+            perror("malloc state records failed");
+            return;
+        }
     }
-    fprintf(fp, "{\n");
-    fprintf(fp, "  \"containers\": [\n");
+    int count = 0;
     for (int i = 0; i < cm->container_count; i++) {
-        container_info_t* info = cm->containers[i];
-        fprintf(fp, "    {\n");
-        fprintf(fp, "      \"id\": \"%s\",\n", info->id);
-        fprintf(fp, "      \"pid\": %d,\n", info->pid);
-        fprintf(fp, "      \"state\": %d,\n", info->state);
-        fprintf(fp, "      \"created_at\": %ld,\n", info->created_at);
-        fprintf(fp, "      \"started_at\": %ld,\n", info->started_at);
-        fprintf(fp, "      \"stopped_at\": %ld\n", info->stopped_at);
-        fprintf(fp, "    }%s\n", (i < cm->container_count - 1) ? "," : "");
-    }
-    fprintf(fp, "  ]\n");
-    fprintf(fp, "}\n");
-    fclose(fp);
+        if (cm->containers[i] == removed) {
+            continue;
+        }
+        state_record_init(&records[count], STATE_RECORD_UPSERT, cm->containers[i]->id);
+        fill_state_record(&records[count], cm->containers[i]);
+        count++;
+    }
+    state_journal_compact(cm->journal, records, count, wait);
+    free(records);
+}
+static void make_state_record(state_record_t *rec, const container_info_t *info, state_record_op_t op) {
+    state_record_init(rec, op, info->id);
+    if (op == STATE_RECORD_UPSERT) {
+        fill_state_record(rec, info);
+    }
+}
+static void journal_state(container_manager_t *cm, const container_info_t *info, state_record_op_t op) {
+    if (!cm->journal || !info) {
+        return;
+    }
+    state_record_t rec;
+    make_state_record(&rec, info, op);
+    state_journal_append(cm->journal, &rec);
+    if (state_journal_should_compact(cm->journal, cm->container_count)) {
+        compact_state(cm, 0, op == STATE_RECORD_REMOVE ? info : nullptr);
+    }
 }
 static int load_state(container_manager_t *cm) {
-    const char* state_file = get_state_file_path();
-    FILE* fp = fopen(state_file, "r");
-    if (!fp) {
+    bool state_dir = use_state_dir();
+    const char *snapshot_path = state_dir ? STATE_FILE_PATH : STATE_FILE_PATH_FALLBACK;
+    const char *legacy_path = state_dir ? LEGACY_STATE_FILE_PATH : LEGACY_STATE_FILE_PATH_FALLBACK;
+    if (access(snapshot_path, F_OK) != 0 && access(legacy_path, F_OK) == 0) {
+        state_snapshot_import_json(legacy_path, snapshot_path);
+    }
+    cm->journal = state_journal_open(snapshot_path, state_dir ? STATE_JOURNAL_PATH : STATE_JOURNAL_PATH_FALLBACK);
+    if (!cm->journal) {
         return 0;
     }
-    char line[1024];
-    char container_id[256] = {0};
-    pid_t pid = 0;
-    int state = 0;
-    time_t created_at = 0, started_at = 0, stopped_at = 0;
+    state_record_t *records = nullptr;
+    int count = 0;
+    if (state_journal_load(cm->journal, &records, &count) != 0) {
+        return 0;
+    }
+    if (count > cm->max_containers) {
+        container_info_t **grown = static_cast<container_info_t**>(realloc(cm->containers, count * sizeof(container_info_t *)));
+        if (grown) {
+            cm->containers = grown;
+            cm->max_containers = count;
+        }
+    }
     int loaded = 0;
-    bool in_container = false;
-    while (fgets(line, sizeof(line), fp)) {
-        char* p = line;
-        while (*p == ' ' || *p == '\t') p++;
-        if (*p == '\n' || *p == '\0' || *p == '{' || *p == '[' || *p == ']') {
+    for (int i = 0; i < count; i++) {
+        state_record_t *rec = &records[i];
+        bool active = rec->state == CONTAINER_RUNNING || rec->state == CONTAINER_PAUSED;
+        if (active && reaper_watch(cm->reaper, rec->pid) != 0) {
+            rec->state = CONTAINER_STOPPED;
+            rec->stopped_at = time(nullptr);
+        }
+        bool dropped = rec->state == CONTAINER_DESTROYED || rec->state == CONTAINER_STOPPED;
+        bool renamed = extract_numeric_id(rec->id) < 0;
+        if (dropped || renamed) {
+            namespace_unpin(namespace_pin_dir(), rec->id);
+            state_record_t removal;
+            state_record_init(&removal, STATE_RECORD_REMOVE, rec->id);
+            state_journal_append(cm->journal, &removal);
+        }
+        if (dropped) {
             continue;
         }
-        if (strstr(p, "\"id\"")) {
-            in_container = true;
-            sscanf(p, " \"id\": \"%255[^\"]\"", container_id);
-        } else if (in_container && strstr(p, "\"pid\"")) {
-            sscanf(p, " \"pid\": %d", &pid);
-        } else if (in_container && strstr(p, "\"state\"")) {
-            sscanf(p, " \"state\": %d", &state);
-        } else if (in_container && strstr(p, "\"created_at\"")) {
-            sscanf(p, " \"created_at\": %ld", &created_at);
-        } else if (in_container && strstr(p, "\"started_at\"")) {
-            sscanf(p, " \"started_at\": %ld", &started_at);
-        } else if (in_container && strstr(p, "\"stopped_at\"")) {
-            sscanf(p, " \"stopped_at\": %ld", &stopped_at);
-        }
-        if (in_container && (strstr(p, "}") || (strstr(p, "},")))) {
-            if (container_id[0] != '\0') {
-                if (state == CONTAINER_RUNNING && !is_pid_alive(pid)) {
-                    state = CONTAINER_STOPPED;
-                    stopped_at = time(nullptr);
-                }
-                if (state != CONTAINER_DESTROYED && state != CONTAINER_STOPPED) {
-                    container_info_t *info = static_cast<container_info_t*>(calloc(1, sizeof(container_info_t)));
-                    if (info) {
-                        int num_id = extract_numeric_id(container_id);
-                        if (num_id < 0) {
-                            int max_id = 0;
-                            for (int i = 0; i < cm->container_count; i++) {
-                                int existing_num_id = extract_numeric_id(cm->containers[i]->id);
-                                if (existing_num_id > max_id) {
-                                    max_id = existing_num_id;
-                                }
-                            }
-                            num_id = max_id + 1;
-                            char new_id[64];
-                            snprintf(new_id, sizeof(new_id), "%d", num_id);
-                            info->id = strdup(new_id);
-                        } else {
-                            info->id = strdup(container_id);
-                        }
-                        info->pid = pid;
-                        info->state = static_cast<container_state_t>(state);
-                        info->created_at = created_at;
-                        info->started_at = started_at;
-                        info->stopped_at = stopped_at;
-                        info->saved_config = nullptr;
-                        if (add_container(cm, info) == 0) {
-                            loaded++;
-                        } else {
-                            free(info->id);
-                            free(info);
-                        }
-                    }
-                }
-                memset(container_id, 0, sizeof(container_id));
-                pid = 0;
-                state = 0;
-                created_at = started_at = stopped_at = 0;
-                in_container = false;
+        char generated[MAX_CONTAINER_ID];
+        const char *id = renamed ? format_container_id(cm, generated) : rec->id;
+        container_info_t *info = alloc_container(cm, id, nullptr);
+        if (!info) {
+            continue;
+        }
+        info->pid = rec->pid;
+        info->state = static_cast<container_state_t>(rec->state);
+        info->created_at = rec->created_at;
+        info->started_at = rec->started_at;
+        info->stopped_at = rec->stopped_at;
+        if (active && namespace_open_pinned(namespace_pin_dir(), id, &info->ns_fds) != 0) {
+            open_namespaces(info, nullptr);
+        }
+        if (add_container(cm, info) == 0) {
+            if (renamed) {
+                journal_state(cm, info, STATE_RECORD_UPSERT);
             }
+            loaded++;
+        } else {
+            free_container(cm, info);
         }
     }
-    fclose(fp);
+    free(records);
+    if (state_journal_should_compact(cm->journal, cm->container_count)) {
+        compact_state(cm, 0, nullptr);
+    }
     return loaded;
 }
+static void *watch_exits(void *arg) {
+    container_manager_t *cm = static_cast<container_manager_t*>(arg);
+    pid_t pid;
+    int status;
+    while (reaper_next_exit(cm->reaper, &pid, &status) == 0) {
+        manager_guard guard(cm);
+        container_info_t *info = find_container_by_pid(cm, pid);
+        if (info && is_active(info)) {
+            mark_exited(cm, info, status);
+            journal_state(cm, info, STATE_RECORD_UPSERT);
+        }
+    }
+    return nullptr;
+}
 int container_manager_init(container_manager_t *cm, int max_containers) {
     if (!cm) {
         fprintf(stderr, "Error: container manager is NULL\n");
@@ -421,6 +545,27 @@ int container_manager_init(container_manager_t *cm, int max_containers) {
     }
     cm->max_containers = max_containers > 0 ? max_containers : DEFAULT_MAX_CONTAINERS;
     cm->container_count = 0;
+    cm->max_numeric_id = 0;
+    cm->journal = nullptr;
+    cm->pool = nullptr;
+    cm->ns_pool = nullptr;
+    cm->rootfs_cache = nullptr;
+    cm->zygote = nullptr;
+    cm->zygote_flags = 0;
+    start_histogram_init(&cm->start_stats);
+    cm->stop_timeout_ms = DEFAULT_STOP_TIMEOUT_MS;
+    cm->lock_depth = 0;
+    cm->snapshot_dirty = 0;
+    cm->snapshot_version = 0;
+    cm->snapshot = nullptr;
+    cm->retired = nullptr;
+    cm->epoch = 0;
+    cm->readers[0] = cm->readers[1] = 0;
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&cm->lock, &attr);
+    pthread_mutexattr_destroy(&attr);
     cm->rm = static_cast<resource_manager_t*>(malloc(sizeof(resource_manager_t)));
     if (!cm->rm) {
         perror("malloc resource manager failed");
@@ -432,8 +577,45 @@ int container_manager_init(container_manager_t *cm, int max_containers) {
         free(cm->rm);
         return -1;
     }
+    if (container_index_init(&cm->index, cm->max_containers) != 0) {
+        perror("container index allocation failed");
+        free(cm->containers);
+        free(cm->rm);
+        return -1;
+    }
     if (resource_manager_init(cm->rm, "mini_container") != 0) {
         fprintf(stderr, "Failed to initialize resource manager\n");
+        container_index_cleanup(&cm->index);
+        free(cm->containers);
+        free(cm->rm);
+        return -1;
+    }
+    cm->reaper = reaper_create();
+    if (!cm->reaper) {
+        fprintf(stderr, "Failed to initialize process reaper\n");
+        resource_manager_cleanup(cm->rm);
+        container_index_cleanup(&cm->index);
+        free(cm->containers);
+        free(cm->rm);
+        return -1;
+    }
+    cm->slab = slab_create();
+    if (!cm->slab) {
+        fprintf(stderr, "Failed to initialize container allocator\n");
+        reaper_destroy(cm->reaper);
+        resource_manager_cleanup(cm->rm);
+        container_index_cleanup(&cm->index);
+        free(cm->containers);
+        free(cm->rm);
+        return -1;
+    }
+    cm->events = event_bus_create(EVENT_BUS_DEFAULT_CAPACITY);
+    if (!cm->events) {
+        fprintf(stderr, "Failed to initialize event bus\n");
+        slab_destroy(cm->slab);
+        reaper_destroy(cm->reaper);
+        resource_manager_cleanup(cm->rm);
+        container_index_cleanup(&cm->index);
         free(cm->containers);
         free(cm->rm);
         return -1;
@@ -441,121 +623,154 @@ int container_manager_init(container_manager_t *cm, int max_containers) {
     int loaded = load_state(cm);
     if (loaded > 0) {
         fprintf(stderr, "Loaded %d container(s) from state file\n", loaded);
-        save_state(cm);
+    }
+    publish_snapshot(cm);
+    int err = pthread_create(&cm->exit_watcher, nullptr, watch_exits, cm);
+    if (err != 0) {
+        fprintf(stderr, "Failed to start exit watcher: %s\n", strerror(err));
+        reaper_destroy(cm->reaper);
+        cm->reaper = nullptr;
+        container_manager_cleanup(cm);
+        return -1;
     }
     return 0;
 }
-int container_manager_create(container_manager_t *cm,
-                           const container_config_t *config) {
-    DEBUG_LOG("container_manager_create called");
+static int create_cgroup_traced(container_manager_t *cm, const char *container_id,
+                                const resource_limits_t *limits, start_trace_t *trace) {
+    uint64_t begin = start_trace_now();
+    if (resource_manager_make_cgroup(cm->rm, container_id) != 0) {
+        return -1;
+    }
+    uint64_t made = start_trace_now();
+    if (resource_manager_apply_limits(cm->rm, container_id, limits) != 0) {
+        return -1;
+    }
+    if (trace) {
+        trace->phase_ns[START_PHASE_CGROUP_MKDIR] = made - begin;
+        trace->phase_ns[START_PHASE_CGROUP_LIMITS] = start_trace_now() - made;
+    }
+    return 0;
+}
+static int create_container(container_manager_t *cm, const container_config_t *config, bool with_cgroup,
+                            start_trace_t *trace) {
+    LOG_DEBUG("container_manager_create called");
     if (!cm || !config) {
-        ERROR_LOG("Invalid parameters: cm=%p, config=%p", (void*)cm, (void*)config);
+        LOG_ERROR("Invalid parameters: cm=%p, config=%p", (void*)cm, (void*)config);
         fprintf(stderr, "Error: invalid parameters\n");
         return -1;
     }
-    DEBUG_LOG("config->id=%p (%s)", (void*)config->id, config->id ? config->id : "NULL");
-    DEBUG_LOG("config->command=%p, config->command_argc=%d", (void*)config->command, config->command_argc);
+    if (config->fs_config.create_minimal_fs &&
+        (!config->fs_config.root_path || strcmp(config->fs_config.root_path, "/") == 0)) {
+        fprintf(stderr, "Error: a minimal root needs its own root path\n");
+        return -1;
+    }
+    manager_guard guard(cm);
+    LOG_DEBUG("config->id=%p (%s)", (void*)config->id, config->id ? config->id : "NULL");
+    LOG_DEBUG("config->command=%p, config->command_argc=%d", (void*)config->command, config->command_argc);
     if (config->command) {
         for (int i = 0; i < config->command_argc; i++) {
-            DEBUG_LOG("config->command[%d] = %p (%s)", i, (void*)config->command[i],
+            LOG_DEBUG("config->command[%d] = %p (%s)", i, (void*)config->command[i],
                       config->command[i] ? config->command[i] : "NULL");
         }
     }
-    char *container_id = config->id ? strdup(config->id) : generate_container_id(cm);
-    if (!container_id) {
-        ERROR_LOG("Failed to generate container ID");
-        perror("failed to generate container ID");
-        return -1;
-    }
-    DEBUG_LOG("Container ID: %s", container_id);
+    char generated[MAX_CONTAINER_ID];
+    const char *container_id = config->id ? config->id : format_container_id(cm, generated);
+    LOG_DEBUG("Container ID: %s", container_id);
     if (find_container(cm, container_id)) {
-        ERROR_LOG("Container %s already exists", container_id);
+        LOG_ERROR("Container %s already exists", container_id);
         fprintf(stderr, "Error: container %s already exists\n", container_id);
-        free(container_id);
         return -1;
     }
-    DEBUG_LOG("Allocating container_info_t");
-    container_info_t *info = static_cast<container_info_t*>(calloc(1, sizeof(container_info_t)));
+    container_info_t *info = alloc_container(cm, container_id, config);
     if (!info) {
-        ERROR_LOG("calloc failed for container_info_t");
-        perror("calloc container info failed");
-        free(container_id);
+        fprintf(stderr, "Failed to copy container configuration\n");
         return -1;
     }
-    DEBUG_LOG("container_info_t allocated: %p", (void*)info);
-    info->id = container_id;
     info->state = CONTAINER_CREATED;
     info->created_at = time(nullptr);
     info->pid = 0;
-    DEBUG_LOG("About to call copy_container_config");
-    DEBUG_LOG("config address: %p", (void*)config);
-    DEBUG_LOG("config->fs_config address: %p", (void*)&config->fs_config);
-    DEBUG_LOG("config->fs_config.root_path address: %p", (void*)&config->fs_config.root_path);
-    DEBUG_LOG("config->fs_config.root_path value: %p", (void*)config->fs_config.root_path);
-    if (config->fs_config.root_path) {
-        DEBUG_LOG("config->fs_config.root_path string: %s", config->fs_config.root_path);
-    }
-    fflush(stderr);
-    DEBUG_LOG("Calling copy_container_config");
-    fflush(stderr);
-    info->saved_config = copy_container_config(config);
-    fflush(stderr);
-    DEBUG_LOG("copy_container_config returned: %p", (void*)info->saved_config);
-    fflush(stderr);
-    if (!info->saved_config) {
-        ERROR_LOG("copy_container_config returned NULL");
-        fprintf(stderr, "Failed to copy container configuration\n");
-        free(info->id);
-        free(info);
-        return -1;
-    }
-    DEBUG_LOG("copy_container_config succeeded, saved_config=%p", (void*)info->saved_config);
-    DEBUG_LOG("Calling resource_manager_create_cgroup");
-    if (resource_manager_create_cgroup(cm->rm, container_id, &config->res_limits) != 0) {
-        ERROR_LOG("resource_manager_create_cgroup failed");
+    LOG_DEBUG("Calling resource_manager_create_cgroup");
+    if (with_cgroup && create_cgroup_traced(cm, container_id, &config->res_limits, trace) != 0) {
+        LOG_ERROR("resource_manager_create_cgroup failed");
         fprintf(stderr, "Failed to create resource cgroups\n");
-        free_container_config(info->saved_config);
-        free(info->id);
-        free(info);
+        free_container(cm, info);
         return -1;
     }
-    DEBUG_LOG("resource_manager_create_cgroup succeeded");
-    DEBUG_LOG("Checking fs_config.create_minimal_fs: %d", config->fs_config.create_minimal_fs);
-    if (config->fs_config.create_minimal_fs) {
-        DEBUG_LOG("Creating minimal root filesystem");
-        if (fs_create_minimal_root(config->fs_config.root_path) != 0) {
-            ERROR_LOG("fs_create_minimal_root failed");
-            fprintf(stderr, "Failed to create minimal root filesystem\n");
+    LOG_DEBUG("resource_manager_create_cgroup succeeded");
+    if (config->fs_config.method == FS_OVERLAY) {
+        uint64_t overlay_begin = start_trace_now();
+        if (fs_mount_overlay_root(&config->fs_config, container_id) != 0) {
+            fprintf(stderr, "Failed to mount overlay root filesystem\n");
+            fs_remove_overlay(container_id);
             resource_manager_destroy_cgroup(cm->rm, container_id);
-            free_container_config(info->saved_config);
-            free(info->id);
-            free(info);
+            free_container(cm, info);
             return -1;
         }
-        DEBUG_LOG("fs_create_minimal_root succeeded");
-        DEBUG_LOG("Populating container root");
-        if (fs_populate_container_root(config->fs_config.root_path, "/") != 0) {
-            DEBUG_LOG("Warning: failed to populate container root");
-            fprintf(stderr, "Warning: failed to populate container root\n");
+        if (trace) {
+            trace->phase_ns[START_PHASE_ROOTFS_CREATE] = start_trace_now() - overlay_begin;
+        }
+    }
+    LOG_DEBUG("Checking fs_config.create_minimal_fs: %d", config->fs_config.create_minimal_fs);
+    if (config->fs_config.create_minimal_fs) {
+        int extra = config->command_argc > 0 && config->command[0][0] == '/' ? 1 : 0;
+        uint64_t rootfs_begin = start_trace_now();
+        int shared = 0;
+        if (cm->rootfs_cache && rootfs_cache_instantiate(cm->rootfs_cache, config->fs_config.root_path, "/",
+                                                         config->command, extra, config->fs_config.enter_root,
+                                                         &shared) == 0) {
+            LOG_DEBUG("Instantiated container root from the rootfs cache");
+            info->saved_config->fs_config.read_only_root = shared;
+            if (trace) {
+                trace->phase_ns[START_PHASE_ROOTFS_POPULATE] = start_trace_now() - rootfs_begin;
+            }
+        } else {
+            if (cm->rootfs_cache) {
+                fprintf(stderr, "Warning: rootfs cache failed, building the container root directly\n");
+            }
+            LOG_DEBUG("Creating minimal root filesystem");
+            if (fs_create_minimal_root(config->fs_config.root_path) != 0) {
+                LOG_ERROR("fs_create_minimal_root failed");
+                fprintf(stderr, "Failed to create minimal root filesystem\n");
+                resource_manager_destroy_cgroup(cm->rm, container_id);
+                free_container(cm, info);
+                return -1;
+            }
+            LOG_DEBUG("fs_create_minimal_root succeeded");
+            LOG_DEBUG("Populating container root");
+            uint64_t populate_begin = start_trace_now();
+            if (fs_populate_container_root(config->fs_config.root_path, "/") != 0) {
+                LOG_DEBUG("Warning: failed to populate container root");
+                fprintf(stderr, "Warning: failed to populate container root\n");
+            }
+            if (extra && fs_populate_container_binaries(config->fs_config.root_path, "/", config->command, 1) != 0) {
+                fprintf(stderr, "Warning: failed to copy %s into container root\n", config->command[0]);
+            }
+            if (trace) {
+                trace->phase_ns[START_PHASE_ROOTFS_CREATE] = populate_begin - rootfs_begin;
+                trace->phase_ns[START_PHASE_ROOTFS_POPULATE] = start_trace_now() - populate_begin;
+            }
         }
     }
-    DEBUG_LOG("Calling add_container");
+    LOG_DEBUG("Calling add_container");
     if (add_container(cm, info) != 0) {
-        ERROR_LOG("add_container failed");
+        LOG_ERROR("add_container failed");
+        release_overlay(info);
         resource_manager_destroy_cgroup(cm->rm, container_id);
-        free_container_config(info->saved_config);
-        free(info->id);
-        free(info);
+        free_container(cm, info);
         return -1;
     }
-    DEBUG_LOG("add_container succeeded");
-    DEBUG_LOG("Calling save_state");
-    save_state(cm);
-    DEBUG_LOG("container_manager_create completed successfully");
+    LOG_DEBUG("add_container succeeded");
+    LOG_DEBUG("Appending state journal record");
+    journal_state(cm, info, STATE_RECORD_UPSERT);
+    event_bus_publish(cm->events, CONTAINER_EVENT_CREATED, info->id, 0, 0, 0);
+    LOG_DEBUG("container_manager_create completed successfully");
     return 0;
 }
-int container_manager_start(container_manager_t *cm, const char *container_id) {
-    container_info_t *info = container_manager_get_info(cm, container_id);
+int container_manager_create(container_manager_t *cm,
+                           const container_config_t *config) {
+    return create_container(cm, config, true, nullptr);
+}
+static int check_startable(const container_info_t *info, const char *container_id) {
     if (!info) {
         fprintf(stderr, "Error: container %s not found\n", container_id);
         return -1;
@@ -564,6 +779,10 @@ int container_manager_start(container_manager_t *cm, const char *container_id) {
         fprintf(stderr, "Error: container %s is already running\n", container_id);
         return -1;
     }
+    if (info->state == CONTAINER_PAUSED) {
+        fprintf(stderr, "Error: container %s is paused, resume it instead\n", container_id);
+        return -1;
+    }
     if (info->state == CONTAINER_DESTROYED) {
         fprintf(stderr, "Error: container %s has been destroyed\n", container_id);
         return -1;
@@ -576,9 +795,30 @@ int container_manager_start(container_manager_t *cm, const char *container_id) {
         fprintf(stderr, "Error: Cannot restart container %s - configuration not saved. This container was created before the restart feature was added.\n", container_id);
         return -1;
     }
-    container_config_t *config = info->saved_config;
-    if (resource_manager_create_cgroup(cm->rm, container_id, &config->res_limits) != 0) {
-        fprintf(stderr, "Error: Failed to create/recreate resource cgroups for container %s\n", container_id);
+    return 0;
+}
+static int acquire_namespaces(container_manager_t *cm, const namespace_config_t *ns_config,
+                              namespace_fds_t *joined) {
+    static const int pooled[] = { NS_NET, NS_USER };
+    namespace_fds_init(joined);
+    for (size_t i = 0; i < sizeof(pooled) / sizeof(pooled[0]); i++) {
+        if (!(ns_config->flags & pooled[i])) {
+            continue;
+        }
+        int fd = ns_pool_acquire(cm->ns_pool, pooled[i]);
+        if (fd == -1) {
+            fprintf(stderr, "Error: Failed to create %s namespace: %s\n", namespace_kind_name(pooled[i]),
+                    strerror(errno));
+            namespace_close_fds(joined);
+            return -1;
+        }
+        namespace_fds_set(joined, pooled[i], fd);
+    }
+    return 0;
+}
+static pid_t spawn_container(container_manager_t *cm, const char *container_id, container_config_t *config,
+                             const int *stdio_fds, namespace_fds_t *joined, start_trace_t *trace) {
+    if (acquire_namespaces(cm, &config->ns_config, joined) != 0) {
         return -1;
     }
     struct cgroup_callback_data {
@@ -589,132 +829,494 @@ int container_manager_start(container_manager_t *cm, const char *container_id) {
         .rm = cm->rm,
         .container_id = container_id
     };
-    auto add_to_cgroup = [](pid_t pid, void *user_data) -> void {
+    auto add_to_cgroup = [](pid_t pid, void *user_data) -> int {
         cgroup_callback_data *data = static_cast<cgroup_callback_data*>(user_data);
-        resource_manager_add_process(data->rm, data->container_id, pid);
+        return resource_manager_add_process(data->rm, data->container_id, pid);
     };
-    pid_t pid = namespace_create_container_with_cgroup(&config->ns_config,
-                                                      config->command,
-                                                      config->command_argc,
-                                                      add_to_cgroup,
-                                                      &callback_data);
+    namespace_config_t ns_config = config->ns_config;
+    if (config->fs_config.method == FS_BIND_RO) {
+        const char *root = config->fs_config.root_path;
+        ns_config.bind_root = root && strcmp(root, "/") != 0 ? root : FS_BIND_STAGING_DIR;
+    }
+    char overlay_root[PATH_MAX];
+    if (config->fs_config.method == FS_OVERLAY) {
+        if (fs_mount_overlay_root(&config->fs_config, container_id) != 0 ||
+            fs_overlay_root_path(&config->fs_config, container_id, overlay_root, sizeof(overlay_root)) != 0) {
+            namespace_close_fds(joined);
+            return -1;
+        }
+        ns_config.enter_root = overlay_root;
+    } else if (config->fs_config.create_minimal_fs && config->fs_config.enter_root) {
+        ns_config.enter_root = config->fs_config.root_path;
+        ns_config.read_only_root = config->fs_config.read_only_root;
+    }
+    int cgroup_fd = resource_manager_open_cgroup(cm->rm, container_id);
+    namespace_start_trace_t ns_trace;
+    pid_t pid = namespace_create_container_in_cgroup(&ns_config, config->command, config->command_argc,
+                                                     stdio_fds, cgroup_fd, joined, trace ? &ns_trace : nullptr,
+                                                     add_to_cgroup, &callback_data);
+    if (cgroup_fd >= 0) {
+        close(cgroup_fd);
+    }
+    if (trace && pid > 0) {
+        trace->phase_ns[START_PHASE_CLONE] = ns_trace.clone_ns;
+        trace->phase_ns[START_PHASE_CGROUP_ATTACH] = ns_trace.cgroup_attach_ns;
+        trace->phase_ns[START_PHASE_MOUNT_SETUP] = ns_trace.mount_ns;
+        trace->phase_ns[START_PHASE_EXEC] = ns_trace.exec_ns;
+    }
     if (pid == -1) {
-        fprintf(stderr, "Error: Failed to start container %s\n", container_id);
+        namespace_close_fds(joined);
+    }
+    return pid;
+}
+static pid_t launch_container(container_manager_t *cm, const char *container_id, container_config_t *config,
+                              namespace_fds_t *joined, start_trace_t *trace) {
+    start_trace_begin(trace);
+    if (create_cgroup_traced(cm, container_id, &config->res_limits, trace) != 0) {
+        fprintf(stderr, "Error: Failed to create/recreate resource cgroups for container %s\n", container_id);
         return -1;
     }
-    info->pid = pid;
+    pid_t pid = spawn_container(cm, container_id, config, nullptr, joined, trace);
+    if (pid == -1) {
+        fprintf(stderr, "Error: Failed to start container %s\n", container_id);
+    }
+    return pid;
+}
+static void mark_started(container_manager_t *cm, container_info_t *info, pid_t pid, int pidfd,
+                         namespace_fds_t *joined, start_trace_t *trace) {
+    if (trace) {
+        start_trace_finish(trace);
+        info->start_trace = *trace;
+        start_histogram_record(&cm->start_stats, trace);
+    }
+    set_container_pid(cm, info, pid, pidfd);
+    cm->snapshot_dirty = 1;
     info->state = CONTAINER_RUNNING;
     info->started_at = time(nullptr);
     info->stopped_at = 0;
-    save_state(cm);
-    return 0;
+    open_namespaces(info, joined);
+    event_bus_publish(cm->events, CONTAINER_EVENT_STARTED, info->id, pid, 0, 0);
 }
-int container_manager_stop(container_manager_t *cm, const char *container_id) {
+static void mark_stopped(container_manager_t *cm, container_info_t *info) {
+    release_namespaces(info);
+    cm->snapshot_dirty = 1;
+    info->state = CONTAINER_STOPPED;
+    info->stopped_at = time(nullptr);
+}
+static void publish_exit(container_manager_t *cm, const container_info_t *info, int status) {
+    if (WIFSIGNALED(status) && WTERMSIG(status) == SIGKILL &&
+        resource_manager_oom_kills(cm->rm, info->id) > 0) {
+        event_bus_publish(cm->events, CONTAINER_EVENT_OOM, info->id, info->pid, 0, SIGKILL);
+    }
+    event_bus_publish(cm->events, CONTAINER_EVENT_EXITED, info->id, info->pid,
+                      WIFEXITED(status) ? WEXITSTATUS(status) : 0,
+                      WIFSIGNALED(status) ? WTERMSIG(status) : 0);
+}
+static void mark_exited(container_manager_t *cm, container_info_t *info, int status) {
+    publish_exit(cm, info, status);
+    mark_stopped(cm, info);
+}
+static void finish_stop(container_manager_t *cm, container_info_t *info) {
+    int status;
+    if (reaper_wait(cm->reaper, info->pid, 0, &status) == 0) {
+        publish_exit(cm, info, status);
+    }
+    mark_stopped(cm, info);
+    event_bus_publish(cm->events, CONTAINER_EVENT_STOPPED, info->id, info->pid, 0, 0);
+}
+int container_manager_start(container_manager_t *cm, const char *container_id) {
+    manager_guard guard(cm);
     container_info_t *info = container_manager_get_info(cm, container_id);
-    if (!info) {
-        fprintf(stderr, "Error: container %s not found\n", container_id);
+    if (check_startable(info, container_id) != 0) {
         return -1;
     }
-    if (info->state != CONTAINER_RUNNING) {
-        fprintf(stderr, "Error: container %s is not running\n", container_id);
+    namespace_fds_t joined;
+    start_trace_t trace;
+    pid_t pid = launch_container(cm, info->id, info->saved_config, &joined, &trace);
+    if (pid == -1) {
         return -1;
     }
-    const char *actual_container_id = info->id;
-    char cgroup_procs_path[512];
-    if (cm->rm->version == CGROUP_V2) {
-        snprintf(cgroup_procs_path, sizeof(cgroup_procs_path),
-                 "/sys/fs/cgroup/%s_%s/cgroup.procs", cm->rm->cgroup_path, actual_container_id);
-    } else {
-        snprintf(cgroup_procs_path, sizeof(cgroup_procs_path),
-                 "/sys/fs/cgroup/cpu,cpuacct/%s_%s/tasks", cm->rm->cgroup_path, actual_container_id);
+    mark_started(cm, info, pid, -1, &joined, &trace);
+    journal_state(cm, info, STATE_RECORD_UPSERT);
+    return 0;
+}
+int container_manager_stop(container_manager_t *cm, const char *container_id) {
+    string id;
+    pid_t pid;
+    int timeout_ms;
+    {
+        manager_guard guard(cm);
+        container_info_t *info = container_manager_get_info(cm, container_id);
+        if (!info) {
+            fprintf(stderr, "Error: container %s not found\n", container_id);
+            return -1;
+        }
+        if (!is_active(info)) {
+            fprintf(stderr, "Error: container %s is not running\n", container_id);
+            return -1;
+        }
+        thaw_if_paused(cm, info);
+        id = info->id;
+        pid = info->pid;
+        timeout_ms = cm->stop_timeout_ms;
+    }
+    stop_container_processes(cm, id.c_str(), pid, timeout_ms);
+    manager_guard guard(cm);
+    container_info_t *info = container_manager_get_info(cm, id.c_str());
+    if (!info || info->pid != pid) {
+        return 0;
     }
-    FILE *fp = fopen(cgroup_procs_path, "r");
-    if (fp) {
-        pid_t pid;
-        while (fscanf(fp, "%d", &pid) == 1) {
-            if (pid > 0) {
-                kill_process_tree(pid);
+    if (is_active(info)) {
+        finish_stop(cm, info);
+        journal_state(cm, info, STATE_RECORD_UPSERT);
+    } else if (info->state == CONTAINER_STOPPED) {
+        event_bus_publish(cm->events, CONTAINER_EVENT_STOPPED, info->id, info->pid, 0, 0);
+    }
+    return 0;
+}
+int container_manager_wait(container_manager_t *cm, const char *container_id, int timeout_ms, int *status) {
+    pid_t pid;
+    {
+        manager_guard guard(cm);
+        container_info_t *info = container_manager_get_info(cm, container_id);
+        if (!info) {
+            fprintf(stderr, "Error: container %s not found\n", container_id);
+            return -1;
+        }
+        if (!is_active(info)) {
+            if (status && (info->pid <= 0 || reaper_wait(cm->reaper, info->pid, 0, status) != 0)) {
+                fprintf(stderr, "Error: exit status of container %s is not known\n", container_id);
+                return -1;
             }
+            return 0;
         }
-        fclose(fp);
+        pid = info->pid;
     }
-    kill_process_tree(info->pid);
-    int status;
-    int waited = 0;
-    for (int i = 0; i < 50; i++) {
-        if (waitpid(info->pid, &status, WNOHANG) == info->pid) {
-            waited = 1;
-            break;
-        }
-        usleep(100000);
+    int exit_status = 0;
+    int ret = reaper_wait(cm->reaper, pid, timeout_ms, &exit_status);
+    if (ret != 0) {
+        return ret;
     }
-    if (!waited) {
-        if (kill(info->pid, 0) == 0) {
-            kill(info->pid, SIGKILL);
-            usleep(200000);
-            waitpid(info->pid, &status, WNOHANG);
-        }
+    if (status) {
+        *status = exit_status;
+    }
+    manager_guard guard(cm);
+    container_info_t *info = find_container_by_pid(cm, pid);
+    if (info && is_active(info)) {
+        mark_exited(cm, info, exit_status);
+        journal_state(cm, info, STATE_RECORD_UPSERT);
     }
-    info->state = CONTAINER_STOPPED;
-    info->stopped_at = time(nullptr);
-    save_state(cm);
     return 0;
 }
+void container_manager_set_stop_timeout(container_manager_t *cm, int timeout_ms) {
+    if (!cm) return;
+    manager_guard guard(cm);
+    cm->stop_timeout_ms = timeout_ms >= 0 ? timeout_ms : DEFAULT_STOP_TIMEOUT_MS;
+}
 int container_manager_destroy(container_manager_t *cm, const char *container_id) {
+    manager_guard guard(cm);
     container_info_t *info = container_manager_get_info(cm, container_id);
     if (!info) {
         fprintf(stderr, "Error: container %s not found\n", container_id);
         return -1;
     }
     const char *actual_container_id = info->id;
-    if (info->state == CONTAINER_RUNNING) {
+    if (is_active(info)) {
         if (container_manager_stop(cm, actual_container_id) != 0) {
             fprintf(stderr, "Warning: failed to stop container during destroy\n");
         }
     }
     resource_manager_destroy_cgroup(cm->rm, actual_container_id);
+    release_overlay(info);
+    journal_state(cm, info, STATE_RECORD_REMOVE);
+    event_bus_publish(cm->events, CONTAINER_EVENT_DESTROYED, info->id, info->pid, 0, 0);
     remove_container(cm, container_id);
-    save_state(cm);
     return 0;
 }
-int container_manager_exec(container_manager_t *cm,
-                          const char *container_id,
-                          char **command,
-                          int argc) {
-    (void)argc;
-    container_info_t *info = find_container(cm, container_id);
+int container_manager_pause(container_manager_t *cm, const char *container_id) {
+    manager_guard guard(cm);
+    container_info_t *info = container_manager_get_info(cm, container_id);
     if (!info) {
         fprintf(stderr, "Error: container %s not found\n", container_id);
-        return -1;
+        return CONTAINER_NOT_FOUND;
     }
     if (info->state != CONTAINER_RUNNING) {
         fprintf(stderr, "Error: container %s is not running\n", container_id);
         return -1;
     }
-    pid_t pid = fork();
-    if (pid == -1) {
-        perror("fork failed");
+    if (resource_manager_freeze(cm->rm, info->id, 1) != 0) {
+        fprintf(stderr, "Error: failed to pause container %s\n", container_id);
+        return -1;
+    }
+    cm->snapshot_dirty = 1;
+    info->state = CONTAINER_PAUSED;
+    journal_state(cm, info, STATE_RECORD_UPSERT);
+    event_bus_publish(cm->events, CONTAINER_EVENT_PAUSED, info->id, info->pid, 0, 0);
+    return 0;
+}
+int container_manager_resume(container_manager_t *cm, const char *container_id) {
+    manager_guard guard(cm);
+    container_info_t *info = container_manager_get_info(cm, container_id);
+    if (!info) {
+        fprintf(stderr, "Error: container %s not found\n", container_id);
+        return CONTAINER_NOT_FOUND;
+    }
+    if (info->state != CONTAINER_PAUSED) {
+        fprintf(stderr, "Error: container %s is not paused\n", container_id);
+        return -1;
+    }
+    if (resource_manager_freeze(cm->rm, info->id, 0) != 0) {
+        fprintf(stderr, "Error: failed to resume container %s\n", container_id);
+        return -1;
+    }
+    cm->snapshot_dirty = 1;
+    info->state = CONTAINER_RUNNING;
+    journal_state(cm, info, STATE_RECORD_UPSERT);
+    event_bus_publish(cm->events, CONTAINER_EVENT_RESUMED, info->id, info->pid, 0, 0);
+    return 0;
+}
+static void run_batch(int count, const function<void(int)> &work, const function<void(int)> &apply) {
+    int workers = count < BATCH_MAX_WORKERS ? count : BATCH_MAX_WORKERS;
+    atomic<int> next(0);
+    mutex lock;
+    condition_variable cond;
+    deque<int> done;
+    vector<thread> pool;
+    for (int w = 0; w < workers; w++) {
+        pool.emplace_back([&]() {
+            for (int i = next++; i < count; i = next++) {
+                work(i);
+                lock_guard<mutex> guard(lock);
+                done.push_back(i);
+                cond.notify_one();
+            }
+        });
+    }
+    for (int applied = 0; applied < count; applied++) {
+        unique_lock<mutex> guard(lock);
+        cond.wait(guard, [&]() { return !done.empty(); });
+        int i = done.front();
+        done.pop_front();
+        guard.unlock();
+        apply(i);
+    }
+    for (auto &t : pool) {
+        t.join();
+    }
+}
+static int finish_batch(container_manager_t *cm, vector<state_record_t> &records, const int *results, int count) {
+    if (cm->journal && !records.empty()) {
+        state_journal_append_batch(cm->journal, records.data(), (int)records.size());
+        state_journal_sync(cm->journal);
+        if (state_journal_should_compact(cm->journal, cm->container_count)) {
+            compact_state(cm, 0, nullptr);
+        }
+    }
+    int failed = 0;
+    for (int i = 0; i < count; i++) {
+        if (results[i] != 0) failed++;
+    }
+    return failed;
+}
+static container_info_t *claim_batch_item(container_manager_t *cm, const char *container_id,
+                                          unordered_set<container_info_t*> &claimed) {
+    container_info_t *info = container_manager_get_info(cm, container_id);
+    if (!info) {
+        fprintf(stderr, "Error: container %s not found\n", container_id);
+        return nullptr;
+    }
+    if (!claimed.insert(info).second) {
+        fprintf(stderr, "Error: container %s listed more than once\n", container_id);
+        return nullptr;
+    }
+    return info;
+}
+int container_manager_start_many(container_manager_t *cm, const char *const *container_ids, int count,
+                                 int *results, container_batch_callback_t callback, void *user_data) {
+    if (!cm || count < 0 || (count > 0 && !container_ids)) {
         return -1;
     }
-    if (pid == 0) {
-        if (namespace_join(info->pid, CLONE_NEWPID) != 0) {
-            fprintf(stderr, "Failed to join PID namespace\n");
-            exit(EXIT_FAILURE);
+    manager_guard guard(cm);
+    vector<container_info_t*> infos(count, nullptr);
+    vector<pid_t> pids(count, -1);
+    vector<namespace_fds_t> joined(count);
+    vector<start_trace_t> traces(count);
+    vector<int> status(count, -1);
+    vector<int> pending;
+    unordered_set<container_info_t*> claimed;
+    for (int i = 0; i < count; i++) {
+        container_info_t *info = claim_batch_item(cm, container_ids[i], claimed);
+        if (info && check_startable(info, container_ids[i]) == 0) {
+            infos[i] = info;
+            pending.push_back(i);
+        } else if (callback) {
+            callback(container_ids[i], -1, user_data);
         }
-        if (namespace_join(info->pid, CLONE_NEWNS) != 0) {
-            fprintf(stderr, "Failed to join mount namespace\n");
-            exit(EXIT_FAILURE);
+    }
+    vector<state_record_t> records;
+    run_batch((int)pending.size(), [&](int k) {
+        int i = pending[k];
+        pids[i] = launch_container(cm, infos[i]->id, infos[i]->saved_config, &joined[i], &traces[i]);
+    }, [&](int k) {
+        int i = pending[k];
+        if (pids[i] != -1) {
+            mark_started(cm, infos[i], pids[i], -1, &joined[i], &traces[i]);
+            state_record_t rec;
+            make_state_record(&rec, infos[i], STATE_RECORD_UPSERT);
+            records.push_back(rec);
+            status[i] = 0;
         }
-        execvp(command[0], command);
-        perror("execvp failed");
-        exit(EXIT_FAILURE);
+        if (callback) callback(container_ids[i], status[i], user_data);
+    });
+    if (results) {
+        memcpy(results, status.data(), count * sizeof(int));
     }
-    int status;
-    if (waitpid(pid, &status, 0) == -1) {
-        perror("waitpid failed");
+    return finish_batch(cm, records, status.data(), count);
+}
+int container_manager_stop_many(container_manager_t *cm, const char *const *container_ids, int count,
+                                int timeout_ms, int *results, container_batch_callback_t callback,
+                                void *user_data) {
+    if (!cm || count < 0 || (count > 0 && !container_ids)) {
         return -1;
     }
-    return WEXITSTATUS(status);
+    manager_guard guard(cm);
+    if (timeout_ms < 0) {
+        timeout_ms = cm->stop_timeout_ms;
+    }
+    vector<container_info_t*> infos(count, nullptr);
+    vector<int> status(count, -1);
+    vector<int> pending;
+    unordered_set<container_info_t*> claimed;
+    for (int i = 0; i < count; i++) {
+        container_info_t *info = claim_batch_item(cm, container_ids[i], claimed);
+        if (info && !is_active(info)) {
+            fprintf(stderr, "Error: container %s is not running\n", container_ids[i]);
+            info = nullptr;
+        }
+        if (info) {
+            infos[i] = info;
+            pending.push_back(i);
+        } else if (callback) {
+            callback(container_ids[i], -1, user_data);
+        }
+    }
+    vector<state_record_t> records;
+    run_batch((int)pending.size(), [&](int k) {
+        int i = pending[k];
+        thaw_if_paused(cm, infos[i]);
+        stop_container_processes(cm, infos[i]->id, infos[i]->pid, timeout_ms);
+    }, [&](int k) {
+        int i = pending[k];
+        finish_stop(cm, infos[i]);
+        state_record_t rec;
+        make_state_record(&rec, infos[i], STATE_RECORD_UPSERT);
+        records.push_back(rec);
+        status[i] = 0;
+        if (callback) callback(container_ids[i], 0, user_data);
+    });
+    if (results) {
+        memcpy(results, status.data(), count * sizeof(int));
+    }
+    return finish_batch(cm, records, status.data(), count);
+}
+int container_manager_destroy_many(container_manager_t *cm, const char *const *container_ids, int count,
+                                   int *results, container_batch_callback_t callback, void *user_data) {
+    if (!cm || count < 0 || (count > 0 && !container_ids)) {
+        return -1;
+    }
+    manager_guard guard(cm);
+    int stop_timeout_ms = cm->stop_timeout_ms;
+    vector<container_info_t*> infos(count, nullptr);
+    vector<int> status(count, -1);
+    vector<int> pending;
+    unordered_set<container_info_t*> claimed;
+    for (int i = 0; i < count; i++) {
+        container_info_t *info = claim_batch_item(cm, container_ids[i], claimed);
+        if (info) {
+            infos[i] = info;
+            pending.push_back(i);
+        } else if (callback) {
+            callback(container_ids[i], -1, user_data);
+        }
+    }
+    vector<state_record_t> records;
+    run_batch((int)pending.size(), [&](int k) {
+        container_info_t *info = infos[pending[k]];
+        if (is_active(info)) {
+            thaw_if_paused(cm, info);
+            stop_container_processes(cm, info->id, info->pid, stop_timeout_ms);
+        }
+        resource_manager_destroy_cgroup(cm->rm, info->id);
+        release_overlay(info);
+    }, [&](int k) {
+        int i = pending[k];
+        if (is_active(infos[i])) {
+            finish_stop(cm, infos[i]);
+        }
+        state_record_t rec;
+        make_state_record(&rec, infos[i], STATE_RECORD_REMOVE);
+        records.push_back(rec);
+        status[i] = 0;
+        if (callback) callback(container_ids[i], 0, user_data);
+        event_bus_publish(cm->events, CONTAINER_EVENT_DESTROYED, infos[i]->id, infos[i]->pid, 0, 0);
+        remove_container(cm, infos[i]->id);
+    });
+    if (results) {
+        memcpy(results, status.data(), count * sizeof(int));
+    }
+    return finish_batch(cm, records, status.data(), count);
+}
+pid_t container_manager_exec_spawn(container_manager_t *cm, const char *container_id, char **command,
+                                   const int *stdio_fds, int *pidfd) {
+    if (!cm || !container_id || !command || !command[0]) {
+        fprintf(stderr, "Error: invalid parameters\n");
+        return -1;
+    }
+    manager_guard guard(cm);
+    container_info_t *info = container_manager_get_info(cm, container_id);
+    if (!info) {
+        fprintf(stderr, "Error: container %s not found\n", container_id);
+        return -1;
+    }
+    if (info->state == CONTAINER_PAUSED) {
+        fprintf(stderr, "Error: container %s is paused\n", container_id);
+        return -1;
+    }
+    if (info->state != CONTAINER_RUNNING) {
+        fprintf(stderr, "Error: container %s is not running\n", container_id);
+        return -1;
+    }
+    if (open_namespaces(info, nullptr) != 0) {
+        return -1;
+    }
+    int procs[RESOURCE_MANAGER_MAX_PROCS_FDS];
+    int procs_count = resource_manager_open_procs(cm->rm, info->id, procs, RESOURCE_MANAGER_MAX_PROCS_FDS);
+    if (procs_count < 0) {
+        procs_count = 0;
+    }
+    pid_t pid = namespace_spawn(&info->ns_fds, procs, procs_count, command, stdio_fds, pidfd);
+    for (int i = 0; i < procs_count; i++) {
+        close(procs[i]);
+    }
+    return pid;
+}
+int container_manager_exec(container_manager_t *cm,
+                          const char *container_id,
+                          char **command,
+                          int argc) {
+    (void)argc;
+    pid_t pid = container_manager_exec_spawn(cm, container_id, command, nullptr, nullptr);
+    if (pid == -1) {
+        return -1;
+    }
+    int status;
+    while (waitpid(pid, &status, 0) == -1) {
+        if (errno != EINTR) {
+            perror("waitpid failed");
+            return -1;
+        }
+    }
+    return WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
 }
 container_info_t **container_manager_list(container_manager_t *cm, int *count) {
     if (!cm || !count) {
@@ -723,13 +1325,29 @@ container_info_t **container_manager_list(container_manager_t *cm, int *count) {
     *count = cm->container_count;
     return cm->containers;
 }
-static container_info_t *find_container_by_pid(container_manager_t *cm, pid_t pid) {
-    for (int i = 0; i < cm->container_count; i++) {
-        if (cm->containers[i]->pid == pid) {
-            return cm->containers[i];
+const container_snapshot_t *container_manager_snapshot_acquire(container_manager_t *cm, uint64_t *ticket) {
+    if (!cm || !ticket) {
+        return nullptr;
+    }
+    uint64_t epoch;
+    while (true) {
+        epoch = __atomic_load_n(&cm->epoch, __ATOMIC_SEQ_CST);
+        __atomic_fetch_add(&cm->readers[epoch & 1], 1, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&cm->epoch, __ATOMIC_SEQ_CST) == epoch) {
+            break;
         }
+        __atomic_fetch_sub(&cm->readers[epoch & 1], 1, __ATOMIC_SEQ_CST);
     }
-    return nullptr;
+    *ticket = epoch;
+    return __atomic_load_n(&cm->snapshot, __ATOMIC_SEQ_CST);
+}
+void container_manager_snapshot_release(container_manager_t *cm, uint64_t ticket) {
+    if (!cm) return;
+    __atomic_fetch_sub(&cm->readers[ticket & 1], 1, __ATOMIC_SEQ_CST);
+}
+static container_info_t *find_container_by_pid(container_manager_t *cm, pid_t pid) {
+    int slot = container_index_lookup_pid(&cm->index, pid);
+    return slot >= 0 ? cm->containers[slot] : nullptr;
 }
 container_info_t *container_manager_get_info(container_manager_t *cm,
                                            const char *container_id) {
@@ -746,7 +1364,22 @@ container_info_t *container_manager_get_info(container_manager_t *cm,
 }
 void container_manager_cleanup(container_manager_t *cm) {
     if (!cm) return;
-    save_state(cm);
+    if (cm->reaper) {
+        reaper_shutdown(cm->reaper);
+        pthread_join(cm->exit_watcher, nullptr);
+    }
+    container_pool_destroy(cm->pool);
+    cm->pool = nullptr;
+    ns_pool_destroy(cm->ns_pool);
+    cm->ns_pool = nullptr;
+    rootfs_cache_destroy(cm->rootfs_cache);
+    cm->rootfs_cache = nullptr;
+    zygote_destroy(cm->zygote);
+    cm->zygote = nullptr;
+    if (cm->journal) {
+        state_journal_close(cm->journal);
+        cm->journal = nullptr;
+    }
     if (cm->rm) {
         resource_manager_cleanup(cm->rm);
         free(cm->rm);
@@ -754,83 +1387,199 @@ void container_manager_cleanup(container_manager_t *cm) {
     if (cm->containers) {
         for (int i = 0; i < cm->container_count; i++) {
             if (cm->containers[i]) {
-                free_container_config(cm->containers[i]->saved_config);
-                free(cm->containers[i]->id);
-                free(cm->containers[i]);
+                free_container(cm, cm->containers[i]);
             }
         }
         free(cm->containers);
     }
+    slab_destroy(cm->slab);
+    cm->slab = nullptr;
+    container_index_cleanup(&cm->index);
+    reaper_destroy(cm->reaper);
+    cm->reaper = nullptr;
+    event_bus_destroy(cm->events);
+    cm->events = nullptr;
+    free_snapshot(cm->snapshot);
+    cm->snapshot = nullptr;
+    while (cm->retired) {
+        container_snapshot_t *next = cm->retired->next_retired;
+        free_snapshot(cm->retired);
+        cm->retired = next;
+    }
+    pthread_mutex_destroy(&cm->lock);
+}
+static int register_pooled(container_manager_t *cm, container_config_t *config, pid_t pid,
+                           start_trace_t *trace) {
+    if (create_container(cm, config, false, nullptr) != 0) {
+        kill(pid, SIGKILL);
+        while (waitpid(pid, nullptr, 0) == -1 && errno == EINTR) {
+        }
+        resource_manager_destroy_cgroup(cm->rm, config->id);
+        return -1;
+    }
+    container_info_t *info = find_container(cm, config->id);
+    trace->pooled = 1;
+    mark_started(cm, info, pid, -1, nullptr, trace);
+    journal_state(cm, info, STATE_RECORD_UPSERT);
+    LOG_DEBUG("container %s claimed pooled pid=%d", config->id, pid);
+    return 0;
+}
+int container_manager_enable_pool(container_manager_t *cm, int low_watermark, int high_watermark) {
+    if (!cm || !cm->rm) return -1;
+    manager_guard guard(cm);
+    if (cm->pool) {
+        return 0;
+    }
+    cm->pool = container_pool_create(cm->rm, low_watermark, high_watermark);
+    return cm->pool ? 0 : -1;
+}
+void container_manager_get_start_stats(container_manager_t *cm, start_histogram_t *stats) {
+    if (!cm || !stats) return;
+    manager_guard guard(cm);
+    *stats = cm->start_stats;
+}
+int container_manager_enable_ns_pool(container_manager_t *cm, int target) {
+    if (!cm) return -1;
+    manager_guard guard(cm);
+    if (cm->ns_pool) {
+        return 0;
+    }
+    cm->ns_pool = ns_pool_create(use_state_dir() ? NS_POOL_DIR : NS_POOL_DIR_FALLBACK,
+                                 target > 0 ? target : NS_POOL_DEFAULT_TARGET);
+    return cm->ns_pool ? 0 : -1;
+}
+static int zygote_status(pid_t pid, int *status, void *user_data) {
+    return zygote_wait(static_cast<zygote_t*>(user_data), pid, -1, status);
+}
+int container_manager_enable_zygote(container_manager_t *cm) {
+    if (!cm) return -1;
+    manager_guard guard(cm);
+    if (cm->zygote) {
+        return 0;
+    }
+    namespace_config_t ns_config;
+    namespace_config_init(&ns_config);
+    cm->zygote = zygote_create(&ns_config);
+    if (!cm->zygote) {
+        return -1;
+    }
+    cm->zygote_flags = ns_config.flags;
+    reaper_set_status_source(cm->reaper, zygote_status, cm->zygote);
+    return 0;
+}
+static int run_in_zygote(container_manager_t *cm, container_config_t *config, const int *stdio_fds,
+                         start_trace_t *trace) {
+    if (create_container(cm, config, true, trace) != 0) {
+        return -1;
+    }
+    container_info_t *info = find_container(cm, config->id);
+    int procs[RESOURCE_MANAGER_MAX_PROCS_FDS];
+    int procs_count = resource_manager_open_procs(cm->rm, config->id, procs, RESOURCE_MANAGER_MAX_PROCS_FDS);
+    if (procs_count <= 0) {
+        fprintf(stderr, "Error: failed to open cgroups of container %s\n", config->id);
+        container_manager_destroy(cm, config->id);
+        return -1;
+    }
+    uint64_t spawn_begin = start_trace_now();
+    int pidfd = -1;
+    pid_t pid = zygote_spawn(cm->zygote, config->command, nullptr, procs, procs_count, stdio_fds, &pidfd);
+    for (int i = 0; i < procs_count; i++) {
+        close(procs[i]);
+    }
+    if (pid == -1) {
+        container_manager_destroy(cm, config->id);
+        return -1;
+    }
+    trace->phase_ns[START_PHASE_CLONE] = start_trace_now() - spawn_begin;
+    mark_started(cm, info, pid, pidfd, nullptr, trace);
+    journal_state(cm, info, STATE_RECORD_UPSERT);
+    LOG_DEBUG("container %s spawned by zygote pid=%d", config->id, pid);
+    return 0;
+}
+int container_manager_enable_rootfs_cache(container_manager_t *cm, unsigned long long budget) {
+    if (!cm) return -1;
+    manager_guard guard(cm);
+    if (cm->rootfs_cache) {
+        return 0;
+    }
+    cm->rootfs_cache = rootfs_cache_create(ROOTFS_CACHE_DIR, budget);
+    return cm->rootfs_cache ? 0 : -1;
+}
+void container_manager_get_rootfs_cache_stats(container_manager_t *cm, rootfs_cache_stats_t *stats) {
+    if (!cm || !stats) return;
+    memset(stats, 0, sizeof(*stats));
+    rootfs_cache_get_stats(cm->rootfs_cache, stats);
 }
 int container_manager_run(container_manager_t *cm, container_config_t *config) {
-    DEBUG_LOG("container_manager_run called");
+    return container_manager_run_attached(cm, config, nullptr);
+}
+int container_manager_run_attached(container_manager_t *cm, container_config_t *config,
+                                   const int *stdio_fds) {
+    LOG_DEBUG("container_manager_run called");
     if (!cm || !config) {
-        ERROR_LOG("Invalid parameters: cm=%p, config=%p", (void*)cm, (void*)config);
+        LOG_ERROR("Invalid parameters: cm=%p, config=%p", (void*)cm, (void*)config);
         return -1;
     }
-    DEBUG_LOG("Container ID: %s", config->id ? config->id : "NULL");
+    start_trace_t trace;
+    start_trace_begin(&trace);
+    manager_guard guard(cm);
+    LOG_DEBUG("Container ID: %s", config->id ? config->id : "NULL");
     if (!config->id) {
         config->id = generate_container_id(cm);
         if (!config->id) {
-            ERROR_LOG("Failed to generate container ID");
+            LOG_ERROR("Failed to generate container ID");
             return -1;
         }
     }
-    DEBUG_LOG("Calling container_manager_create");
-    if (container_manager_create(cm, config) != 0) {
-        ERROR_LOG("container_manager_create failed");
+    if (cm->pool && !config->fs_config.create_minimal_fs && config->fs_config.method == FS_CHROOT) {
+        pid_t pid = container_pool_claim(cm->pool, &config->ns_config, &config->res_limits,
+                                         config->id, config->command, stdio_fds);
+        if (pid > 0) {
+            return register_pooled(cm, config, pid, &trace);
+        }
+    }
+    if (cm->zygote && !config->fs_config.create_minimal_fs && config->fs_config.method == FS_CHROOT &&
+        config->ns_config.flags == cm->zygote_flags) {
+        return run_in_zygote(cm, config, stdio_fds, &trace);
+    }
+    LOG_DEBUG("Calling container_manager_create");
+    if (create_container(cm, config, true, &trace) != 0) {
+        LOG_ERROR("container_manager_create failed");
         return -1;
     }
-    DEBUG_LOG("container_manager_create succeeded, finding container");
+    LOG_DEBUG("container_manager_create succeeded, finding container");
     container_info_t *info = find_container(cm, config->id);
     if (!info || !info->saved_config) {
-        ERROR_LOG("Container not found or saved_config is NULL: info=%p, saved_config=%p", 
+        LOG_ERROR("Container not found or saved_config is NULL: info=%p, saved_config=%p", 
                   (void*)info, info ? (void*)info->saved_config : (void*)nullptr);
         container_manager_destroy(cm, config->id);
         return -1;
     }
-    DEBUG_LOG("Found container, saved_config=%p", (void*)info->saved_config);
-    DEBUG_LOG("saved_config->command=%p, saved_config->command_argc=%d", 
+    LOG_DEBUG("Found container, saved_config=%p", (void*)info->saved_config);
+    LOG_DEBUG("saved_config->command=%p, saved_config->command_argc=%d", 
               (void*)info->saved_config->command, info->saved_config->command_argc);
     if (!info->saved_config->command) {
-        ERROR_LOG("saved_config->command is NULL!");
+        LOG_ERROR("saved_config->command is NULL!");
         container_manager_destroy(cm, config->id);
         return -1;
     }
     for (int i = 0; i < info->saved_config->command_argc; i++) {
-        DEBUG_LOG("saved_config->command[%d] = %p (%s)", i, 
+        LOG_DEBUG("saved_config->command[%d] = %p (%s)", i, 
                   (void*)info->saved_config->command[i],
                   info->saved_config->command[i] ? info->saved_config->command[i] : "NULL");
     }
-    struct cgroup_callback_data {
-        resource_manager_t *rm;
-        const char *container_id;
-    };
-    cgroup_callback_data callback_data = {
-        .rm = cm->rm,
-        .container_id = config->id
-    };
-    auto add_to_cgroup = [](pid_t pid, void *user_data) -> void {
-        cgroup_callback_data *data = static_cast<cgroup_callback_data*>(user_data);
-        resource_manager_add_process(data->rm, data->container_id, pid);
-    };
-    DEBUG_LOG("Calling namespace_create_container_with_cgroup");
-    pid_t pid = namespace_create_container_with_cgroup(&info->saved_config->ns_config,
-                                                      info->saved_config->command,
-                                                      info->saved_config->command_argc,
-                                                      add_to_cgroup,
-                                                      &callback_data);
-    DEBUG_LOG("namespace_create_container_with_cgroup returned pid=%d", pid);
+    LOG_DEBUG("Spawning container %s", config->id);
+    namespace_fds_t joined;
+    pid_t pid = spawn_container(cm, config->id, info->saved_config, stdio_fds, &joined, &trace);
+    LOG_DEBUG("spawn_container returned pid=%d", pid);
     if (pid == -1) {
-        ERROR_LOG("namespace_create_container_with_cgroup failed");
+        LOG_ERROR("spawn_container failed");
         container_manager_destroy(cm, config->id);
         return -1;
     }
     if (info) {
-        info->pid = pid;
-        info->state = CONTAINER_RUNNING;
-        info->started_at = time(nullptr);
+        mark_started(cm, info, pid, -1, &joined, &trace);
+        journal_state(cm, info, STATE_RECORD_UPSERT);
     }
-    save_state(cm);
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,236 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <csignal>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <deque>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
+#include "../include/container_pool.hpp"
+#include "../include/logger.hpp"
+using namespace std;
+#define POOL_CGROUP_ID_MAX 64
+#define POOL_RETRY_DELAY_MS 1000
+struct pool_entry {
+    pid_t pid;
+    int channel_fd;
+    char cgroup_id[POOL_CGROUP_ID_MAX];
+};
+struct pool_profile {
+    namespace_config_t ns_config;
+    resource_limits_t limits;
+    deque<pool_entry> idle;
+    bool refilling;
+};
+struct container_pool {
+    resource_manager_t *rm;
+    int low_watermark;
+    int high_watermark;
+    vector<pool_profile*> profiles;
+    unsigned long next_seq;
+    unsigned long claims;
+    unsigned long misses;
+    bool shutdown;
+    mutex lock;
+    condition_variable cond;
+    thread worker;
+};
+static bool same_profile(const pool_profile *profile, const namespace_config_t *ns_config,
+                         const resource_limits_t *limits) {
+    return profile->ns_config.flags == ns_config->flags &&
+           profile->limits.cpu.shares == limits->cpu.shares &&
+           profile->limits.cpu.quota_us == limits->cpu.quota_us &&
+           profile->limits.cpu.period_us == limits->cpu.period_us &&
+           profile->limits.memory.limit_bytes == limits->memory.limit_bytes &&
+           profile->limits.memory.swap_limit_bytes == limits->memory.swap_limit_bytes;
+}
+static pool_profile *find_profile(container_pool_t *pool, const namespace_config_t *ns_config,
+                                  const resource_limits_t *limits) {
+    for (size_t i = 0; i < pool->profiles.size(); i++) {
+        if (same_profile(pool->profiles[i], ns_config, limits)) {
+            return pool->profiles[i];
+        }
+    }
+    return nullptr;
+}
+static void discard_entry(resource_manager_t *rm, pool_entry *entry, const char *cgroup_id) {
+    close(entry->channel_fd);
+    kill(entry->pid, SIGKILL);
+    while (waitpid(entry->pid, nullptr, 0) == -1 && errno == EINTR) {
+    }
+    resource_manager_destroy_cgroup(rm, cgroup_id);
+}
+static int spawn_entry(container_pool_t *pool, const namespace_config_t *ns_config,
+                       const resource_limits_t *limits, unsigned long seq, pool_entry *entry) {
+    snprintf(entry->cgroup_id, sizeof(entry->cgroup_id), "pool.%d.%lu", (int)getpid(), seq);
+    if (resource_manager_create_cgroup(pool->rm, entry->cgroup_id, limits) != 0) {
+        return -1;
+    }
+    entry->pid = namespace_create_parked(ns_config, &entry->channel_fd);
+    if (entry->pid == -1) {
+        resource_manager_destroy_cgroup(pool->rm, entry->cgroup_id);
+        return -1;
+    }
+    if (resource_manager_add_process(pool->rm, entry->cgroup_id, entry->pid) != 0) {
+        discard_entry(pool->rm, entry, entry->cgroup_id);
+        return -1;
+    }
+    return 0;
+}
+static pool_profile *next_to_refill(container_pool_t *pool) {
+    for (size_t i = 0; i < pool->profiles.size(); i++) {
+        pool_profile *profile = pool->profiles[i];
+        int idle = (int)profile->idle.size();
+        if (idle < pool->low_watermark) {
+            profile->refilling = true;
+        } else if (idle >= pool->high_watermark) {
+            profile->refilling = false;
+        }
+        if (profile->refilling) {
+            return profile;
+        }
+    }
+    return nullptr;
+}
+static void refill_loop(container_pool_t *pool) {
+    unique_lock<mutex> guard(pool->lock);
+    while (!pool->shutdown) {
+        pool_profile *profile = next_to_refill(pool);
+        if (!profile) {
+            pool->cond.wait(guard);
+            continue;
+        }
+        namespace_config_t ns_config = profile->ns_config;
+        resource_limits_t limits = profile->limits;
+        unsigned long seq = pool->next_seq++;
+        guard.unlock();
+        pool_entry entry;
+        int ret = spawn_entry(pool, &ns_config, &limits, seq, &entry);
+        guard.lock();
+        if (ret != 0) {
+            LOG_WARN("failed to park a pooled container, retrying in %dms", POOL_RETRY_DELAY_MS);
+            pool->cond.wait_for(guard, chrono::milliseconds(POOL_RETRY_DELAY_MS));
+            continue;
+        }
+        if (pool->shutdown) {
+            guard.unlock();
+            discard_entry(pool->rm, &entry, entry.cgroup_id);
+            guard.lock();
+            break;
+        }
+        profile->idle.push_back(entry);
+        LOG_DEBUG("parked container pid=%d cgroup=%s idle=%zu", entry.pid, entry.cgroup_id,
+                  profile->idle.size());
+    }
+}
+container_pool_t *container_pool_create(resource_manager_t *rm, int low_watermark, int high_watermark) {
+    if (!rm) return nullptr;
+    if (high_watermark <= 0) {
+        high_watermark = CONTAINER_POOL_DEFAULT_HIGH;
+    }
+    if (low_watermark < 0 || low_watermark > high_watermark) {
+        low_watermark = high_watermark < CONTAINER_POOL_DEFAULT_LOW ? high_watermark : CONTAINER_POOL_DEFAULT_LOW;
+    }
+    container_pool_t *pool = new container_pool();
+    pool->rm = rm;
+    pool->low_watermark = low_watermark;
+    pool->high_watermark = high_watermark;
+    pool->next_seq = 0;
+    pool->claims = 0;
+    pool->misses = 0;
+    pool->shutdown = false;
+    pool->worker = thread(refill_loop, pool);
+    return pool;
+}
+void container_pool_destroy(container_pool_t *pool) {
+    if (!pool) return;
+    {
+        lock_guard<mutex> guard(pool->lock);
+        pool->shutdown = true;
+        pool->cond.notify_all();
+    }
+    if (pool->worker.joinable()) {
+        pool->worker.join();
+    }
+    for (size_t i = 0; i < pool->profiles.size(); i++) {
+        deque<pool_entry> &idle = pool->profiles[i]->idle;
+        for (size_t j = 0; j < idle.size(); j++) {
+            close(idle[j].channel_fd);
+            kill(idle[j].pid, SIGKILL);
+        }
+        for (size_t j = 0; j < idle.size(); j++) {
+            while (waitpid(idle[j].pid, nullptr, 0) == -1 && errno == EINTR) {
+            }
+            resource_manager_destroy_cgroup(pool->rm, idle[j].cgroup_id);
+        }
+        delete pool->profiles[i];
+    }
+    delete pool;
+}
+int container_pool_add_profile(container_pool_t *pool, const namespace_config_t *ns_config,
+                               const resource_limits_t *limits) {
+    if (!pool || !ns_config || !limits) return -1;
+    lock_guard<mutex> guard(pool->lock);
+    if (find_profile(pool, ns_config, limits)) {
+        return 0;
+    }
+    pool_profile *profile = new pool_profile();
+    profile->ns_config = *ns_config;
+    profile->limits = *limits;
+    profile->refilling = true;
+    pool->profiles.push_back(profile);
+    pool->cond.notify_all();
+    return 0;
+}
+pid_t container_pool_claim(container_pool_t *pool, const namespace_config_t *ns_config,
+                           const resource_limits_t *limits, const char *container_id,
+                           char **command, const int *stdio_fds) {
+    if (!pool || !ns_config || !limits || !container_id || !command) return -1;
+    while (true) {
+        pool_entry entry;
+        {
+            lock_guard<mutex> guard(pool->lock);
+            pool_profile *profile = find_profile(pool, ns_config, limits);
+            if (!profile || profile->idle.empty()) {
+                pool->misses++;
+                return -1;
+            }
+            entry = profile->idle.front();
+            profile->idle.pop_front();
+            pool->cond.notify_all();
+        }
+        if (resource_manager_rename_cgroup(pool->rm, entry.cgroup_id, container_id) != 0) {
+            discard_entry(pool->rm, &entry, entry.cgroup_id);
+            continue;
+        }
+        if (namespace_release_parked(entry.channel_fd, command, stdio_fds) != 0) {
+            bool too_big = errno == E2BIG;
+            discard_entry(pool->rm, &entry, container_id);
+            if (too_big) {
+                return -1;
+            }
+            LOG_WARN("parked container pid=%d is gone, discarding it", entry.pid);
+            continue;
+        }
+        close(entry.channel_fd);
+        lock_guard<mutex> guard(pool->lock);
+        pool->claims++;
+        return entry.pid;
+    }
+}
+void container_pool_get_stats(container_pool_t *pool, container_pool_stats_t *stats) {
+    if (!pool || !stats) return;
+    lock_guard<mutex> guard(pool->lock);
+    stats->profiles = (int)pool->profiles.size();
+    stats->parked = 0;
+    for (size_t i = 0; i < pool->profiles.size(); i++) {
+        stats->parked += (int)pool->profiles[i]->idle.size();
+    }
+    stats->claims = pool->claims;
+    stats->misses = pool->misses;
+}
@@ -0,0 +1,312 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include "../include/control_protocol.hpp"
+using namespace std;
+void control_buffer_init(control_buffer_t *buf) {
+    if (!buf) return;
+    buf->data = nullptr;
+    buf->size = 0;
+    buf->capacity = 0;
+    buf->offset = 0;
+    buf->failed = 0;
+}
+void control_buffer_reset(control_buffer_t *buf) {
+    if (!buf) return;
+    buf->size = 0;
+    buf->offset = 0;
+    buf->failed = 0;
+}
+void control_buffer_free(control_buffer_t *buf) {
+    if (!buf) return;
+    free(buf->data);
+    control_buffer_init(buf);
+}
+static int reserve(control_buffer_t *buf, uint32_t extra) {
+    if (buf->failed) return -1;
+    if ((uint64_t)buf->size + extra > CONTROL_MAX_PAYLOAD) {
+        buf->failed = 1;
+        return -1;
+    }
+    if (buf->size + extra <= buf->capacity) return 0;
+    uint32_t capacity = buf->capacity ? buf->capacity : 256;
+    while (capacity < buf->size + extra) {
+        capacity *= 2;
+    }
+    char *data = static_cast<char*>(realloc(buf->data, capacity));
+    if (!data) {
+        buf->failed = 1;
+        return -1;
+    }
+    buf->data = data;
+    buf->capacity = capacity;
+    return 0;
+}
+static void put_bytes(control_buffer_t *buf, const void *bytes, uint32_t len) {
+    if (reserve(buf, len) != 0) return;
+    memcpy(buf->data + buf->size, bytes, len);
+    buf->size += len;
+}
+void control_put_u32(control_buffer_t *buf, uint32_t value) {
+    put_bytes(buf, &value, sizeof(value));
+}
+void control_put_u64(control_buffer_t *buf, uint64_t value) {
+    put_bytes(buf, &value, sizeof(value));
+}
+void control_put_string(control_buffer_t *buf, const char *str) {
+    if (!str) str = "";
+    uint32_t len = (uint32_t)strlen(str) + 1;
+    control_put_u32(buf, len);
+    put_bytes(buf, str, len);
+}
+static const char *take(control_buffer_t *buf, uint32_t len) {
+    if (buf->failed || buf->offset + (uint64_t)len > buf->size) {
+        buf->failed = 1;
+        return nullptr;
+    }
+    const char *p = buf->data + buf->offset;
+    buf->offset += len;
+    return p;
+}
+uint32_t control_get_u32(control_buffer_t *buf) {
+    uint32_t value = 0;
+    const char *p = take(buf, sizeof(value));
+    if (p) memcpy(&value, p, sizeof(value));
+    return value;
+}
+uint64_t control_get_u64(control_buffer_t *buf) {
+    uint64_t value = 0;
+    const char *p = take(buf, sizeof(value));
+    if (p) memcpy(&value, p, sizeof(value));
+    return value;
+}
+const char *control_get_string(control_buffer_t *buf) {
+    uint32_t len = control_get_u32(buf);
+    const char *p = len > 0 ? take(buf, len) : nullptr;
+    if (!p || p[len - 1] != '\0') {
+        buf->failed = 1;
+        return "";
+    }
+    return p;
+}
+static int write_all(int fd, const char *data, size_t len) {
+    while (len > 0) {
+        ssize_t n = send(fd, data, len, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+static int read_all(int fd, char *data, size_t len) {
+    while (len > 0) {
+        ssize_t n = recv(fd, data, len, 0);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if (n == 0) {
+            errno = ECONNRESET;
+            return -1;
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+int control_send(int fd, uint16_t op, int32_t status, const control_buffer_t *payload,
+                 const int *fds, int fd_count) {
+    if (payload && payload->failed) {
+        errno = EMSGSIZE;
+        return -1;
+    }
+    control_header_t header;
+    header.magic = CONTROL_MAGIC;
+    header.version = CONTROL_VERSION;
+    header.op = op;
+    header.status = status;
+    header.length = payload ? payload->size : 0;
+    struct iovec iov[2];
+    iov[0].iov_base = &header;
+    iov[0].iov_len = sizeof(header);
+    iov[1].iov_base = payload ? payload->data : nullptr;
+    iov[1].iov_len = header.length;
+    char control[CMSG_SPACE(sizeof(int) * CONTROL_MAX_FDS)];
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = header.length > 0 ? 2 : 1;
+    if (fds && fd_count > 0 && fd_count <= CONTROL_MAX_FDS) {
+        memset(control, 0, sizeof(control));
+        msg.msg_control = control;
+        msg.msg_controllen = CMSG_SPACE(sizeof(int) * fd_count);
+        struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int) * fd_count);
+        memcpy(CMSG_DATA(cmsg), fds, sizeof(int) * fd_count);
+    }
+    ssize_t sent;
+    do {
+        sent = sendmsg(fd, &msg, MSG_NOSIGNAL);
+    } while (sent < 0 && errno == EINTR);
+    if (sent < 0) {
+        return -1;
+    }
+    size_t total = sizeof(header) + header.length;
+    if ((size_t)sent < total) {
+        size_t done = (size_t)sent;
+        if (done < sizeof(header)) {
+            if (write_all(fd, reinterpret_cast<char*>(&header) + done, sizeof(header) - done) != 0) {
+                return -1;
+            }
+            done = sizeof(header);
+        }
+        size_t body_done = done - sizeof(header);
+        return write_all(fd, payload->data + body_done, header.length - body_done);
+    }
+    return 0;
+}
+int control_recv(int fd, control_header_t *header, control_buffer_t *payload,
+                 int *fds, int *fd_count) {
+    if (fd_count) *fd_count = 0;
+    char control[CMSG_SPACE(sizeof(int) * CONTROL_MAX_FDS)];
+    struct iovec iov;
+    iov.iov_base = header;
+    iov.iov_len = sizeof(*header);
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    ssize_t n;
+    do {
+        n = recvmsg(fd, &msg, MSG_CMSG_CLOEXEC);
+    } while (n < 0 && errno == EINTR);
+    if (n <= 0) {
+        if (n == 0) errno = ECONNRESET;
+        return -1;
+    }
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) continue;
+        int count = (int)((cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int));
+        int received[CONTROL_MAX_FDS];
+        memcpy(received, CMSG_DATA(cmsg), sizeof(int) * (count < CONTROL_MAX_FDS ? count : CONTROL_MAX_FDS));
+        for (int i = 0; i < count && i < CONTROL_MAX_FDS; i++) {
+            if (fds && fd_count) {
+                fds[(*fd_count)++] = received[i];
+            } else {
+                close(received[i]);
+            }
+        }
+    }
+    if ((size_t)n < sizeof(*header) &&
+        read_all(fd, reinterpret_cast<char*>(header) + n, sizeof(*header) - n) != 0) {
+        return -1;
+    }
+    if (header->magic != CONTROL_MAGIC || header->version != CONTROL_VERSION ||
+        header->length > CONTROL_MAX_PAYLOAD) {
+        errno = EPROTO;
+        return -1;
+    }
+    control_buffer_reset(payload);
+    if (header->length > 0) {
+        if (reserve(payload, header->length) != 0) {
+            errno = ENOMEM;
+            return -1;
+        }
+        if (read_all(fd, payload->data, header->length) != 0) {
+            return -1;
+        }
+        payload->size = header->length;
+    }
+    return 0;
+}
+const char *control_socket_path(void) {
+    const char *path = getenv(CONTROL_ENV_SOCKET);
+    if (path && *path) {
+        return path;
+    }
+    struct stat st;
+    if (stat("/var/run/mini-container", &st) == 0 || mkdir("/var/run/mini-container", 0755) == 0) {
+        return CONTROL_SOCKET_PATH;
+    }
+    return CONTROL_SOCKET_PATH_FALLBACK;
+}
+static int fill_address(struct sockaddr_un *addr, const char *path) {
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr->sun_path)) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    strcpy(addr->sun_path, path);
+    return 0;
+}
+int control_connect(void) {
+    return control_connect_path(control_socket_path());
+}
+int control_connect_path(const char *path) {
+    struct sockaddr_un addr;
+    if (!path || fill_address(&addr, path) != 0) {
+        return -1;
+    }
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd == -1) {
+        return -1;
+    }
+    if (connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == -1) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+int control_listen(const char *path) {
+    struct sockaddr_un addr;
+    if (!path || fill_address(&addr, path) != 0) {
+        fprintf(stderr, "Error: invalid control socket path\n");
+        return -1;
+    }
+    int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (probe != -1) {
+        int live = connect(probe, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr));
+        close(probe);
+        if (live == 0) {
+            fprintf(stderr, "Error: a daemon is already listening on %s\n", path);
+            return -1;
+        }
+    }
+    unlink(path);
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd == -1) {
+        perror("socket failed");
+        return -1;
+    }
+    mode_t old_mask = umask(0077);
+    int bound = bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr));
+    umask(old_mask);
+    if (bound == -1) {
+        perror("bind control socket failed");
+        close(fd);
+        return -1;
+    }
+    if (listen(fd, 64) == -1) {
+        perror("listen control socket failed");
+        close(fd);
+        unlink(path);
+        return -1;
+    }
+    return fd;
+}
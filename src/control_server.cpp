@@ -0,0 +1,407 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <csignal>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <vector>
+#include <string>
+#include <set>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include "../include/control_server.hpp"
+#include "../include/logger.hpp"
+using namespace std;
+#define CONTROL_MAX_ARGS 4096
+#define CONTROL_MAX_BATCH 65536
+#define CONTROL_WAIT_SLICE_MS 1000
+struct control_server {
+    container_manager_t *cm;
+    int listen_fd;
+    string path;
+    bool stopping;
+    thread acceptor;
+    mutex lock;
+    condition_variable idle;
+    set<int> clients;
+};
+static void reply_error(control_buffer_t *reply, const char *message) {
+    control_buffer_reset(reply);
+    control_put_string(reply, message);
+}
+static void put_view(control_buffer_t *reply, const container_view_t *view) {
+    control_put_string(reply, view->id);
+    control_put_u32(reply, (uint32_t)view->pid);
+    control_put_u32(reply, (uint32_t)view->state);
+    control_put_u64(reply, (uint64_t)view->created_at);
+    control_put_u64(reply, (uint64_t)view->started_at);
+    control_put_u64(reply, (uint64_t)view->stopped_at);
+}
+static bool find_view(container_manager_t *cm, const char *container_id, container_view_t *out) {
+    uint64_t ticket;
+    const container_snapshot_t *snapshot = container_manager_snapshot_acquire(cm, &ticket);
+    bool found = false;
+    for (int i = 0; snapshot && i < snapshot->count; i++) {
+        if (strcmp(snapshot->containers[i].id, container_id) == 0) {
+            *out = snapshot->containers[i];
+            found = true;
+            break;
+        }
+    }
+    container_manager_snapshot_release(cm, ticket);
+    return found;
+}
+static int serve_run(container_manager_t *cm, control_buffer_t *request, const int *fds, int fd_count,
+                     control_buffer_t *reply) {
+    uint32_t flags = control_get_u32(request);
+    uint64_t memory_limit = control_get_u64(request);
+    uint32_t cpu_shares = control_get_u32(request);
+    const char *root = control_get_string(request);
+    const char *id = control_get_string(request);
+    uint32_t argc = control_get_u32(request);
+    if (request->failed || argc == 0 || argc > CONTROL_MAX_ARGS) {
+        reply_error(reply, "malformed run request");
+        return -1;
+    }
+    vector<char*> command(argc + 1, nullptr);
+    for (uint32_t i = 0; i < argc; i++) {
+        command[i] = const_cast<char*>(control_get_string(request));
+    }
+    const char *lower_dirs = (flags & CONTROL_RUN_OVERLAY) ? control_get_string(request) : nullptr;
+    if (request->failed) {
+        reply_error(reply, "malformed run request");
+        return -1;
+    }
+    container_config_t config;
+    memset(&config, 0, sizeof(config));
+    namespace_config_init(&config.ns_config);
+    resource_limits_init(&config.res_limits);
+    fs_config_init(&config.fs_config);
+    config.res_limits.memory.limit_bytes = (unsigned long)memory_limit;
+    config.res_limits.cpu.shares = (int)cpu_shares;
+    if (flags & CONTROL_RUN_NET) {
+        config.ns_config.flags |= NS_NET;
+    }
+    if (flags & CONTROL_RUN_USERNS) {
+        config.ns_config.flags |= NS_USER;
+    }
+    if (flags & CONTROL_RUN_BIND_RO) {
+        config.fs_config.method = FS_BIND_RO;
+    }
+    if (flags & CONTROL_RUN_OVERLAY) {
+        config.fs_config.method = FS_OVERLAY;
+        config.fs_config.lower_dirs = const_cast<char*>(lower_dirs);
+    }
+    if (flags & CONTROL_RUN_MINIMAL) {
+        config.fs_config.create_minimal_fs = 1;
+        config.fs_config.enter_root = 1;
+    }
+    config.fs_config.root_path = const_cast<char*>(*root ? root : "/");
+    config.id = *id ? strdup(id) : nullptr;
+    config.command = command.data();
+    config.command_argc = (int)argc;
+    bool attach = (flags & CONTROL_RUN_ATTACH_STDIO) && fd_count == 3;
+    int ret = container_manager_run_attached(cm, &config, attach ? fds : nullptr);
+    if (ret != 0) {
+        free(config.id);
+        reply_error(reply, "failed to run container");
+        return -1;
+    }
+    container_view_t view;
+    memset(&view, 0, sizeof(view));
+    find_view(cm, config.id, &view);
+    control_put_string(reply, config.id);
+    control_put_u32(reply, (uint32_t)view.pid);
+    free(config.id);
+    return 0;
+}
+static int serve_batch(container_manager_t *cm, uint16_t op, control_buffer_t *request, control_buffer_t *reply) {
+    uint32_t timeout_ms = control_get_u32(request);
+    uint32_t count = control_get_u32(request);
+    if (request->failed || count > CONTROL_MAX_BATCH) {
+        reply_error(reply, "malformed batch request");
+        return -1;
+    }
+    vector<string> owned;
+    vector<const char*> ids;
+    for (uint32_t i = 0; i < count; i++) {
+        ids.push_back(control_get_string(request));
+    }
+    if (request->failed) {
+        reply_error(reply, "malformed batch request");
+        return -1;
+    }
+    if (op == CONTROL_OP_STOP && count == 0) {
+        uint64_t ticket;
+        const container_snapshot_t *snapshot = container_manager_snapshot_acquire(cm, &ticket);
+        for (int i = 0; snapshot && i < snapshot->count; i++) {
+            if (snapshot->containers[i].state == CONTAINER_RUNNING ||
+                snapshot->containers[i].state == CONTAINER_PAUSED) {
+                owned.push_back(snapshot->containers[i].id);
+            }
+        }
+        container_manager_snapshot_release(cm, ticket);
+        for (size_t i = 0; i < owned.size(); i++) {
+            ids.push_back(owned[i].c_str());
+        }
+    }
+    vector<int> results(ids.size(), 0);
+    int failed = 0;
+    if (!ids.empty()) {
+        if (op == CONTROL_OP_START) {
+            failed = container_manager_start_many(cm, ids.data(), (int)ids.size(), results.data(), nullptr, nullptr);
+        } else if (op == CONTROL_OP_STOP) {
+            failed = container_manager_stop_many(cm, ids.data(), (int)ids.size(), timeout_ms > 0 ? (int)timeout_ms : -1,
+                                                 results.data(), nullptr, nullptr);
+        } else if (op == CONTROL_OP_PAUSE || op == CONTROL_OP_RESUME) {
+            for (size_t i = 0; i < ids.size(); i++) {
+                results[i] = op == CONTROL_OP_PAUSE ? container_manager_pause(cm, ids[i])
+                                                    : container_manager_resume(cm, ids[i]);
+                if (results[i] != 0) failed++;
+            }
+        } else {
+            failed = container_manager_destroy_many(cm, ids.data(), (int)ids.size(), results.data(), nullptr, nullptr);
+        }
+    }
+    if (failed < 0) {
+        reply_error(reply, "invalid batch request");
+        return -1;
+    }
+    control_put_u32(reply, (uint32_t)ids.size());
+    for (size_t i = 0; i < ids.size(); i++) {
+        control_put_string(reply, ids[i]);
+        control_put_u32(reply, (uint32_t)results[i]);
+    }
+    return failed;
+}
+static int serve_list(container_manager_t *cm, control_buffer_t *reply) {
+    uint64_t ticket;
+    const container_snapshot_t *snapshot = container_manager_snapshot_acquire(cm, &ticket);
+    uint32_t count = 0;
+    for (int i = 0; snapshot && i < snapshot->count; i++) {
+        if (snapshot->containers[i].state != CONTAINER_DESTROYED) {
+            count++;
+        }
+    }
+    control_put_u32(reply, count);
+    for (int i = 0; snapshot && i < snapshot->count; i++) {
+        if (snapshot->containers[i].state != CONTAINER_DESTROYED) {
+            put_view(reply, &snapshot->containers[i]);
+        }
+    }
+    container_manager_snapshot_release(cm, ticket);
+    return 0;
+}
+static int serve_info(container_manager_t *cm, control_buffer_t *request, control_buffer_t *reply) {
+    const char *container_id = control_get_string(request);
+    container_view_t view;
+    if (request->failed || !find_view(cm, container_id, &view)) {
+        reply_error(reply, "container not found");
+        return -1;
+    }
+    unsigned long cpu_usage = 0, memory_usage = 0;
+    if (view.state == CONTAINER_RUNNING || view.state == CONTAINER_PAUSED) {
+        resource_manager_get_stats(cm->rm, view.id, &cpu_usage, &memory_usage);
+    }
+    put_view(reply, &view);
+    control_put_u64(reply, cpu_usage);
+    control_put_u64(reply, memory_usage);
+    control_put_u32(reply, (uint32_t)view.start_trace.pooled);
+    for (int i = 0; i < START_PHASE_COUNT; i++) {
+        control_put_u64(reply, view.start_trace.phase_ns[i]);
+    }
+    unsigned long long upper_usage = 0;
+    bool overlay = view.fs_method == FS_OVERLAY && fs_overlay_usage(view.id, &upper_usage) == 0;
+    control_put_u32(reply, overlay ? 1 : 0);
+    control_put_u64(reply, upper_usage);
+    return 0;
+}
+static int serve_wait(container_manager_t *cm, control_buffer_t *request, control_buffer_t *reply) {
+    const char *container_id = control_get_string(request);
+    int timeout_ms = (int)control_get_u32(request);
+    if (request->failed) {
+        reply_error(reply, "malformed wait request");
+        return -1;
+    }
+    if (timeout_ms < 0 || timeout_ms > CONTROL_WAIT_SLICE_MS) {
+        timeout_ms = CONTROL_WAIT_SLICE_MS;
+    }
+    int status = 0;
+    int ret = container_manager_wait(cm, container_id, timeout_ms, &status);
+    if (ret < 0) {
+        reply_error(reply, "container not found");
+        return -1;
+    }
+    control_put_u32(reply, (uint32_t)status);
+    return ret;
+}
+static int serve_exec(container_manager_t *cm, int client_fd, control_buffer_t *request,
+                      const int *fds, int fd_count, control_buffer_t *reply) {
+    const char *container_id = control_get_string(request);
+    uint32_t argc = control_get_u32(request);
+    if (request->failed || argc == 0 || argc > CONTROL_MAX_ARGS) {
+        reply_error(reply, "malformed exec request");
+        return -1;
+    }
+    vector<char*> command(argc + 1, nullptr);
+    for (uint32_t i = 0; i < argc; i++) {
+        command[i] = const_cast<char*>(control_get_string(request));
+    }
+    if (request->failed) {
+        reply_error(reply, "malformed exec request");
+        return -1;
+    }
+    int pidfd = -1;
+    pid_t pid = container_manager_exec_spawn(cm, container_id, command.data(), fd_count == 3 ? fds : nullptr, &pidfd);
+    if (pid == -1) {
+        reply_error(reply, "failed to exec in container");
+        return -1;
+    }
+    struct pollfd watch[2];
+    watch[0].fd = pidfd;
+    watch[0].events = POLLIN;
+    watch[1].fd = client_fd;
+    watch[1].events = POLLIN;
+    while (true) {
+        watch[0].revents = watch[1].revents = 0;
+        if (poll(watch, 2, -1) == -1 && errno != EINTR) {
+            break;
+        }
+        if (watch[0].revents) {
+            break;
+        }
+        if (watch[1].revents) {
+            syscall(SYS_pidfd_send_signal, pidfd, SIGKILL, nullptr, 0);
+            break;
+        }
+    }
+    int status = 0;
+    while (waitpid(pid, &status, 0) == -1 && errno == EINTR) {
+    }
+    close(pidfd);
+    control_put_u32(reply, (uint32_t)status);
+    return 0;
+}
+static int dispatch(container_manager_t *cm, int client_fd, uint16_t op, control_buffer_t *request,
+                    const int *fds, int fd_count, control_buffer_t *reply) {
+    switch (op) {
+    case CONTROL_OP_PING:
+        control_put_u32(reply, (uint32_t)getpid());
+        return 0;
+    case CONTROL_OP_RUN:
+        return serve_run(cm, request, fds, fd_count, reply);
+    case CONTROL_OP_START:
+    case CONTROL_OP_STOP:
+    case CONTROL_OP_DESTROY:
+    case CONTROL_OP_PAUSE:
+    case CONTROL_OP_RESUME:
+        return serve_batch(cm, op, request, reply);
+    case CONTROL_OP_LIST:
+        return serve_list(cm, reply);
+    case CONTROL_OP_INFO:
+        return serve_info(cm, request, reply);
+    case CONTROL_OP_WAIT:
+        return serve_wait(cm, request, reply);
+    case CONTROL_OP_EXEC:
+        return serve_exec(cm, client_fd, request, fds, fd_count, reply);
+    default:
+        reply_error(reply, "unknown operation");
+        return -1;
+    }
+}
+static void serve_client(control_server_t *server, int fd) {
+    control_buffer_t request, reply;
+    control_buffer_init(&request);
+    control_buffer_init(&reply);
+    control_header_t header;
+    int fds[CONTROL_MAX_FDS];
+    int fd_count = 0;
+    while (control_recv(fd, &header, &request, fds, &fd_count) == 0) {
+        control_buffer_reset(&reply);
+        int status = dispatch(server->cm, fd, header.op, &request, fds, fd_count, &reply);
+        for (int i = 0; i < fd_count; i++) {
+            close(fds[i]);
+        }
+        fd_count = 0;
+        if (control_send(fd, header.op, status, &reply, nullptr, 0) != 0) {
+            break;
+        }
+    }
+    for (int i = 0; i < fd_count; i++) {
+        close(fds[i]);
+    }
+    control_buffer_free(&request);
+    control_buffer_free(&reply);
+    {
+        lock_guard<mutex> lock(server->lock);
+        server->clients.erase(fd);
+        if (server->clients.empty()) {
+            server->idle.notify_all();
+        }
+    }
+    close(fd);
+}
+static void accept_loop(control_server_t *server) {
+    while (true) {
+        int fd = accept4(server->listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd == -1) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            lock_guard<mutex> lock(server->lock);
+            if (!server->stopping) {
+                perror("accept control connection failed");
+            }
+            return;
+        }
+        lock_guard<mutex> lock(server->lock);
+        if (server->stopping) {
+            close(fd);
+            return;
+        }
+        server->clients.insert(fd);
+        thread(serve_client, server, fd).detach();
+    }
+}
+control_server_t *control_server_start(container_manager_t *cm, const char *path) {
+    if (!cm || !path) return nullptr;
+    int fd = control_listen(path);
+    if (fd == -1) {
+        return nullptr;
+    }
+    control_server_t *server = new control_server();
+    server->cm = cm;
+    server->listen_fd = fd;
+    server->path = path;
+    server->stopping = false;
+    server->acceptor = thread(accept_loop, server);
+    LOG_INFO("control server listening on %s", path);
+    return server;
+}
+void control_server_stop(control_server_t *server) {
+    if (!server) return;
+    {
+        lock_guard<mutex> lock(server->lock);
+        server->stopping = true;
+        shutdown(server->listen_fd, SHUT_RDWR);
+    }
+    int wake = control_connect_path(server->path.c_str());
+    if (wake != -1) {
+        close(wake);
+    }
+    if (server->acceptor.joinable()) {
+        server->acceptor.join();
+    }
+    close(server->listen_fd);
+    unlink(server->path.c_str());
+    unique_lock<mutex> lock(server->lock);
+    for (set<int>::iterator it = server->clients.begin(); it != server->clients.end(); ++it) {
+        shutdown(*it, SHUT_RDWR);
+    }
+    server->idle.wait(lock, [server] { return server->clients.empty(); });
+    lock.unlock();
+    delete server;
+}
@@ -0,0 +1,151 @@
+#include <iostream>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+#include <pthread.h>
+#include <vector>
+#include "../include/container_manager.hpp"
+#include "../include/control_server.hpp"
+#include "../include/web_server_simple.hpp"
+using namespace std;
+static container_manager_t cm;
+static void print_usage(const char *program_name) {
+    cout << "Usage: " << program_name << " [-s <socket>] [-w <port>] [-p <low>:<high>] [-l <MB>:<shares>]... [-n <count>] [-r <MB>] [-z]" << endl;
+    cout << "  -s <socket>       Control socket path (default: " << CONTROL_SOCKET_PATH << ")" << endl;
+    cout << "  -w <port>         Also serve the web monitor on <port>" << endl;
+    cout << "  -p <low>:<high>   Keep pre-started containers parked, refilling below <low> up to <high>" << endl;
+    cout << "  -l <MB>:<shares>  Add a pooled limit profile (default: the run defaults)" << endl;
+    cout << "  -n <count>        Keep <count> spare network/user namespaces (default: " << NS_POOL_DEFAULT_TARGET
+         << ", 0 disables)" << endl;
+    cout << "  -r <MB>           Disk budget of the rootfs template cache (default: "
+         << ROOTFS_CACHE_DEFAULT_BUDGET / (1024 * 1024) << ", 0 disables)" << endl;
+    cout << "  -z                Spawn runs with the default namespaces from a zygote" << endl;
+}
+static int parse_pair(const char *arg, int *first, int *second) {
+    char *end;
+    *first = (int)strtol(arg, &end, 10);
+    if (end == arg || *end != ':') {
+        return -1;
+    }
+    const char *rest = end + 1;
+    *second = (int)strtol(rest, &end, 10);
+    return (end == rest || *end != '\0') ? -1 : 0;
+}
+int main(int argc, char* argv[]) {
+    const char *socket_path = nullptr;
+    int web_port = 0;
+    int pool_low = -1, pool_high = 0;
+    int ns_pool_target = NS_POOL_DEFAULT_TARGET;
+    unsigned long long rootfs_budget = ROOTFS_CACHE_DEFAULT_BUDGET;
+    bool use_zygote = false;
+    vector<resource_limits_t> profiles;
+    int c;
+    while ((c = getopt(argc, argv, "hs:w:p:l:n:r:z")) != -1) {
+        switch (c) {
+        case 's':
+            socket_path = optarg;
+            break;
+        case 'w':
+            web_port = atoi(optarg);
+            break;
+        case 'p':
+            if (parse_pair(optarg, &pool_low, &pool_high) != 0 || pool_high <= 0) {
+                cerr << "Invalid pool watermarks: " << optarg << endl;
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'l': {
+            int memory_mb, shares;
+            if (parse_pair(optarg, &memory_mb, &shares) != 0) {
+                cerr << "Invalid pool profile: " << optarg << endl;
+                return EXIT_FAILURE;
+            }
+            resource_limits_t limits;
+            resource_limits_init(&limits);
+            limits.memory.limit_bytes = (unsigned long)memory_mb * 1024 * 1024;
+            limits.cpu.shares = shares;
+            profiles.push_back(limits);
+            break;
+        }
+        case 'n':
+            ns_pool_target = atoi(optarg);
+            break;
+        case 'r':
+            rootfs_budget = strtoull(optarg, nullptr, 10) * 1024 * 1024;
+            break;
+        case 'z':
+            use_zygote = true;
+            break;
+        default:
+            print_usage(argv[0]);
+            return c == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if (!socket_path) {
+        socket_path = control_socket_path();
+    }
+    if (getuid() != 0) {
+        cerr << "Warning: container operations typically require root privileges" << endl;
+    }
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+    signal(SIGPIPE, SIG_IGN);
+    if (container_manager_init(&cm, 10000) != 0) {
+        cerr << "Failed to initialize container manager" << endl;
+        return EXIT_FAILURE;
+    }
+    if (pool_high > 0 || !profiles.empty()) {
+        if (container_manager_enable_pool(&cm, pool_low, pool_high) != 0) {
+            cerr << "Failed to start container pool" << endl;
+            container_manager_cleanup(&cm);
+            return EXIT_FAILURE;
+        }
+        namespace_config_t ns_config;
+        namespace_config_init(&ns_config);
+        if (profiles.empty()) {
+            resource_limits_t limits;
+            resource_limits_init(&limits);
+            profiles.push_back(limits);
+        }
+        for (size_t i = 0; i < profiles.size(); i++) {
+            container_pool_add_profile(cm.pool, &ns_config, &profiles[i]);
+        }
+    }
+    if (ns_pool_target > 0 && container_manager_enable_ns_pool(&cm, ns_pool_target) != 0) {
+        cerr << "Warning: failed to start namespace pool" << endl;
+    }
+    if (rootfs_budget > 0 && container_manager_enable_rootfs_cache(&cm, rootfs_budget) != 0) {
+        cerr << "Warning: failed to open rootfs cache" << endl;
+    }
+    if (use_zygote && container_manager_enable_zygote(&cm) != 0) {
+        cerr << "Failed to start zygote" << endl;
+        container_manager_cleanup(&cm);
+        return EXIT_FAILURE;
+    }
+    control_server_t *server = control_server_start(&cm, socket_path);
+    if (!server) {
+        cerr << "Failed to start control server on " << socket_path << endl;
+        container_manager_cleanup(&cm);
+        return EXIT_FAILURE;
+    }
+    SimpleWebServer *web_server = nullptr;
+    if (web_port > 0) {
+        web_server = new SimpleWebServer(&cm, web_port);
+        web_server->start();
+    }
+    cout << "mini-containerd listening on " << socket_path << endl;
+    int sig = 0;
+    sigwait(&signals, &sig);
+    cout << "Received signal " << sig << ", shutting down" << endl;
+    control_server_stop(server);
+    if (web_server) {
+        web_server->stop();
+        delete web_server;
+    }
+    container_manager_cleanup(&cm);
+    return EXIT_SUCCESS;
+}
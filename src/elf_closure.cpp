@@ -0,0 +1,537 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <climits>
+#include <unistd.h>
+#include <fcntl.h>
+#include <glob.h>
+#include <elf.h>
+#include <endian.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include "../include/elf_closure.hpp"
+#include "../include/filesystem_manager.hpp"
+#include "../include/logger.hpp"
+using namespace std;
+#define ELF_CONF_MAX_DEPTH 8
+#define ELF_SCRIPT_HEADER_MAX 256
+struct file_key {
+    dev_t dev;
+    ino_t ino;
+    time_t mtime_sec;
+    long mtime_nsec;
+    off_t size;
+    bool operator==(const file_key &other) const {
+        return dev == other.dev && ino == other.ino && mtime_sec == other.mtime_sec &&
+               mtime_nsec == other.mtime_nsec && size == other.size;
+    }
+};
+struct file_key_hash {
+    size_t operator()(const file_key &key) const {
+        return hash<unsigned long long>()(((unsigned long long)key.dev << 40) ^ (unsigned long long)key.ino ^
+                                          ((unsigned long long)key.mtime_sec << 20) ^
+                                          (unsigned long long)key.mtime_nsec);
+    }
+};
+struct elf_object {
+    bool is_elf;
+    int elf_class;
+    int machine;
+    string interp;
+    vector<string> needed;
+    vector<string> rpath;
+    vector<string> runpath;
+};
+struct closure_member {
+    string path;
+    file_key key;
+};
+struct closure_entry {
+    vector<closure_member> members;
+};
+struct resolver {
+    int root_fd;
+    string host_root;
+    vector<string> system_dirs;
+    vector<closure_member> members;
+    unordered_set<string> seen;
+};
+static mutex cache_lock;
+static unordered_map<file_key, elf_object, file_key_hash> object_cache;
+static unordered_map<string, closure_entry> closure_cache;
+static unsigned long cache_hits;
+static unsigned long cache_misses;
+static file_key make_key(const struct stat *st) {
+    file_key key;
+    key.dev = st->st_dev;
+    key.ino = st->st_ino;
+    key.mtime_sec = st->st_mtim.tv_sec;
+    key.mtime_nsec = st->st_mtim.tv_nsec;
+    key.size = st->st_size;
+    return key;
+}
+static void split_path_list(const string &list, vector<string> *out) {
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t end = list.find(':', start);
+        if (end == string::npos) {
+            end = list.size();
+        }
+        if (end > start) {
+            out->push_back(list.substr(start, end - start));
+        }
+        start = end + 1;
+    }
+}
+static bool native_byte_order(unsigned char data) {
+#if __BYTE_ORDER == __LITTLE_ENDIAN
+    return data == ELFDATA2LSB;
+#else
+    return data == ELFDATA2MSB;
+#endif
+}
+template <typename Phdr>
+static bool vaddr_to_offset(const Phdr *ph, int count, unsigned long long vaddr, unsigned long long *offset) {
+    for (int i = 0; i < count; i++) {
+        if (ph[i].p_type == PT_LOAD && vaddr >= ph[i].p_vaddr && vaddr < ph[i].p_vaddr + ph[i].p_filesz) {
+            *offset = vaddr - ph[i].p_vaddr + ph[i].p_offset;
+            return true;
+        }
+    }
+    return false;
+}
+template <typename Ehdr, typename Phdr, typename Dyn>
+static bool parse_elf(const unsigned char *data, size_t size, elf_object *obj) {
+    if (size < sizeof(Ehdr)) {
+        return false;
+    }
+    const Ehdr *eh = reinterpret_cast<const Ehdr*>(data);
+    if (eh->e_phentsize != sizeof(Phdr) || eh->e_phoff > size ||
+        eh->e_phnum > (size - eh->e_phoff) / sizeof(Phdr) || eh->e_phoff % alignof(Phdr) != 0) {
+        return false;
+    }
+    const Phdr *ph = reinterpret_cast<const Phdr*>(data + eh->e_phoff);
+    const Phdr *dynamic = nullptr;
+    for (int i = 0; i < eh->e_phnum; i++) {
+        if (ph[i].p_offset > size || ph[i].p_filesz > size - ph[i].p_offset) {
+            continue;
+        }
+        if (ph[i].p_type == PT_INTERP) {
+            const char *interp = reinterpret_cast<const char*>(data + ph[i].p_offset);
+            obj->interp.assign(interp, strnlen(interp, ph[i].p_filesz));
+        } else if (ph[i].p_type == PT_DYNAMIC && ph[i].p_offset % alignof(Dyn) == 0) {
+            dynamic = &ph[i];
+        }
+    }
+    obj->is_elf = true;
+    obj->machine = eh->e_machine;
+    if (!dynamic) {
+        return true;
+    }
+    const Dyn *dyn = reinterpret_cast<const Dyn*>(data + dynamic->p_offset);
+    size_t dyn_count = dynamic->p_filesz / sizeof(Dyn);
+    unsigned long long strtab = 0, strsz = 0;
+    vector<unsigned long long> needed;
+    long long rpath = -1, runpath = -1;
+    for (size_t i = 0; i < dyn_count && dyn[i].d_tag != DT_NULL; i++) {
+        switch (dyn[i].d_tag) {
+        case DT_STRTAB:
+            strtab = dyn[i].d_un.d_ptr;
+            break;
+        case DT_STRSZ:
+            strsz = dyn[i].d_un.d_val;
+            break;
+        case DT_NEEDED:
+            needed.push_back(dyn[i].d_un.d_val);
+            break;
+        case DT_RPATH:
+            rpath = (long long)dyn[i].d_un.d_val;
+            break;
+        case DT_RUNPATH:
+            runpath = (long long)dyn[i].d_un.d_val;
+            break;
+        }
+    }
+    unsigned long long stroff;
+    if (!vaddr_to_offset(ph, eh->e_phnum, strtab, &stroff) || stroff >= size) {
+        return true;
+    }
+    if (strsz == 0 || strsz > size - stroff) {
+        strsz = size - stroff;
+    }
+    const char *strings = reinterpret_cast<const char*>(data + stroff);
+    auto string_at = [&](unsigned long long value) -> string {
+        if (value >= strsz) {
+            return string();
+        }
+        return string(strings + value, strnlen(strings + value, strsz - value));
+    };
+    for (size_t i = 0; i < needed.size(); i++) {
+        string name = string_at(needed[i]);
+        if (!name.empty()) {
+            obj->needed.push_back(name);
+        }
+    }
+    if (rpath >= 0) {
+        split_path_list(string_at(rpath), &obj->rpath);
+    }
+    if (runpath >= 0) {
+        split_path_list(string_at(runpath), &obj->runpath);
+    }
+    return true;
+}
+static void parse_script(const unsigned char *data, size_t size, elf_object *obj) {
+    size_t limit = size < ELF_SCRIPT_HEADER_MAX ? size : ELF_SCRIPT_HEADER_MAX;
+    size_t start = 2;
+    while (start < limit && (data[start] == ' ' || data[start] == '\t')) {
+        start++;
+    }
+    size_t end = start;
+    while (end < limit && data[end] != ' ' && data[end] != '\t' && data[end] != '\n' && data[end] != '\r') {
+        end++;
+    }
+    if (end > start && data[start] == '/') {
+        obj->interp.assign(reinterpret_cast<const char*>(data + start), end - start);
+    }
+}
+static void parse_object(int fd, size_t size, elf_object *obj) {
+    obj->is_elf = false;
+    obj->elf_class = ELFCLASSNONE;
+    obj->machine = EM_NONE;
+    if (size < 4) {
+        return;
+    }
+    void *map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED) {
+        perror("mmap ELF object failed");
+        return;
+    }
+    const unsigned char *data = static_cast<const unsigned char*>(map);
+    if (memcmp(data, ELFMAG, SELFMAG) == 0 && size > EI_DATA && native_byte_order(data[EI_DATA])) {
+        obj->elf_class = data[EI_CLASS];
+        if (obj->elf_class == ELFCLASS64) {
+            parse_elf<Elf64_Ehdr, Elf64_Phdr, Elf64_Dyn>(data, size, obj);
+        } else if (obj->elf_class == ELFCLASS32) {
+            parse_elf<Elf32_Ehdr, Elf32_Phdr, Elf32_Dyn>(data, size, obj);
+        }
+    } else if (data[0] == '#' && data[1] == '!') {
+        parse_script(data, size, obj);
+    }
+    munmap(map, size);
+}
+static const elf_object *load_object(resolver *r, const string &path, file_key *key) {
+    int fd = fs_open_in_root(r->root_fd, path.c_str(), O_RDONLY);
+    if (fd == -1) {
+        return nullptr;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == -1 || !S_ISREG(st.st_mode)) {
+        close(fd);
+        return nullptr;
+    }
+    *key = make_key(&st);
+    auto it = object_cache.find(*key);
+    if (it != object_cache.end()) {
+        close(fd);
+        return &it->second;
+    }
+    elf_object obj;
+    parse_object(fd, (size_t)st.st_size, &obj);
+    close(fd);
+    return &object_cache.emplace(*key, obj).first->second;
+}
+static string parent_dir(const string &path) {
+    size_t slash = path.rfind('/');
+    if (slash == string::npos || slash == 0) {
+        return "/";
+    }
+    return path.substr(0, slash);
+}
+static string real_origin(resolver *r, const string &path) {
+    int fd = fs_open_in_root(r->root_fd, path.c_str(), O_PATH);
+    if (fd == -1) {
+        return parent_dir(path);
+    }
+    char link[64], real[PATH_MAX], root[PATH_MAX];
+    snprintf(link, sizeof(link), "/proc/self/fd/%d", fd);
+    ssize_t len = readlink(link, real, sizeof(real) - 1);
+    close(fd);
+    if (len <= 0 || !realpath(r->host_root.c_str(), root)) {
+        return parent_dir(path);
+    }
+    real[len] = '\0';
+    size_t prefix = strcmp(root, "/") == 0 ? 0 : strlen(root);
+    if (strncmp(real, root, prefix) != 0 || (real[prefix] != '/' && real[prefix] != '\0')) {
+        return parent_dir(path);
+    }
+    return parent_dir(string(real + prefix));
+}
+static void expand_dirs(const vector<string> &dirs, const string &origin, vector<string> *out) {
+    for (size_t i = 0; i < dirs.size(); i++) {
+        string dir = dirs[i];
+        const char *tokens[] = { "${ORIGIN}", "$ORIGIN" };
+        for (int t = 0; t < 2; t++) {
+            size_t pos;
+            while ((pos = dir.find(tokens[t])) != string::npos) {
+                dir.replace(pos, strlen(tokens[t]), origin);
+            }
+        }
+        if (dir.empty() || dir[0] != '/' || dir.find('$') != string::npos) {
+            continue;
+        }
+        out->push_back(dir);
+    }
+}
+static void read_ld_so_conf(resolver *r, const string &path, int depth) {
+    if (depth > ELF_CONF_MAX_DEPTH) {
+        return;
+    }
+    int fd = fs_open_in_root(r->root_fd, path.c_str(), O_RDONLY);
+    if (fd == -1) {
+        return;
+    }
+    FILE *fp = fdopen(fd, "r");
+    if (!fp) {
+        close(fd);
+        return;
+    }
+    string prefix = r->host_root == "/" ? string() : r->host_root;
+    char *line = nullptr;
+    size_t capacity = 0;
+    while (getline(&line, &capacity, fp) != -1) {
+        char *hash = strchr(line, '#');
+        if (hash) {
+            *hash = '\0';
+        }
+        char *save = nullptr;
+        char *word = strtok_r(line, " \t\r\n", &save);
+        if (!word || strcmp(word, "hwcap") == 0) {
+            continue;
+        }
+        if (strcmp(word, "include") != 0) {
+            char *eq = strchr(word, '=');
+            if (eq) {
+                *eq = '\0';
+            }
+            if (word[0] == '/') {
+                r->system_dirs.push_back(word);
+            }
+            continue;
+        }
+        char *pattern;
+        while ((pattern = strtok_r(nullptr, " \t\r\n", &save)) != nullptr) {
+            string full = pattern[0] == '/' ? string(pattern) : parent_dir(path) + "/" + pattern;
+            glob_t matches;
+            if (glob((prefix + full).c_str(), 0, nullptr, &matches) == 0) {
+                for (size_t i = 0; i < matches.gl_pathc; i++) {
+                    read_ld_so_conf(r, string(matches.gl_pathv[i] + prefix.size()), depth + 1);
+                }
+            }
+            globfree(&matches);
+        }
+    }
+    free(line);
+    fclose(fp);
+}
+static void add_default_dirs(vector<string> *dirs, int elf_class) {
+    if (elf_class == ELFCLASS64) {
+        dirs->push_back("/lib64");
+        dirs->push_back("/usr/lib64");
+    }
+    dirs->push_back("/lib");
+    dirs->push_back("/usr/lib");
+}
+static bool resolve_library(resolver *r, const string &name, const elf_object *obj, const string &obj_path,
+                            const elf_object *exe, const string &exe_path, string *found, file_key *key) {
+    vector<string> dirs;
+    if (name.find('/') != string::npos) {
+        if (name[0] != '/') {
+            return false;
+        }
+        dirs.push_back(parent_dir(name));
+    } else {
+        if (obj->runpath.empty()) {
+            expand_dirs(obj->rpath, real_origin(r, obj_path), &dirs);
+            if (exe != obj && exe->runpath.empty()) {
+                expand_dirs(exe->rpath, real_origin(r, exe_path), &dirs);
+            }
+        }
+        expand_dirs(obj->runpath, real_origin(r, obj_path), &dirs);
+        dirs.insert(dirs.end(), r->system_dirs.begin(), r->system_dirs.end());
+        add_default_dirs(&dirs, obj->elf_class);
+    }
+    string base = name.substr(name.rfind('/') + 1);
+    for (size_t i = 0; i < dirs.size(); i++) {
+        string candidate = dirs[i] + "/" + base;
+        const elf_object *lib = load_object(r, candidate, key);
+        if (lib && lib->is_elf && lib->elf_class == obj->elf_class && lib->machine == obj->machine) {
+            *found = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+static void add_member(vector<closure_member> *members, unordered_set<string> *seen, const string &path,
+                       const file_key &key) {
+    if (seen->insert(path).second) {
+        closure_member member;
+        member.path = path;
+        member.key = key;
+        members->push_back(member);
+    }
+}
+static int resolve_binary(resolver *r, const string &binary, vector<closure_member> *members) {
+    unordered_set<string> seen;
+    deque<string> executables;
+    executables.push_back(binary);
+    while (!executables.empty()) {
+        string exe_path = executables.front();
+        executables.pop_front();
+        if (seen.count(exe_path)) {
+            continue;
+        }
+        file_key key;
+        const elf_object *exe = load_object(r, exe_path, &key);
+        if (!exe) {
+            fprintf(stderr, "Error: cannot open %s\n", exe_path.c_str());
+            return -1;
+        }
+        add_member(members, &seen, exe_path, key);
+        if (!exe->interp.empty()) {
+            executables.push_back(exe->interp);
+        }
+        if (!exe->is_elf) {
+            continue;
+        }
+        deque<pair<string, const elf_object*> > libraries;
+        libraries.push_back(make_pair(exe_path, exe));
+        while (!libraries.empty()) {
+            string obj_path = libraries.front().first;
+            const elf_object *obj = libraries.front().second;
+            libraries.pop_front();
+            for (size_t i = 0; i < obj->needed.size(); i++) {
+                string found;
+                if (!resolve_library(r, obj->needed[i], obj, obj_path, exe, exe_path, &found, &key)) {
+                    fprintf(stderr, "Warning: cannot resolve %s needed by %s\n", obj->needed[i].c_str(),
+                            obj_path.c_str());
+                    continue;
+                }
+                if (seen.count(found)) {
+                    continue;
+                }
+                add_member(members, &seen, found, key);
+                libraries.push_back(make_pair(found, &object_cache.find(key)->second));
+            }
+        }
+    }
+    return 0;
+}
+static bool closure_valid(resolver *r, const closure_entry &entry) {
+    for (size_t i = 0; i < entry.members.size(); i++) {
+        int fd = fs_open_in_root(r->root_fd, entry.members[i].path.c_str(), O_PATH);
+        if (fd == -1) {
+            return false;
+        }
+        struct stat st;
+        bool same = fstat(fd, &st) == 0 && make_key(&st) == entry.members[i].key;
+        close(fd);
+        if (!same) {
+            return false;
+        }
+    }
+    return true;
+}
+int elf_closure_resolve(const char *host_root, const char *const *binaries, int count, elf_closure_t *closure) {
+    if (!host_root || !closure || count < 0 || (count > 0 && !binaries)) {
+        fprintf(stderr, "Error: invalid ELF closure arguments\n");
+        return -1;
+    }
+    closure->paths = nullptr;
+    closure->count = 0;
+    resolver r;
+    r.host_root = host_root;
+    r.root_fd = open(host_root, O_PATH | O_DIRECTORY | O_CLOEXEC);
+    if (r.root_fd == -1) {
+        perror("open host root failed");
+        return -1;
+    }
+    lock_guard<mutex> guard(cache_lock);
+    if (object_cache.size() > ELF_CLOSURE_CACHE_MAX) {
+        object_cache.clear();
+        closure_cache.clear();
+    }
+    bool conf_loaded = false;
+    int result = 0;
+    for (int i = 0; i < count && result == 0; i++) {
+        string binary = binaries[i];
+        string cache_key = r.host_root + '\n' + binary;
+        auto it = closure_cache.find(cache_key);
+        if (it != closure_cache.end() && closure_valid(&r, it->second)) {
+            cache_hits++;
+        } else {
+            cache_misses++;
+            if (!conf_loaded) {
+                read_ld_so_conf(&r, "/etc/ld.so.conf", 0);
+                conf_loaded = true;
+            }
+            closure_entry entry;
+            if (resolve_binary(&r, binary, &entry.members) != 0) {
+                result = -1;
+                break;
+            }
+            closure_cache[cache_key] = entry;
+            it = closure_cache.find(cache_key);
+        }
+        for (size_t m = 0; m < it->second.members.size(); m++) {
+            add_member(&r.members, &r.seen, it->second.members[m].path, it->second.members[m].key);
+        }
+    }
+    close(r.root_fd);
+    if (result != 0) {
+        return -1;
+    }
+    closure->paths = static_cast<char**>(calloc(r.members.size() + 1, sizeof(char*)));
+    if (!closure->paths) {
+        perror("calloc failed");
+        return -1;
+    }
+    for (size_t i = 0; i < r.members.size(); i++) {
+        closure->paths[i] = strdup(r.members[i].path.c_str());
+        if (!closure->paths[i]) {
+            perror("strdup failed");
+            elf_closure_free(closure);
+            return -1;
+        }
+        closure->count++;
+    }
+    LOG_DEBUG("ELF closure of %d binaries has %d files", count, closure->count);
+    return 0;
+}
+void elf_closure_free(elf_closure_t *closure) {
+    if (!closure) return;
+    for (int i = 0; i < closure->count; i++) {
+        free(closure->paths[i]);
+    }
+    free(closure->paths);
+    closure->paths = nullptr;
+    closure->count = 0;
+}
+void elf_closure_get_stats(elf_closure_stats_t *stats) {
+    if (!stats) return;
+    lock_guard<mutex> guard(cache_lock);
+    stats->hits = cache_hits;
+    stats->misses = cache_misses;
+    stats->objects = object_cache.size();
+}
+void elf_closure_cache_clear(void) {
+    lock_guard<mutex> guard(cache_lock);
+    object_cache.clear();
+    closure_cache.clear();
+}
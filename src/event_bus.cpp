@@ -0,0 +1,169 @@
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <climits>
+#include <ctime>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <atomic>
+#include "../include/event_bus.hpp"
+using namespace std;
+#define EVENT_WORDS (sizeof(container_event_t) / sizeof(uint64_t))
+static_assert(sizeof(container_event_t) % sizeof(uint64_t) == 0, "event must be a whole number of words");
+struct event_slot {
+    atomic<uint64_t> seq;
+    atomic<uint64_t> words[EVENT_WORDS];
+};
+struct event_bus {
+    event_slot *slots;
+    uint64_t capacity;
+    uint64_t mask;
+    atomic<uint64_t> head;
+    atomic<uint32_t> published;
+    atomic<int> waiters;
+};
+static int64_t now_ns(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+static void futex_wait(atomic<uint32_t> *word, uint32_t expected, int64_t timeout_ns) {
+    struct timespec ts;
+    ts.tv_sec = timeout_ns / 1000000000LL;
+    ts.tv_nsec = timeout_ns % 1000000000LL;
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAIT_PRIVATE, expected,
+            timeout_ns < 0 ? nullptr : &ts, nullptr, 0);
+}
+static void futex_wake_all(atomic<uint32_t> *word) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+}
+event_bus_t *event_bus_create(unsigned int capacity) {
+    uint64_t size = 1;
+    while (size < (capacity ? capacity : EVENT_BUS_DEFAULT_CAPACITY)) {
+        size <<= 1;
+    }
+    event_bus_t *bus = new event_bus();
+    bus->slots = new event_slot[size];
+    for (uint64_t i = 0; i < size; i++) {
+        bus->slots[i].seq.store(0, memory_order_relaxed);
+    }
+    bus->capacity = size;
+    bus->mask = size - 1;
+    bus->head.store(0, memory_order_relaxed);
+    bus->published.store(0, memory_order_relaxed);
+    bus->waiters.store(0, memory_order_relaxed);
+    return bus;
+}
+void event_bus_destroy(event_bus_t *bus) {
+    if (!bus) return;
+    delete[] bus->slots;
+    delete bus;
+}
+void event_bus_publish(event_bus_t *bus, container_event_type_t type, const char *container_id,
+                       pid_t pid, int exit_code, int signal) {
+    if (!bus) return;
+    uint64_t pos = bus->head.fetch_add(1, memory_order_relaxed);
+    container_event_t event;
+    memset(&event, 0, sizeof(event));
+    event.seq = pos;
+    event.type = type;
+    event.pid = pid;
+    event.exit_code = exit_code;
+    event.signal = signal;
+    event.time_ns = now_ns(CLOCK_REALTIME);
+    if (container_id) {
+        strncpy(event.id, container_id, CONTAINER_EVENT_ID_MAX - 1);
+    }
+    uint64_t words[EVENT_WORDS];
+    memcpy(words, &event, sizeof(event));
+    event_slot *slot = &bus->slots[pos & bus->mask];
+    uint64_t previous = pos < bus->capacity ? 0 : 2 * (pos - bus->capacity) + 2;
+    while (slot->seq.load(memory_order_acquire) != previous) {
+        sched_yield();
+    }
+    slot->seq.store(2 * pos + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    for (size_t i = 0; i < EVENT_WORDS; i++) {
+        slot->words[i].store(words[i], memory_order_relaxed);
+    }
+    slot->seq.store(2 * pos + 2, memory_order_release);
+    bus->published.fetch_add(1, memory_order_seq_cst);
+    if (bus->waiters.load(memory_order_seq_cst) > 0) {
+        futex_wake_all(&bus->published);
+    }
+}
+void event_bus_subscribe(event_bus_t *bus, event_cursor_t *cursor) {
+    if (!bus || !cursor) return;
+    cursor->next = bus->head.load(memory_order_acquire);
+    cursor->dropped = 0;
+}
+int event_bus_poll(event_bus_t *bus, event_cursor_t *cursor, container_event_t *events, int max_events) {
+    if (!bus || !cursor || !events || max_events <= 0) return -1;
+    uint64_t head = bus->head.load(memory_order_acquire);
+    if (cursor->next > head) {
+        cursor->next = head;
+    }
+    int count = 0;
+    while (count < max_events && cursor->next < head) {
+        uint64_t pos = cursor->next;
+        if (head - pos > bus->capacity) {
+            cursor->dropped += head - bus->capacity - pos;
+            cursor->next = head - bus->capacity;
+            continue;
+        }
+        event_slot *slot = &bus->slots[pos & bus->mask];
+        uint64_t expected = 2 * pos + 2;
+        uint64_t before = slot->seq.load(memory_order_acquire);
+        if (before < expected) {
+            break;
+        }
+        uint64_t words[EVENT_WORDS];
+        for (size_t i = 0; i < EVENT_WORDS; i++) {
+            words[i] = slot->words[i].load(memory_order_relaxed);
+        }
+        atomic_thread_fence(memory_order_acquire);
+        uint64_t after = slot->seq.load(memory_order_relaxed);
+        cursor->next++;
+        if (before != expected || after != expected) {
+            cursor->dropped++;
+            continue;
+        }
+        memcpy(&events[count++], words, sizeof(container_event_t));
+    }
+    return count;
+}
+int event_bus_wait(event_bus_t *bus, event_cursor_t *cursor, container_event_t *events, int max_events,
+                   int timeout_ms) {
+    if (!bus || !cursor || !events || max_events <= 0) return -1;
+    int64_t deadline = timeout_ms < 0 ? -1 : now_ns(CLOCK_MONOTONIC) + (int64_t)timeout_ms * 1000000LL;
+    bus->waiters.fetch_add(1, memory_order_seq_cst);
+    int count;
+    while (true) {
+        uint32_t observed = bus->published.load(memory_order_seq_cst);
+        count = event_bus_poll(bus, cursor, events, max_events);
+        if (count != 0 || timeout_ms == 0) {
+            break;
+        }
+        int64_t remaining = -1;
+        if (deadline >= 0) {
+            remaining = deadline - now_ns(CLOCK_MONOTONIC);
+            if (remaining <= 0) {
+                break;
+            }
+        }
+        futex_wait(&bus->published, observed, remaining);
+    }
+    bus->waiters.fetch_sub(1, memory_order_seq_cst);
+    return count;
+}
+const char *container_event_name(int type) {
+    static const char *names[] = {
+        "unknown", "created", "started", "exited", "stopped", "destroyed", "oom", "paused", "resumed"
+    };
+    if (type < 0 || type > CONTAINER_EVENT_RESUMED) {
+        return names[0];
+    }
+    return names[type];
+}
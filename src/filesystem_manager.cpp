@@ -2,16 +2,28 @@
 #include <cstdlib>
 #include <cstring>
 #include <cerrno>
+#include <climits>
 #include <unistd.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/mount.h>
 #include <sys/sysmacros.h>
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <sys/syscall.h>
+#include <sys/statfs.h>
+#include <linux/fs.h>
+#include <linux/magic.h>
+#include <linux/openat2.h>
 #include <fcntl.h>
 #include <dirent.h>
 #include <libgen.h>
 #include <memory>
+#include <string>
+#include <vector>
 #include "../include/filesystem_manager.hpp"
+#include "../include/elf_closure.hpp"
+#include "../include/logger.hpp"
 using namespace std;
 static const char *essential_dirs[] = {
     "/bin",
@@ -45,7 +57,35 @@ static struct {
     {"/dev/console", S_IFCHR | 0600, makedev(5, 1)},
     {nullptr, 0, 0}
 };
-static int mkdir_p(const char *path) {
+static const char *essential_binaries[] = {
+    "/bin/sh",
+    "/bin/bash",
+    nullptr
+};
+static const char *bind_root_dirs[] = {
+    "/bin",
+    "/lib",
+    "/lib64",
+    "/usr",
+    nullptr
+};
+static const char *overlay_mount_points[] = {
+    "/proc",
+    "/sys",
+    "/dev",
+    "/tmp",
+    nullptr
+};
+static const char *bind_root_mount_points[] = {
+    "/proc",
+    "/sys",
+    "/dev",
+    "/tmp",
+    "/var",
+    "/etc",
+    nullptr
+};
+int fs_mkdir_p(const char *path) {
     if (!path) return -1;
     if (mkdir(path, 0755) == 0) {
         return 0;
@@ -54,7 +94,7 @@ static int mkdir_p(const char *path) {
         std::unique_ptr<char[]> path_copy(new char[strlen(path) + 1]);
         strcpy(path_copy.get(), path);
         char *parent = dirname(path_copy.get());
-        if (mkdir_p(parent) != 0) {
+        if (fs_mkdir_p(parent) != 0) {
             return -1;
         }
         return mkdir(path, 0755);
@@ -64,29 +104,143 @@ static int mkdir_p(const char *path) {
     }
     return -1;
 }
-static int copy_file(const char *src, const char *dst) {
-    int src_fd = open(src, O_RDONLY);
+static bool copy_range_unsupported(int err) {
+    return err == ENOSYS || err == EXDEV || err == EINVAL || err == EOPNOTSUPP || err == EBADF || err == ETXTBSY;
+}
+static int copy_buffered(int src_fd, int dst_fd, off_t offset, off_t end) {
+    char buffer[65536];
+    while (offset < end) {
+        size_t chunk = (size_t)(end - offset) < sizeof(buffer) ? (size_t)(end - offset) : sizeof(buffer);
+        ssize_t bytes_read = pread(src_fd, buffer, chunk, offset);
+        if (bytes_read < 0 && errno == EINTR) continue;
+        if (bytes_read <= 0) {
+            return bytes_read == 0 ? 0 : -1;
+        }
+        for (ssize_t done = 0; done < bytes_read;) {
+            ssize_t bytes_written = pwrite(dst_fd, buffer + done, bytes_read - done, offset + done);
+            if (bytes_written < 0 && errno == EINTR) continue;
+            if (bytes_written <= 0) {
+                return -1;
+            }
+            done += bytes_written;
+        }
+        offset += bytes_read;
+    }
+    return 0;
+}
+static int copy_segment(int src_fd, int dst_fd, off_t offset, off_t end, fs_copy_method_t *method) {
+    while (*method == FS_COPY_RANGE && offset < end) {
+        loff_t in = offset, out = offset;
+        ssize_t copied = copy_file_range(src_fd, &in, dst_fd, &out, end - offset, 0);
+        if (copied > 0) {
+            offset += copied;
+        } else if (copied == 0) {
+            return 0;
+        } else if (errno != EINTR) {
+            if (!copy_range_unsupported(errno)) return -1;
+            *method = FS_COPY_SENDFILE;
+        }
+    }
+    if (*method == FS_COPY_SENDFILE && offset < end && lseek(dst_fd, offset, SEEK_SET) == offset) {
+        while (offset < end) {
+            off_t in = offset;
+            ssize_t copied = sendfile(dst_fd, src_fd, &in, end - offset);
+            if (copied > 0) {
+                offset += copied;
+            } else if (copied == 0) {
+                return 0;
+            } else if (errno != EINTR) {
+                if (!copy_range_unsupported(errno)) return -1;
+                *method = FS_COPY_BUFFERED;
+                break;
+            }
+        }
+    }
+    if (offset < end) {
+        *method = FS_COPY_BUFFERED;
+        return copy_buffered(src_fd, dst_fd, offset, end);
+    }
+    return 0;
+}
+static int copy_data(int src_fd, int dst_fd, off_t size, fs_copy_method_t *method) {
+    if (ioctl(dst_fd, FICLONE, src_fd) == 0) {
+        *method = FS_COPY_CLONE;
+        return 0;
+    }
+    if (size == 0) {
+        *method = FS_COPY_BUFFERED;
+        return copy_buffered(src_fd, dst_fd, 0, LLONG_MAX);
+    }
+    *method = FS_COPY_RANGE;
+    off_t offset = 0;
+    while (offset < size) {
+        off_t data = lseek(src_fd, offset, SEEK_DATA);
+        if (data == -1) {
+            if (errno == ENXIO) break;
+            data = offset;
+        }
+        off_t hole = lseek(src_fd, data, SEEK_HOLE);
+        if (hole == -1 || hole > size) {
+            hole = size;
+        }
+        if (copy_segment(src_fd, dst_fd, data, hole, method) != 0) {
+            return -1;
+        }
+        offset = hole;
+    }
+    return ftruncate(dst_fd, size);
+}
+int fs_copy_file(const char *src, const char *dst, fs_copy_method_t *method) {
+    if (!src || !dst) {
+        fprintf(stderr, "Error: copy paths cannot be NULL\n");
+        return -1;
+    }
+    int src_fd = open(src, O_RDONLY | O_CLOEXEC);
     if (src_fd == -1) {
         return -1;
     }
-    int dst_fd = open(dst, O_WRONLY | O_CREAT | O_TRUNC, 0755);
+    struct stat st;
+    if (fstat(src_fd, &st) == -1) {
+        int saved = errno;
+        close(src_fd);
+        errno = saved;
+        return -1;
+    }
+    if (!S_ISREG(st.st_mode)) {
+        close(src_fd);
+        errno = EINVAL;
+        return -1;
+    }
+    int dst_fd = open(dst, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, st.st_mode & 07777);
     if (dst_fd == -1) {
         close(src_fd);
         return -1;
     }
-    char buffer[8192];
-    ssize_t bytes_read, bytes_written;
-    while ((bytes_read = read(src_fd, buffer, sizeof(buffer))) > 0) {
-        bytes_written = write(dst_fd, buffer, bytes_read);
-        if (bytes_written != bytes_read) {
-            close(src_fd);
-            close(dst_fd);
-            return -1;
-        }
+    fs_copy_method_t used = FS_COPY_BUFFERED;
+    int result = copy_data(src_fd, dst_fd, st.st_size, &used);
+    if (result == 0) {
+        result = fchmod(dst_fd, st.st_mode & 07777);
     }
+    int saved = errno;
     close(src_fd);
     close(dst_fd);
-    return (bytes_read == -1) ? -1 : 0;
+    if (method) {
+        *method = used;
+    }
+    errno = saved;
+    return result;
+}
+const char *fs_copy_method_name(fs_copy_method_t method) {
+    switch (method) {
+    case FS_COPY_CLONE:
+        return "ficlone";
+    case FS_COPY_RANGE:
+        return "copy_file_range";
+    case FS_COPY_SENDFILE:
+        return "sendfile";
+    default:
+        return "buffered";
+    }
 }
 void fs_config_init(fs_config_t *config) {
     if (!config) {
@@ -96,7 +250,10 @@ void fs_config_init(fs_config_t *config) {
     config->root_path = nullptr;
     config->method = FS_CHROOT;
     config->create_minimal_fs = 0;
-    fprintf(stderr, "[DEBUG] fs_config_init: initialized, root_path=%p\n", (void*)config->root_path);
+    config->enter_root = 0;
+    config->read_only_root = 0;
+    config->lower_dirs = nullptr;
+    LOG_DEBUG("fs_config_init: initialized, root_path=%p", (void*)config->root_path);
 }
 int fs_create_minimal_root(const char *root_path) {
     if (!root_path) {
@@ -106,7 +263,7 @@ int fs_create_minimal_root(const char *root_path) {
     for (int i = 0; essential_dirs[i] != nullptr; i++) {
         char path[PATH_MAX];
         snprintf(path, sizeof(path), "%s%s", root_path, essential_dirs[i]);
-        if (mkdir_p(path) != 0) {
+        if (fs_mkdir_p(path) != 0) {
             fprintf(stderr, "Failed to create directory: %s\n", path);
             return -1;
         }
@@ -170,27 +327,689 @@ int fs_mount_container_filesystems(const char *root_path) {
     }
     return 0;
 }
-int fs_populate_container_root(const char *root_path, const char *host_root) {
+static int bind_readonly(const char *source, const char *target) {
+    int fd = open_tree(AT_FDCWD, source, OPEN_TREE_CLONE | OPEN_TREE_CLOEXEC | AT_RECURSIVE);
+    if (fd >= 0) {
+        struct mount_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.attr_set = MOUNT_ATTR_RDONLY | MOUNT_ATTR_NOSUID | MOUNT_ATTR_NODEV;
+        int result = mount_setattr(fd, "", AT_EMPTY_PATH | AT_RECURSIVE, &attr, sizeof(attr));
+        if (result == 0) {
+            result = move_mount(fd, "", AT_FDCWD, target, MOVE_MOUNT_F_EMPTY_PATH);
+        }
+        close(fd);
+        if (result == 0) {
+            return 0;
+        }
+    }
+    if (mount(source, target, nullptr, MS_BIND | MS_REC, nullptr) == -1 ||
+        mount(nullptr, target, nullptr, MS_BIND | MS_REMOUNT | MS_RDONLY | MS_NOSUID | MS_NODEV, nullptr) == -1) {
+        perror("bind mount failed");
+        return -1;
+    }
+    return 0;
+}
+static int mirror_host_entry(const char *host_path, const char *path) {
+    struct stat st;
+    if (lstat(host_path, &st) == -1) {
+        return 0;
+    }
+    if (S_ISLNK(st.st_mode)) {
+        char target[PATH_MAX];
+        ssize_t length = readlink(host_path, target, sizeof(target) - 1);
+        if (length < 0) {
+            perror("readlink failed");
+            return -1;
+        }
+        target[length] = '\0';
+        if (symlink(target, path) == -1) {
+            perror("symlink failed");
+            return -1;
+        }
+        return 0;
+    }
+    if (!S_ISDIR(st.st_mode)) {
+        return 0;
+    }
+    if (mkdir(path, st.st_mode & 07777) == -1 && errno != EEXIST) {
+        perror("mkdir failed");
+        return -1;
+    }
+    return bind_readonly(host_path, path);
+}
+static int pivot_into(const char *root_path) {
+    if (chdir(root_path) == -1 || syscall(SYS_pivot_root, ".", ".") == -1 ||
+        umount2(".", MNT_DETACH) == -1 || chdir("/") == -1) {
+        perror("pivot_root failed");
+        return -1;
+    }
+    return 0;
+}
+int fs_enter_bind_root(const char *root_path) {
+    if (!root_path) {
+        fprintf(stderr, "Error: root path cannot be NULL\n");
+        return -1;
+    }
+    if (mount("tmpfs", root_path, "tmpfs", MS_NOSUID | MS_NODEV, "mode=0755") == -1) {
+        perror("mount root tmpfs failed");
+        return -1;
+    }
+    char path[PATH_MAX];
+    for (int i = 0; bind_root_mount_points[i] != nullptr; i++) {
+        snprintf(path, sizeof(path), "%s%s", root_path, bind_root_mount_points[i]);
+        if (mkdir(path, 0755) == -1 && errno != EEXIST) {
+            perror("mkdir failed");
+            return -1;
+        }
+    }
+    for (int i = 0; bind_root_dirs[i] != nullptr; i++) {
+        snprintf(path, sizeof(path), "%s%s", root_path, bind_root_dirs[i]);
+        if (mirror_host_entry(bind_root_dirs[i], path) != 0) {
+            fprintf(stderr, "Failed to bind %s\n", bind_root_dirs[i]);
+            return -1;
+        }
+    }
+    snprintf(path, sizeof(path), "%s/var", root_path);
+    if (mount("tmpfs", path, "tmpfs", MS_NOSUID | MS_NODEV, "mode=0755") == -1) {
+        perror("mount var tmpfs failed");
+        return -1;
+    }
+    if (pivot_into(root_path) != 0) {
+        return -1;
+    }
+    if (mount(nullptr, "/", nullptr, MS_BIND | MS_REMOUNT | MS_RDONLY | MS_NOSUID | MS_NODEV, nullptr) == -1) {
+        perror("remount root read-only failed");
+    }
+    return 0;
+}
+static int overlay_dir_path(char *path, size_t size, const char *container_id, const char *part) {
+    int n = part ? snprintf(path, size, "%s/%s/%s", FS_OVERLAY_DIR, container_id, part)
+                 : snprintf(path, size, "%s/%s", FS_OVERLAY_DIR, container_id);
+    if (n < 0 || (size_t)n >= size) {
+        fprintf(stderr, "Error: overlay path for %s is too long\n", container_id);
+        return -1;
+    }
+    return 0;
+}
+static bool is_overlay_mount(const char *path) {
+    struct statfs fs;
+    struct statx stx;
+    if (statfs(path, &fs) == -1 || fs.f_type != OVERLAYFS_SUPER_MAGIC) {
+        return false;
+    }
+    if (statx(AT_FDCWD, path, AT_SYMLINK_NOFOLLOW, STATX_BASIC_STATS, &stx) == -1) {
+        return false;
+    }
+    return (stx.stx_attributes_mask & STATX_ATTR_MOUNT_ROOT) && (stx.stx_attributes & STATX_ATTR_MOUNT_ROOT);
+}
+static int check_lower_dirs(const char *lower_dirs) {
+    if (!lower_dirs || !*lower_dirs) {
+        fprintf(stderr, "Error: overlay root requires at least one lower directory\n");
+        return -1;
+    }
+    if (strchr(lower_dirs, ',')) {
+        fprintf(stderr, "Error: overlay lower directories cannot contain ','\n");
+        return -1;
+    }
+    char dir[PATH_MAX];
+    const char *start = lower_dirs;
+    while (*start) {
+        const char *end = strchr(start, ':');
+        size_t len = end ? (size_t)(end - start) : strlen(start);
+        if (len == 0 || len >= sizeof(dir)) {
+            fprintf(stderr, "Error: invalid overlay lower directory list %s\n", lower_dirs);
+            return -1;
+        }
+        memcpy(dir, start, len);
+        dir[len] = '\0';
+        struct stat st;
+        if (stat(dir, &st) == -1 || !S_ISDIR(st.st_mode)) {
+            fprintf(stderr, "Error: overlay lower directory %s is not a directory\n", dir);
+            return -1;
+        }
+        start += len + (end ? 1 : 0);
+    }
+    return 0;
+}
+int fs_overlay_root_path(const fs_config_t *config, const char *container_id, char *path, size_t size) {
+    if (!config || !container_id || !path) {
+        fprintf(stderr, "Error: overlay arguments cannot be NULL\n");
+        return -1;
+    }
+    const char *root = config->root_path;
+    if (!root || strcmp(root, "/") == 0) {
+        return overlay_dir_path(path, size, container_id, "merged");
+    }
+    if (strlen(root) >= size) {
+        fprintf(stderr, "Error: overlay root path %s is too long\n", root);
+        return -1;
+    }
+    strcpy(path, root);
+    return 0;
+}
+int fs_mount_overlay_root(const fs_config_t *config, const char *container_id) {
+    char merged[PATH_MAX], upper[PATH_MAX], work[PATH_MAX];
+    if (fs_overlay_root_path(config, container_id, merged, sizeof(merged)) != 0 ||
+        overlay_dir_path(upper, sizeof(upper), container_id, "upper") != 0 ||
+        overlay_dir_path(work, sizeof(work), container_id, "work") != 0) {
+        return -1;
+    }
+    if (is_overlay_mount(merged)) {
+        return 0;
+    }
+    if (check_lower_dirs(config->lower_dirs) != 0) {
+        return -1;
+    }
+    if (fs_mkdir_p(upper) != 0 || fs_mkdir_p(work) != 0 || fs_mkdir_p(merged) != 0) {
+        perror("mkdir overlay directories failed");
+        return -1;
+    }
+    char options[4096];
+    int n = snprintf(options, sizeof(options), "lowerdir=%s,upperdir=%s,workdir=%s",
+                     config->lower_dirs, upper, work);
+    if (n < 0 || (size_t)n >= sizeof(options)) {
+        fprintf(stderr, "Error: overlay lower directory list is too long\n");
+        return -1;
+    }
+    if (mount("overlay", merged, "overlay", 0, options) == -1) {
+        perror("mount overlay failed");
+        return -1;
+    }
+    char path[PATH_MAX];
+    for (int i = 0; overlay_mount_points[i] != nullptr; i++) {
+        snprintf(path, sizeof(path), "%s%s", merged, overlay_mount_points[i]);
+        if (mkdir(path, 0755) == -1 && errno != EEXIST) {
+            perror("mkdir overlay mount point failed");
+            umount2(merged, MNT_DETACH);
+            return -1;
+        }
+    }
+    LOG_DEBUG("Mounted overlay root %s with lower layers %s", merged, config->lower_dirs);
+    return 0;
+}
+int fs_enter_root(const char *root_path) {
+    if (!root_path) {
+        fprintf(stderr, "Error: root path cannot be NULL\n");
+        return -1;
+    }
+    if (mount(root_path, root_path, nullptr, MS_BIND | MS_REC, nullptr) == -1) {
+        perror("bind root failed");
+        return -1;
+    }
+    return pivot_into(root_path);
+}
+int fs_enter_read_only_root(const char *root_path) {
+    if (!root_path) {
+        fprintf(stderr, "Error: root path cannot be NULL\n");
+        return -1;
+    }
+    if (mount(root_path, root_path, nullptr, MS_BIND | MS_REC, nullptr) == -1) {
+        perror("bind root failed");
+        return -1;
+    }
+    char path[PATH_MAX];
+    struct stat st;
+    snprintf(path, sizeof(path), "%s/var", root_path);
+    if (stat(path, &st) == 0 && S_ISDIR(st.st_mode) &&
+        mount("tmpfs", path, "tmpfs", MS_NOSUID | MS_NODEV, "mode=0755") == -1) {
+        perror("mount var tmpfs failed");
+        return -1;
+    }
+    if (pivot_into(root_path) != 0) {
+        return -1;
+    }
+    if (mount(nullptr, "/", nullptr, MS_BIND | MS_REMOUNT | MS_RDONLY, nullptr) == -1) {
+        perror("remount root read-only failed");
+        return -1;
+    }
+    return 0;
+}
+static void sum_tree_usage(int dir_fd, dev_t dev, unsigned long long *bytes) {
+    DIR *dir = fdopendir(dir_fd);
+    if (!dir) {
+        close(dir_fd);
+        return;
+    }
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+            continue;
+        }
+        struct stat st;
+        if (fstatat(dirfd(dir), entry->d_name, &st, AT_SYMLINK_NOFOLLOW) == -1 || st.st_dev != dev) {
+            continue;
+        }
+        *bytes += (unsigned long long)st.st_blocks * 512;
+        if (S_ISDIR(st.st_mode)) {
+            int child = openat(dirfd(dir), entry->d_name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+            if (child >= 0) {
+                sum_tree_usage(child, dev, bytes);
+            }
+        }
+    }
+    closedir(dir);
+}
+int fs_tree_usage(const char *path, unsigned long long *bytes) {
+    if (!path || !bytes) {
+        fprintf(stderr, "Error: tree arguments cannot be NULL\n");
+        return -1;
+    }
+    *bytes = 0;
+    int fd = open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd == -1) {
+        perror("open directory failed");
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        perror("fstat directory failed");
+        close(fd);
+        return -1;
+    }
+    sum_tree_usage(fd, st.st_dev, bytes);
+    return 0;
+}
+int fs_overlay_usage(const char *container_id, unsigned long long *bytes) {
+    if (!container_id || !bytes) {
+        fprintf(stderr, "Error: overlay arguments cannot be NULL\n");
+        return -1;
+    }
+    char upper[PATH_MAX];
+    if (overlay_dir_path(upper, sizeof(upper), container_id, "upper") != 0) {
+        return -1;
+    }
+    return fs_tree_usage(upper, bytes);
+}
+static int remove_tree(int dir_fd, dev_t dev) {
+    DIR *dir = fdopendir(dir_fd);
+    if (!dir) {
+        close(dir_fd);
+        return -1;
+    }
+    int result = 0;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+            continue;
+        }
+        struct stat st;
+        if (fstatat(dirfd(dir), entry->d_name, &st, AT_SYMLINK_NOFOLLOW) == -1) {
+            result = -1;
+            continue;
+        }
+        if (S_ISDIR(st.st_mode)) {
+            if (st.st_dev != dev) {
+                result = -1;
+                continue;
+            }
+            int child = openat(dirfd(dir), entry->d_name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+            if (child == -1 || remove_tree(child, dev) != 0) {
+                result = -1;
+                continue;
+            }
+        }
+        if (unlinkat(dirfd(dir), entry->d_name, S_ISDIR(st.st_mode) ? AT_REMOVEDIR : 0) == -1) {
+            result = -1;
+        }
+    }
+    closedir(dir);
+    return result;
+}
+int fs_remove_tree(const char *path) {
+    if (!path) {
+        fprintf(stderr, "Error: path cannot be NULL\n");
+        return -1;
+    }
+    int fd = open(path, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    if (fd == -1) {
+        if (errno == ENOENT) {
+            return 0;
+        }
+        perror("open directory failed");
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        perror("fstat directory failed");
+        close(fd);
+        return -1;
+    }
+    if (remove_tree(fd, st.st_dev) != 0 || rmdir(path) == -1) {
+        return -1;
+    }
+    return 0;
+}
+static void unescape_mount_path(char *path) {
+    char *out = path;
+    for (char *in = path; *in; in++) {
+        if (in[0] == '\\' && in[1] >= '0' && in[1] <= '3' && in[2] >= '0' && in[2] <= '7' &&
+            in[3] >= '0' && in[3] <= '7') {
+            *out++ = (char)(((in[1] - '0') << 6) | ((in[2] - '0') << 3) | (in[3] - '0'));
+            in += 3;
+        } else {
+            *out++ = *in;
+        }
+    }
+    *out = '\0';
+}
+int fs_unmount_overlay(const char *container_id) {
+    if (!container_id) {
+        fprintf(stderr, "Error: container id cannot be NULL\n");
+        return -1;
+    }
+    char upper[PATH_MAX];
+    if (overlay_dir_path(upper, sizeof(upper), container_id, "upper") != 0) {
+        return -1;
+    }
+    std::string option = std::string("upperdir=") + upper;
+    FILE *mounts = fopen("/proc/self/mountinfo", "re");
+    if (!mounts) {
+        perror("open mountinfo failed");
+        return -1;
+    }
+    std::vector<std::string> targets;
+    char *line = nullptr;
+    size_t capacity = 0;
+    while (getline(&line, &capacity, mounts) != -1) {
+        char *fields = strstr(line, " - ");
+        if (!fields || strncmp(fields + 3, "overlay ", 8) != 0) {
+            continue;
+        }
+        const char *match = strstr(fields, option.c_str());
+        if (!match || (match[option.size()] != ',' && match[option.size()] != '\n')) {
+            continue;
+        }
+        char *save = nullptr;
+        char *target = strtok_r(line, " ", &save);
+        for (int i = 0; target && i < 4; i++) {
+            target = strtok_r(nullptr, " ", &save);
+        }
+        if (target) {
+            unescape_mount_path(target);
+            targets.push_back(target);
+        }
+    }
+    free(line);
+    fclose(mounts);
+    int result = 0;
+    for (size_t i = targets.size(); i-- > 0;) {
+        if (umount2(targets[i].c_str(), MNT_DETACH) == -1 && errno != EINVAL && errno != ENOENT) {
+            perror("umount overlay root failed");
+            result = -1;
+        }
+    }
+    return result;
+}
+int fs_remove_overlay(const char *container_id) {
+    if (!container_id) {
+        fprintf(stderr, "Error: container id cannot be NULL\n");
+        return -1;
+    }
+    char path[PATH_MAX];
+    if (overlay_dir_path(path, sizeof(path), container_id, nullptr) != 0) {
+        return -1;
+    }
+    if (fs_remove_tree(path) != 0) {
+        fprintf(stderr, "Warning: failed to remove overlay layers of %s\n", container_id);
+        return -1;
+    }
+    return 0;
+}
+int fs_open_in_root(int root_fd, const char *path, int flags) {
+    struct open_how how;
+    memset(&how, 0, sizeof(how));
+    how.flags = (unsigned long long)(flags | O_CLOEXEC);
+    how.resolve = RESOLVE_IN_ROOT | RESOLVE_NO_MAGICLINKS;
+    int fd = (int)syscall(SYS_openat2, root_fd, path, &how, sizeof(how));
+    if (fd == -1 && errno == ENOSYS) {
+        while (*path == '/') {
+            path++;
+        }
+        fd = openat(root_fd, *path ? path : ".", flags | O_CLOEXEC);
+    }
+    return fd;
+}
+static int normalize_path(const char *path, char *out, size_t size) {
+    size_t len = 0;
+    out[0] = '\0';
+    while (*path) {
+        while (*path == '/') {
+            path++;
+        }
+        const char *end = strchr(path, '/');
+        size_t n = end ? (size_t)(end - path) : strlen(path);
+        if (n == 2 && path[0] == '.' && path[1] == '.') {
+            while (len > 0 && out[len - 1] != '/') {
+                len--;
+            }
+            if (len > 0) {
+                len--;
+            }
+            out[len] = '\0';
+        } else if (n > 0 && !(n == 1 && path[0] == '.')) {
+            if (len + n + 2 > size) {
+                errno = ENAMETOOLONG;
+                return -1;
+            }
+            out[len++] = '/';
+            memcpy(out + len, path, n);
+            len += n;
+            out[len] = '\0';
+        }
+        path += n;
+    }
+    if (len == 0) {
+        snprintf(out, size, "/");
+    }
+    return 0;
+}
+static int materialize_path(const char *root_path, int host_fd, const char *logical, int links);
+static int follow_link(const char *root_path, int host_fd, const char *dir, const char *target,
+                       const char *rest, int links) {
+    if (links >= ELF_CLOSURE_MAX_LINKS) {
+        errno = ELOOP;
+        return -1;
+    }
+    char joined[PATH_MAX * 2], path[PATH_MAX];
+    snprintf(joined, sizeof(joined), "%s/%s%s", target[0] == '/' ? "" : dir, target, rest);
+    if (normalize_path(joined, path, sizeof(path)) != 0) {
+        return -1;
+    }
+    return materialize_path(root_path, host_fd, path, links + 1);
+}
+static int materialize_path(const char *root_path, int host_fd, const char *logical, int links) {
+    char cur[PATH_MAX] = "";
+    const char *p = logical;
+    while (*p == '/') {
+        p++;
+    }
+    while (*p) {
+        const char *slash = strchr(p, '/');
+        size_t len = slash ? (size_t)(slash - p) : strlen(p);
+        const char *rest = p + len;
+        while (*rest == '/' && rest[1] == '/') {
+            rest++;
+        }
+        bool last = rest[0] == '\0' || rest[1] == '\0';
+        char next[PATH_MAX], name[NAME_MAX + 1], dst[PATH_MAX], target[PATH_MAX];
+        size_t cur_len = strlen(cur);
+        if (len > NAME_MAX || cur_len + len + 2 > sizeof(next)) {
+            errno = ENAMETOOLONG;
+            return -1;
+        }
+        memcpy(name, p, len);
+        name[len] = '\0';
+        memcpy(next, cur, cur_len);
+        next[cur_len] = '/';
+        memcpy(next + cur_len + 1, name, len + 1);
+        snprintf(dst, sizeof(dst), "%s%s", root_path, next);
+        struct stat st;
+        if (lstat(dst, &st) == 0) {
+            if (S_ISLNK(st.st_mode)) {
+                ssize_t n = readlink(dst, target, sizeof(target) - 1);
+                if (n < 0) {
+                    return -1;
+                }
+                target[n] = '\0';
+                return follow_link(root_path, host_fd, cur, target, rest, links);
+            }
+            if (last || !S_ISDIR(st.st_mode)) {
+                return 0;
+            }
+            strcpy(cur, next);
+            p = rest + (*rest ? 1 : 0);
+            continue;
+        }
+        int parent = fs_open_in_root(host_fd, *cur ? cur : "/", O_PATH | O_DIRECTORY);
+        if (parent == -1) {
+            return -1;
+        }
+        int result = 0;
+        if (fstatat(parent, name, &st, AT_SYMLINK_NOFOLLOW) == -1) {
+            result = -1;
+        } else if (S_ISLNK(st.st_mode)) {
+            ssize_t n = readlinkat(parent, name, target, sizeof(target) - 1);
+            close(parent);
+            if (n < 0) {
+                return -1;
+            }
+            target[n] = '\0';
+            if (symlink(target, dst) == -1 && errno != EEXIST) {
+                return -1;
+            }
+            return follow_link(root_path, host_fd, cur, target, rest, links);
+        } else if (S_ISDIR(st.st_mode) && !last) {
+            if (mkdir(dst, st.st_mode & 07777) == -1 && errno != EEXIST) {
+                result = -1;
+            }
+        } else if (S_ISREG(st.st_mode) && last) {
+            char src[PATH_MAX];
+            snprintf(src, sizeof(src), "/proc/self/fd/%d/%s", parent, name);
+            fs_copy_method_t method;
+            result = fs_copy_file(src, dst, &method);
+            if (result == 0) {
+                LOG_DEBUG("copied %s with %s", next, fs_copy_method_name(method));
+            }
+        } else {
+            errno = S_ISDIR(st.st_mode) ? EISDIR : ENOTDIR;
+            result = -1;
+        }
+        close(parent);
+        if (result != 0 || last) {
+            return result;
+        }
+        strcpy(cur, next);
+        p = rest + (*rest ? 1 : 0);
+    }
+    return 0;
+}
+int fs_populate_container_binaries(const char *root_path, const char *host_root,
+                                   const char *const *binaries, int count) {
     if (!root_path || !host_root) {
         fprintf(stderr, "Error: root paths cannot be NULL\n");
         return -1;
     }
-    const char *essential_files[] = {
-        "/bin/sh",
-        "/bin/bash",
-        "/lib/ld-linux.so.2",
-        "/lib64/ld-linux-x86-64.so.2",
-        nullptr
-    };
-    for (int i = 0; essential_files[i] != nullptr; i++) {
-        char src_path[PATH_MAX];
-        char dst_path[PATH_MAX];
-        snprintf(src_path, sizeof(src_path), "%s%s", host_root, essential_files[i]);
-        snprintf(dst_path, sizeof(dst_path), "%s%s", root_path, essential_files[i]);
-        if (copy_file(src_path, dst_path) != 0) {
-            fprintf(stderr, "Warning: failed to copy %s\n", essential_files[i]);
+    elf_closure_t closure;
+    if (elf_closure_resolve(host_root, binaries, count, &closure) != 0) {
+        fprintf(stderr, "Error: failed to resolve the libraries of the container binaries\n");
+        return -1;
+    }
+    int host_fd = open(host_root, O_PATH | O_DIRECTORY | O_CLOEXEC);
+    if (host_fd == -1) {
+        perror("open host root failed");
+        elf_closure_free(&closure);
+        return -1;
+    }
+    for (int i = 0; i < closure.count; i++) {
+        if (materialize_path(root_path, host_fd, closure.paths[i], 0) != 0) {
+            fprintf(stderr, "Warning: failed to copy %s: %s\n", closure.paths[i], strerror(errno));
         }
     }
+    if (materialize_path(root_path, host_fd, "/etc/ld.so.cache", 0) != 0 && errno != ENOENT) {
+        fprintf(stderr, "Warning: failed to copy /etc/ld.so.cache: %s\n", strerror(errno));
+    }
+    close(host_fd);
+    elf_closure_free(&closure);
+    return 0;
+}
+static vector<const char*> with_essential_binaries(const char *const *binaries, int count) {
+    vector<const char*> list;
+    for (int i = 0; essential_binaries[i] != nullptr; i++) {
+        list.push_back(essential_binaries[i]);
+    }
+    for (int i = 0; binaries && i < count; i++) {
+        list.push_back(binaries[i]);
+    }
+    return list;
+}
+int fs_populate_container_root(const char *root_path, const char *host_root) {
+    vector<const char*> list = with_essential_binaries(nullptr, 0);
+    return fs_populate_container_binaries(root_path, host_root, list.data(), (int)list.size());
+}
+int fs_build_container_root(const char *root_path, const char *host_root,
+                            const char *const *binaries, int count) {
+    if (fs_create_minimal_root(root_path) != 0) {
+        return -1;
+    }
+    vector<const char*> list = with_essential_binaries(binaries, count);
+    return fs_populate_container_binaries(root_path, host_root, list.data(), (int)list.size());
+}
+static void append_file_key(string *recipe, int host_fd, const char *path) {
+    int fd = fs_open_in_root(host_fd, path, O_PATH);
+    struct stat st;
+    if (fd == -1 || fstat(fd, &st) == -1) {
+        *recipe += string("missing ") + path + "\n";
+    } else {
+        char line[PATH_MAX + 128];
+        snprintf(line, sizeof(line), "file %s %lu %lu %lld.%09ld %lld\n", path, (unsigned long)st.st_dev,
+                 (unsigned long)st.st_ino, (long long)st.st_mtim.tv_sec, st.st_mtim.tv_nsec, (long long)st.st_size);
+        *recipe += line;
+    }
+    if (fd != -1) {
+        close(fd);
+    }
+}
+int fs_root_recipe(const char *host_root, const char *const *binaries, int count, char **recipe) {
+    if (!host_root || !recipe) {
+        fprintf(stderr, "Error: recipe arguments cannot be NULL\n");
+        return -1;
+    }
+    vector<const char*> list = with_essential_binaries(binaries, count);
+    elf_closure_t closure;
+    if (elf_closure_resolve(host_root, list.data(), (int)list.size(), &closure) != 0) {
+        return -1;
+    }
+    int host_fd = open(host_root, O_PATH | O_DIRECTORY | O_CLOEXEC);
+    if (host_fd == -1) {
+        perror("open host root failed");
+        elf_closure_free(&closure);
+        return -1;
+    }
+    string text = string("host ") + host_root + "\n";
+    for (int i = 0; essential_dirs[i] != nullptr; i++) {
+        text += string("dir ") + essential_dirs[i] + "\n";
+    }
+    for (int i = 0; essential_devices[i].path != nullptr; i++) {
+        char line[PATH_MAX];
+        snprintf(line, sizeof(line), "dev %s %o %u:%u\n", essential_devices[i].path,
+                 (unsigned int)essential_devices[i].mode, major(essential_devices[i].dev),
+                 minor(essential_devices[i].dev));
+        text += line;
+    }
+    for (size_t i = 0; i < list.size(); i++) {
+        text += string("binary ") + list[i] + "\n";
+    }
+    for (int i = 0; i < closure.count; i++) {
+        append_file_key(&text, host_fd, closure.paths[i]);
+    }
+    append_file_key(&text, host_fd, "/etc/ld.so.cache");
+    close(host_fd);
+    elf_closure_free(&closure);
+    *recipe = strdup(text.c_str());
+    if (!*recipe) {
+        perror("strdup failed");
+        return -1;
+    }
     return 0;
 }
 int fs_cleanup_container_root(const char *root_path) {
@@ -214,6 +1033,10 @@ int fs_cleanup_container_root(const char *root_path) {
             }
         }
     }
+    if (is_overlay_mount(root_path) && umount2(root_path, MNT_DETACH) == -1) {
+        perror("umount overlay root failed");
+        return -1;
+    }
     if (rmdir(root_path) == -1) {
         if (errno != ENOTEMPTY) {
             perror("rmdir root path failed");
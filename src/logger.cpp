@@ -0,0 +1,332 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdarg>
+#include <cstdint>
+#include <ctime>
+#include <strings.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <string>
+#include <utility>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include "../include/logger.hpp"
+using namespace std;
+#define LOG_RING_SLOTS 128
+#define LOG_MESSAGE_MAX 240
+#define LOG_DRAIN_INTERVAL_MS 20
+#define LOG_DEFAULT_LEVEL LOG_LEVEL_WARN
+struct log_entry {
+    int64_t timestamp_ns;
+    const char *file;
+    const char *func;
+    int line;
+    int level;
+    char message[LOG_MESSAGE_MAX];
+};
+struct log_ring {
+    log_entry slots[LOG_RING_SLOTS];
+    atomic<uint64_t> head;
+    atomic<uint64_t> tail;
+    atomic<uint64_t> dropped;
+    atomic<bool> orphaned;
+    pid_t tid;
+    log_ring *next;
+};
+struct ring_handle {
+    log_ring *ring;
+    ~ring_handle() {
+        if (ring) {
+            ring->orphaned.store(true, memory_order_release);
+        }
+    }
+};
+static const char *level_names[] = {"trace", "debug", "info", "warn", "error", "off"};
+static atomic<int> current_level(-1);
+static atomic<int> current_format(LOG_FORMAT_TEXT);
+static atomic<bool> sync_mode(false);
+static mutex registry_lock;
+static log_ring *rings = nullptr;
+static once_flag writer_once;
+static mutex writer_lock;
+static condition_variable writer_cond;
+static bool writer_stop = false;
+static thread *writer = nullptr;
+static atomic<pid_t> owner_pid(0);
+static thread_local ring_handle local_ring = {nullptr};
+int log_parse_level(const char *name) {
+    if (!name || !*name) return -1;
+    if (name[0] >= '0' && name[0] <= '9' && name[1] == '\0') {
+        int level = name[0] - '0';
+        return level <= LOG_LEVEL_OFF ? level : -1;
+    }
+    for (int i = 0; i <= LOG_LEVEL_OFF; i++) {
+        if (strcasecmp(name, level_names[i]) == 0) {
+            return i;
+        }
+    }
+    if (strcasecmp(name, "warning") == 0) return LOG_LEVEL_WARN;
+    if (strcasecmp(name, "none") == 0) return LOG_LEVEL_OFF;
+    return -1;
+}
+static int init_from_env() {
+    const char *format = getenv(LOG_ENV_FORMAT);
+    if (format && strcasecmp(format, "json") == 0) {
+        current_format.store(LOG_FORMAT_JSON, memory_order_relaxed);
+    }
+    int level = log_parse_level(getenv(LOG_ENV_LEVEL));
+    if (level < 0) {
+        level = LOG_DEFAULT_LEVEL;
+    }
+    int expected = -1;
+    if (!current_level.compare_exchange_strong(expected, level)) {
+        return expected;
+    }
+    return level;
+}
+int log_enabled(int level) {
+    int current = current_level.load(memory_order_relaxed);
+    if (current < 0) {
+        current = init_from_env();
+    }
+    return level >= current;
+}
+void log_set_level(int level) {
+    if (level < LOG_LEVEL_TRACE || level > LOG_LEVEL_OFF) return;
+    current_level.store(level, memory_order_relaxed);
+}
+int log_get_level(void) {
+    int current = current_level.load(memory_order_relaxed);
+    return current < 0 ? init_from_env() : current;
+}
+void log_set_format(log_format_t format) {
+    current_format.store(format, memory_order_relaxed);
+}
+static void append_escaped(string &out, const char *str) {
+    for (const unsigned char *p = reinterpret_cast<const unsigned char*>(str); *p; p++) {
+        if (*p == '"' || *p == '\\') {
+            out += '\\';
+            out += (char)*p;
+        } else if (*p == '\n') {
+            out += "\\n";
+        } else if (*p == '\t') {
+            out += "\\t";
+        } else if (*p < 0x20) {
+            char hex[8];
+            snprintf(hex, sizeof(hex), "\\u%04x", *p);
+            out += hex;
+        } else {
+            out += (char)*p;
+        }
+    }
+}
+static const char *base_name(const char *path) {
+    const char *slash = strrchr(path, '/');
+    return slash ? slash + 1 : path;
+}
+static void format_entry(string &out, const log_entry *e, pid_t tid) {
+    time_t seconds = (time_t)(e->timestamp_ns / 1000000000);
+    struct tm tm_utc;
+    gmtime_r(&seconds, &tm_utc);
+    char ts[64];
+    size_t n = strftime(ts, sizeof(ts), "%Y-%m-%dT%H:%M:%S", &tm_utc);
+    snprintf(ts + n, sizeof(ts) - n, ".%06dZ", (int)(e->timestamp_ns % 1000000000 / 1000));
+    char src[160];
+    snprintf(src, sizeof(src), "%s:%d", base_name(e->file), e->line);
+    const char *level = level_names[e->level];
+    if (current_format.load(memory_order_relaxed) == LOG_FORMAT_JSON) {
+        char head[320];
+        snprintf(head, sizeof(head), "{\"ts\":\"%s\",\"level\":\"%s\",\"tid\":%d,\"src\":\"%s\",\"func\":\"%s\",\"msg\":\"",
+                 ts, level, (int)tid, src, e->func);
+        out += head;
+        append_escaped(out, e->message);
+        out += "\"}\n";
+    } else {
+        char head[320];
+        snprintf(head, sizeof(head), "ts=%s level=%s tid=%d src=%s func=%s msg=\"",
+                 ts, level, (int)tid, src, e->func);
+        out += head;
+        append_escaped(out, e->message);
+        out += "\"\n";
+    }
+}
+static void emit(const string &out) {
+    const char *p = out.data();
+    size_t left = out.size();
+    while (left > 0) {
+        ssize_t n = write(STDERR_FILENO, p, left);
+        if (n <= 0) {
+            return;
+        }
+        p += n;
+        left -= (size_t)n;
+    }
+}
+static void drain_locked() {
+    vector<pair<int64_t, string> > lines;
+    log_ring **link = &rings;
+    while (*link) {
+        log_ring *ring = *link;
+        bool orphaned = ring->orphaned.load(memory_order_acquire);
+        uint64_t head = ring->head.load(memory_order_acquire);
+        uint64_t tail = ring->tail.load(memory_order_relaxed);
+        for (; tail != head; tail++) {
+            const log_entry *e = &ring->slots[tail % LOG_RING_SLOTS];
+            lines.push_back(make_pair(e->timestamp_ns, string()));
+            format_entry(lines.back().second, e, ring->tid);
+        }
+        ring->tail.store(tail, memory_order_release);
+        uint64_t dropped = ring->dropped.exchange(0, memory_order_relaxed);
+        if (dropped > 0) {
+            log_entry note;
+            struct timespec now;
+            clock_gettime(CLOCK_REALTIME, &now);
+            note.timestamp_ns = (int64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+            note.file = __FILE__;
+            note.func = __FUNCTION__;
+            note.line = __LINE__;
+            note.level = LOG_LEVEL_WARN;
+            snprintf(note.message, sizeof(note.message), "dropped %llu log record(s), ring full",
+                     (unsigned long long)dropped);
+            lines.push_back(make_pair(note.timestamp_ns, string()));
+            format_entry(lines.back().second, &note, ring->tid);
+        }
+        if (orphaned) {
+            *link = ring->next;
+            delete ring;
+        } else {
+            link = &ring->next;
+        }
+    }
+    if (lines.empty()) {
+        return;
+    }
+    stable_sort(lines.begin(), lines.end(),
+                [](const pair<int64_t, string> &a, const pair<int64_t, string> &b) {
+                    return a.first < b.first;
+                });
+    string out;
+    for (size_t i = 0; i < lines.size(); i++) {
+        out += lines[i].second;
+    }
+    emit(out);
+}
+static void writer_main() {
+    unique_lock<mutex> lock(writer_lock);
+    while (!writer_stop) {
+        writer_cond.wait_for(lock, chrono::milliseconds(LOG_DRAIN_INTERVAL_MS));
+        lock.unlock();
+        {
+            lock_guard<mutex> registry(registry_lock);
+            drain_locked();
+        }
+        lock.lock();
+    }
+}
+static void after_fork_child() {
+    sync_mode.store(true, memory_order_relaxed);
+}
+static bool foreign_process() {
+    pid_t owner = owner_pid.load(memory_order_relaxed);
+    return owner != 0 && owner != getpid();
+}
+static void start_writer() {
+    owner_pid.store(getpid(), memory_order_relaxed);
+    pthread_atfork(nullptr, nullptr, after_fork_child);
+    writer = new thread(writer_main);
+    atexit(log_shutdown);
+}
+static log_ring *acquire_ring() {
+    if (local_ring.ring) {
+        return local_ring.ring;
+    }
+    log_ring *ring = new (nothrow) log_ring();
+    if (!ring) {
+        return nullptr;
+    }
+    ring->tid = (pid_t)syscall(SYS_gettid);
+    {
+        lock_guard<mutex> registry(registry_lock);
+        ring->next = rings;
+        rings = ring;
+    }
+    call_once(writer_once, start_writer);
+    local_ring.ring = ring;
+    return ring;
+}
+static void fill_entry(log_entry *e, int level, const char *file, int line, const char *func,
+                       const char *fmt, va_list args) {
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    e->timestamp_ns = (int64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+    e->file = file;
+    e->func = func;
+    e->line = line;
+    e->level = level;
+    int len = vsnprintf(e->message, sizeof(e->message), fmt, args);
+    if (len >= (int)sizeof(e->message)) {
+        len = sizeof(e->message) - 1;
+    }
+    while (len > 0 && e->message[len - 1] == '\n') {
+        e->message[--len] = '\0';
+    }
+}
+void log_write(int level, const char *file, int line, const char *func, const char *fmt, ...) {
+    if (level < LOG_LEVEL_TRACE || level >= LOG_LEVEL_OFF) return;
+    va_list args;
+    va_start(args, fmt);
+    bool direct = sync_mode.load(memory_order_relaxed) || foreign_process();
+    log_ring *ring = direct ? nullptr : acquire_ring();
+    if (!ring) {
+        log_entry e;
+        fill_entry(&e, level, file, line, func, fmt, args);
+        va_end(args);
+        string out;
+        format_entry(out, &e, (pid_t)syscall(SYS_gettid));
+        emit(out);
+        return;
+    }
+    uint64_t head = ring->head.load(memory_order_relaxed);
+    if (head - ring->tail.load(memory_order_acquire) >= LOG_RING_SLOTS) {
+        ring->dropped.fetch_add(1, memory_order_relaxed);
+        va_end(args);
+        return;
+    }
+    fill_entry(&ring->slots[head % LOG_RING_SLOTS], level, file, line, func, fmt, args);
+    va_end(args);
+    ring->head.store(head + 1, memory_order_release);
+    if (level >= LOG_LEVEL_ERROR || head - ring->tail.load(memory_order_relaxed) >= LOG_RING_SLOTS / 2) {
+        writer_cond.notify_one();
+    }
+}
+void log_flush(void) {
+    if (foreign_process()) return;
+    lock_guard<mutex> registry(registry_lock);
+    drain_locked();
+}
+void log_shutdown(void) {
+    if (foreign_process()) return;
+    thread *worker = nullptr;
+    {
+        lock_guard<mutex> lock(writer_lock);
+        writer_stop = true;
+        worker = writer;
+        writer = nullptr;
+    }
+    writer_cond.notify_one();
+    if (worker) {
+        if (worker->joinable()) {
+            worker->join();
+        }
+        delete worker;
+    }
+    sync_mode.store(true, memory_order_relaxed);
+    log_flush();
+}
@@ -3,7 +3,10 @@
 #include <cstdlib>
 #include <cstdio>
 #include <cstring>
+#include <cerrno>
 #include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
 #include <getopt.h>
 #include <csignal>
 #include <termios.h>
@@ -16,33 +19,28 @@
 #include <sstream>
 #include <vector>
 #include <algorithm>
+#include <atomic>
 #include "../include/container_manager.hpp"
 #include "../include/web_server_simple.hpp"
+#include "../include/logger.hpp"
+#include "../include/control_protocol.hpp"
 using namespace std;
 static container_manager_t cm;
 static bool running = true;
 static bool monitor_mode = false;
 static SimpleWebServer* web_server = nullptr;
-
-#define DEBUG_LOG(fmt, ...) \
-    do { \
-        fprintf(stderr, "[DEBUG] %s:%d [%s] " fmt "\n", __FILE__, __LINE__, __FUNCTION__, ##__VA_ARGS__); \
-        fflush(stderr); \
-    } while(0)
-
-#define ERROR_LOG(fmt, ...) \
-    do { \
-        fprintf(stderr, "[ERROR] %s:%d [%s] " fmt "\n", __FILE__, __LINE__, __FUNCTION__, ##__VA_ARGS__); \
-        fflush(stderr); \
-    } while(0)
+static int event_pipe[2] = {-1, -1};
+static pthread_t event_watcher;
+static atomic<bool> event_watcher_running(false);
 static const char *state_names[] = {
     [CONTAINER_CREATED] = "CREATED",
     [CONTAINER_RUNNING] = "RUNNING",
     [CONTAINER_STOPPED] = "STOPPED",
-    [CONTAINER_DESTROYED] = "DESTROYED"};
+    [CONTAINER_DESTROYED] = "DESTROYED",
+    [CONTAINER_PAUSED] = "PAUSED"};
 static inline const char *safe_state_name(container_state_t state) {
     int s = (int)state;
-    if (s < (int)CONTAINER_CREATED || s > (int)CONTAINER_DESTROYED) {
+    if (s < (int)CONTAINER_CREATED || s > (int)CONTAINER_PAUSED) {
         return "UNKNOWN";
     }
     const char *name = state_names[s];
@@ -76,11 +74,13 @@ static void print_usage(const char *program_name)
     printf("Usage: %s <command> [options] [arguments]\n\n", program_name);
     printf("Commands:\n");
     printf("  run <command> [args...]    Run a command in a new container\n");
-    printf("  start <container_id>       Start a stopped container\n");
-    printf("  stop <container_id>        Stop a running container\n");
+    printf("  start <id> [id...]         Start stopped containers\n");
+    printf("  stop [-t sec] <id...|--all> Stop running containers (SIGKILL after grace)\n");
     printf("  list                       List all containers\n");
     printf("  exec <container_id> <cmd>  Execute command in running container\n");
-    printf("  destroy <container_id>     Destroy a container\n");
+    printf("  pause <id> [id...]         Freeze running containers\n");
+    printf("  resume <id> [id...]        Thaw paused containers\n");
+    printf("  destroy <id> [id...]       Destroy containers\n");
     printf("  info <container_id>        Show container information\n");
     printf("\nOptions:\n");
     printf("  -h, --help                 Show this help message\n");
@@ -88,6 +88,14 @@ static void print_usage(const char *program_name)
     printf("  -c, --cpu <shares>         CPU shares (default: 1024)\n");
     printf("  -r, --root <path>          Container root filesystem path\n");
     printf("  -d, --detach               Run container in background (don't wait)\n");
+    printf("      --net                  Give the container its own network namespace (loopback only)\n");
+    printf("      --userns               Map container root to unprivileged uid %d\n", NAMESPACE_USERNS_BASE);
+    printf("      --ro-root              Build the root from read-only binds of host /bin, /lib, /lib64, /usr\n");
+    printf("      --lower <dir[:dir...]> Use an overlay root over these read-only lower layers\n");
+    printf("      --minimal              Build a minimal root at --root holding the command and its libraries\n");
+    printf("\nWhen mini-containerd is listening on %s (or $%s),\n",
+           CONTROL_SOCKET_PATH, CONTROL_ENV_SOCKET);
+    printf("run/start/stop/list/exec/destroy/info/pause/resume are forwarded to it.\n");
     printf("\nExamples:\n");
     printf("  %s run /bin/sh\n", program_name);
     printf("  %s run --memory 256 --cpu 512 /bin/echo \"Hello World\"\n", program_name);
@@ -103,6 +111,11 @@ static int parse_run_options(int argc, char *argv[], container_config_t *config,
         {"cpu", required_argument, 0, 'c'},
         {"root", required_argument, 0, 'r'},
         {"detach", no_argument, 0, 'd'},
+        {"net", no_argument, 0, 'N'},
+        {"userns", no_argument, 0, 'U'},
+        {"ro-root", no_argument, 0, 'R'},
+        {"lower", required_argument, 0, 'L'},
+        {"minimal", no_argument, 0, 'M'},
         {0, 0, 0, 0}};
     int option_index = 0;
     int c;
@@ -142,6 +155,23 @@ static int parse_run_options(int argc, char *argv[], container_config_t *config,
         case 'd':
             *detach = 1;
             break;
+        case 'N':
+            config->ns_config.flags |= NS_NET;
+            break;
+        case 'U':
+            config->ns_config.flags |= NS_USER;
+            break;
+        case 'R':
+            config->fs_config.method = FS_BIND_RO;
+            break;
+        case 'L':
+            config->fs_config.method = FS_OVERLAY;
+            config->fs_config.lower_dirs = optarg;
+            break;
+        case 'M':
+            config->fs_config.create_minimal_fs = 1;
+            config->fs_config.enter_root = 1;
+            break;
         default:
             fprintf(stderr, "Unknown option: %c\n", c);
             if (config->fs_config.root_path) {
@@ -207,7 +237,7 @@ static int handle_run(int argc, char *argv[])
             if (info->pid > 0)
             {
                 int status;
-                waitpid(info->pid, &status, 0);
+                container_manager_wait(&cm, config.id, -1, &status);
                 while (running) {
                     sleep(1);
                 }
@@ -224,6 +254,22 @@ static int handle_run(int argc, char *argv[])
     }
     return EXIT_SUCCESS;
 }
+struct batch_verbs {
+    const char *action;
+    const char *done;
+};
+static void report_batch_item(const char *container_id, int result, void *user_data)
+{
+    const batch_verbs *verbs = static_cast<const batch_verbs*>(user_data);
+    if (result == 0)
+    {
+        printf("Container %s %s\n", container_id, verbs->done);
+    }
+    else
+    {
+        fprintf(stderr, "Failed to %s container %s\n", verbs->action, container_id);
+    }
+}
 static int handle_start(int argc, char *argv[])
 {
     if (argc < 2)
@@ -231,6 +277,12 @@ static int handle_start(int argc, char *argv[])
         fprintf(stderr, "Error: container ID required\n");
         return EXIT_FAILURE;
     }
+    if (argc > 2)
+    {
+        batch_verbs verbs = { "start", "started" };
+        int failed = container_manager_start_many(&cm, argv + 1, argc - 1, nullptr, report_batch_item, &verbs);
+        return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
     const char *container_id = argv[1];
     if (container_manager_start(&cm, container_id) != 0)
     {
@@ -242,12 +294,44 @@ static int handle_start(int argc, char *argv[])
 }
 static int handle_stop(int argc, char *argv[])
 {
-    if (argc < 2)
+    int arg = 1;
+    if (argc > 2 && strcmp(argv[1], "-t") == 0)
+    {
+        container_manager_set_stop_timeout(&cm, atoi(argv[2]) * 1000);
+        arg = 3;
+    }
+    if (argc <= arg)
     {
         fprintf(stderr, "Error: container ID required\n");
         return EXIT_FAILURE;
     }
-    const char *container_id = argv[1];
+    batch_verbs verbs = { "stop", "stopped" };
+    if (strcmp(argv[arg], "--all") == 0)
+    {
+        int count;
+        container_info_t **containers = container_manager_list(&cm, &count);
+        std::vector<const char*> ids;
+        for (int i = 0; i < count; i++)
+        {
+            if (containers[i]->state == CONTAINER_RUNNING || containers[i]->state == CONTAINER_PAUSED)
+            {
+                ids.push_back(containers[i]->id);
+            }
+        }
+        if (ids.empty())
+        {
+            printf("No running containers\n");
+            return EXIT_SUCCESS;
+        }
+        int failed = container_manager_stop_many(&cm, ids.data(), (int)ids.size(), -1, nullptr, report_batch_item, &verbs);
+        return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    if (argc > arg + 1)
+    {
+        int failed = container_manager_stop_many(&cm, argv + arg, argc - arg, -1, nullptr, report_batch_item, &verbs);
+        return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    const char *container_id = argv[arg];
     if (container_manager_stop(&cm, container_id) != 0)
     {
         fprintf(stderr, "Failed to stop container %s\n", container_id);
@@ -256,33 +340,23 @@ static int handle_stop(int argc, char *argv[])
     printf("Container %s stopped\n", container_id);
     return EXIT_SUCCESS;
 }
-static int handle_list(int argc, char *argv[])
+static void print_container_table(const vector<container_view_t> &views)
 {
-    (void)argc;
-    (void)argv;
-    int count;
-    container_info_t **containers = container_manager_list(&cm, &count);
-    vector<container_info_t*> active_containers;
-    for (int i = 0; i < count; i++) {
-        if (containers[i]->state != CONTAINER_DESTROYED) {
-            active_containers.push_back(containers[i]);
-        }
-    }
-    if (active_containers.size() == 0)
+    if (views.size() == 0)
     {
         printf("No containers\n");
         printf("\nTo create a container, use:\n");
         printf("  ./mini-container run /bin/sh -c \"while true; do :; done\"\n");
         printf("  or use interactive menu: ./mini-container\n");
-        return EXIT_SUCCESS;
+        return;
     }
     printf("%-20s %-10s %-10s %-15s %-15s\n",
            "CONTAINER ID", "STATE", "PID", "CREATED", "STARTED");
     printf("%-20s %-10s %-10s %-15s %-15s\n",
            "------------", "-----", "---", "-------", "-------");
-    for (size_t i = 0; i < active_containers.size(); i++)
+    for (size_t i = 0; i < views.size(); i++)
     {
-        container_info_t *info = active_containers[i];
+        const container_view_t *info = &views[i];
         char created_str[20] = "";
         char started_str[20] = "";
         if (info->created_at > 0)
@@ -306,6 +380,21 @@ static int handle_list(int argc, char *argv[])
                created_str,
                started_str);
     }
+}
+static int handle_list(int argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+    uint64_t ticket;
+    const container_snapshot_t *snapshot = container_manager_snapshot_acquire(&cm, &ticket);
+    vector<container_view_t> active_containers;
+    for (int i = 0; snapshot && i < snapshot->count; i++) {
+        if (snapshot->containers[i].state != CONTAINER_DESTROYED) {
+            active_containers.push_back(snapshot->containers[i]);
+        }
+    }
+    container_manager_snapshot_release(&cm, ticket);
+    print_container_table(active_containers);
     return EXIT_SUCCESS;
 }
 static int handle_exec(int argc, char *argv[])
@@ -319,12 +408,11 @@ static int handle_exec(int argc, char *argv[])
     char **command = &argv[2];
     int command_argc = argc - 2;
     int result = container_manager_exec(&cm, container_id, command, command_argc);
-    if (result != 0)
+    if (result < 0)
     {
-        fprintf(stderr, "Command failed with exit code %d\n", result);
         return EXIT_FAILURE;
     }
-    return EXIT_SUCCESS;
+    return result;
 }
 static int handle_destroy(int argc, char *argv[])
 {
@@ -333,6 +421,12 @@ static int handle_destroy(int argc, char *argv[])
         fprintf(stderr, "Error: container ID required\n");
         return EXIT_FAILURE;
     }
+    if (argc > 2)
+    {
+        batch_verbs verbs = { "destroy", "destroyed" };
+        int failed = container_manager_destroy_many(&cm, argv + 1, argc - 1, nullptr, report_batch_item, &verbs);
+        return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
     const char *container_id = argv[1];
     if (container_manager_destroy(&cm, container_id) != 0)
     {
@@ -342,20 +436,32 @@ static int handle_destroy(int argc, char *argv[])
     printf("Container %s destroyed\n", container_id);
     return EXIT_SUCCESS;
 }
-static int handle_info(int argc, char *argv[])
+static int handle_pause_resume(int argc, char *argv[], bool pause)
 {
     if (argc < 2)
     {
         fprintf(stderr, "Error: container ID required\n");
         return EXIT_FAILURE;
     }
-    const char *container_id = argv[1];
-    container_info_t *info = container_manager_get_info(&cm, container_id);
-    if (!info)
+    int failed = 0;
+    for (int i = 1; i < argc; i++)
     {
-        fprintf(stderr, "Container %s not found\n", container_id);
-        return EXIT_FAILURE;
+        int result = pause ? container_manager_pause(&cm, argv[i]) : container_manager_resume(&cm, argv[i]);
+        if (result != 0)
+        {
+            fprintf(stderr, "Failed to %s container %s\n", pause ? "pause" : "resume", argv[i]);
+            failed++;
+        }
+        else
+        {
+            printf("Container %s %s\n", argv[i], pause ? "paused" : "resumed");
+        }
     }
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+static void print_container_details(const container_view_t *info, unsigned long cpu_usage,
+                                   unsigned long memory_usage, long long upper_usage)
+{
     printf("Container ID: %s\n", info->id);
     printf("State: %s\n", safe_state_name(info->state));
     printf("PID: %d\n", info->pid);
@@ -368,13 +474,64 @@ static int handle_info(int argc, char *argv[])
     {
         printf("Stopped: %s", ctime(&info->stopped_at));
     }
-    if (info->state == CONTAINER_RUNNING)
+    if (info->state == CONTAINER_RUNNING || info->state == CONTAINER_PAUSED)
     {
-        unsigned long cpu_usage = 0, memory_usage = 0;
-        resource_manager_get_stats(cm.rm, container_id, &cpu_usage, &memory_usage);
         printf("CPU Usage: %lu nanoseconds\n", cpu_usage);
         printf("Memory Usage: %lu bytes\n", memory_usage);
     }
+    if (upper_usage >= 0)
+    {
+        printf("Upper Layer Usage: %lld bytes\n", upper_usage);
+    }
+    if (info->start_trace.phase_ns[START_PHASE_TOTAL] > 0)
+    {
+        printf("Start Latency:%s\n", info->start_trace.pooled ? " (pooled)" : "");
+        for (int i = 0; i < START_PHASE_COUNT; i++)
+        {
+            if (info->start_trace.phase_ns[i] > 0 || i == START_PHASE_TOTAL)
+            {
+                printf("  %-16s %llu us\n", start_phase_name(i),
+                       (unsigned long long)(info->start_trace.phase_ns[i] / 1000));
+            }
+        }
+    }
+}
+static int handle_info(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "Error: container ID required\n");
+        return EXIT_FAILURE;
+    }
+    const char *container_id = argv[1];
+    container_info_t *info = container_manager_get_info(&cm, container_id);
+    if (!info)
+    {
+        fprintf(stderr, "Container %s not found\n", container_id);
+        return EXIT_FAILURE;
+    }
+    container_view_t view;
+    memset(&view, 0, sizeof(view));
+    strncpy(view.id, info->id, CONTAINER_VIEW_ID_MAX - 1);
+    view.pid = info->pid;
+    view.state = info->state;
+    view.created_at = info->created_at;
+    view.started_at = info->started_at;
+    view.stopped_at = info->stopped_at;
+    view.start_trace = info->start_trace;
+    view.fs_method = info->saved_config ? info->saved_config->fs_config.method : FS_CHROOT;
+    unsigned long cpu_usage = 0, memory_usage = 0;
+    if (info->state == CONTAINER_RUNNING || info->state == CONTAINER_PAUSED)
+    {
+        resource_manager_get_stats(cm.rm, container_id, &cpu_usage, &memory_usage);
+    }
+    unsigned long long upper_bytes = 0;
+    long long upper_usage = -1;
+    if (view.fs_method == FS_OVERLAY && fs_overlay_usage(view.id, &upper_bytes) == 0)
+    {
+        upper_usage = (long long)upper_bytes;
+    }
+    print_container_details(&view, cpu_usage, memory_usage, upper_usage);
     return EXIT_SUCCESS;
 }
 string format_bytes(unsigned long bytes) {
@@ -416,12 +573,12 @@ double calculate_cpu_percent(unsigned long cpu_ns, time_t start_time) {
     return percent;
 }
 void display_compact_monitor() {
-    int count;
-    container_info_t **containers = container_manager_list(&cm, &count);
-    vector<container_info_t*> active_containers;
-    for (int i = 0; i < count; i++) {
-        if (containers[i]->state != CONTAINER_DESTROYED) {
-            active_containers.push_back(containers[i]);
+    uint64_t ticket;
+    const container_snapshot_t *snapshot = container_manager_snapshot_acquire(&cm, &ticket);
+    vector<const container_view_t*> active_containers;
+    for (int i = 0; snapshot && i < snapshot->count; i++) {
+        if (snapshot->containers[i].state != CONTAINER_DESTROYED) {
+            active_containers.push_back(&snapshot->containers[i]);
         }
     }
     int running_count = 0;
@@ -466,19 +623,19 @@ void display_compact_monitor() {
         printf("No containers\n");
         reset_color();
     } else {
-        vector<container_info_t*> sorted_containers;
+        vector<const container_view_t*> sorted_containers;
         for (size_t i = 0; i < active_containers.size(); i++) {
             sorted_containers.push_back(active_containers[i]);
         }
         sort(sorted_containers.begin(), sorted_containers.end(),
-             [](container_info_t* a, container_info_t* b) {
+             [](const container_view_t* a, const container_view_t* b) {
                  if (a->state == CONTAINER_RUNNING && b->state != CONTAINER_RUNNING) return true;
                  if (a->state != CONTAINER_RUNNING && b->state == CONTAINER_RUNNING) return false;
                  return a->started_at > b->started_at;
              });
         int max_display = (sorted_containers.size() > 10) ? 10 : sorted_containers.size();
         for (int i = 0; i < max_display; i++) {
-            container_info_t* info = sorted_containers[i];
+            const container_view_t* info = sorted_containers[i];
             const char* state = safe_state_name(info->state);
             const char* state_color = COLOR_WHITE;
             if (info->state == CONTAINER_RUNNING) {
@@ -487,6 +644,8 @@ void display_compact_monitor() {
                 state_color = COLOR_RED;
             } else if (info->state == CONTAINER_CREATED) {
                 state_color = COLOR_YELLOW;
+            } else if (info->state == CONTAINER_PAUSED) {
+                state_color = COLOR_CYAN;
             }
             printf("%-20s %-8d ", info->id, info->pid);
             set_color(state_color);
@@ -512,9 +671,70 @@ void display_compact_monitor() {
             reset_color();
         }
     }
+    container_manager_snapshot_release(&cm, ticket);
     printf("\n");
 }
+static void *forward_events(void *arg) {
+    (void)arg;
+    event_cursor_t cursor;
+    event_bus_subscribe(cm.events, &cursor);
+    container_event_t events[16];
+    while (event_watcher_running) {
+        if (event_bus_wait(cm.events, &cursor, events, 16, 500) > 0) {
+            char byte = 1;
+            if (write(event_pipe[1], &byte, 1) < 0 && errno != EAGAIN) {
+                break;
+            }
+        }
+    }
+    return nullptr;
+}
+static bool start_event_watcher() {
+    if (event_watcher_running || pipe2(event_pipe, O_CLOEXEC | O_NONBLOCK) != 0) {
+        return false;
+    }
+    event_watcher_running = true;
+    if (pthread_create(&event_watcher, nullptr, forward_events, nullptr) != 0) {
+        event_watcher_running = false;
+        close(event_pipe[0]);
+        close(event_pipe[1]);
+        event_pipe[0] = event_pipe[1] = -1;
+        return false;
+    }
+    return true;
+}
+static void stop_event_watcher() {
+    if (!event_watcher_running) return;
+    event_watcher_running = false;
+    pthread_join(event_watcher, nullptr);
+    close(event_pipe[0]);
+    close(event_pipe[1]);
+    event_pipe[0] = event_pipe[1] = -1;
+}
+static bool wait_for_key_or_event(int timeout_sec) {
+    fd_set readfds;
+    FD_ZERO(&readfds);
+    FD_SET(STDIN_FILENO, &readfds);
+    int max_fd = STDIN_FILENO;
+    if (event_pipe[0] != -1) {
+        FD_SET(event_pipe[0], &readfds);
+        max_fd = max(max_fd, event_pipe[0]);
+    }
+    struct timeval timeout;
+    timeout.tv_sec = timeout_sec;
+    timeout.tv_usec = 0;
+    if (select(max_fd + 1, &readfds, nullptr, nullptr, &timeout) <= 0) {
+        return false;
+    }
+    if (event_pipe[0] != -1 && FD_ISSET(event_pipe[0], &readfds)) {
+        char drain[64];
+        while (read(event_pipe[0], drain, sizeof(drain)) > 0) {
+        }
+    }
+    return FD_ISSET(STDIN_FILENO, &readfds);
+}
 void display_monitor() {
+    bool own_watcher = start_event_watcher();
     clear_screen();
     hide_cursor();
     while (monitor_mode && running) {
@@ -523,12 +743,12 @@ void display_monitor() {
         set_color(COLOR_CYAN);
         printf("Mini Container Monitor (htop-like)\n");
         reset_color();
-        int count;
-        container_info_t **containers = container_manager_list(&cm, &count);
-    vector<container_info_t*> active_containers;
-    for (int i = 0; i < count; i++) {
-        if (containers[i]->state != CONTAINER_DESTROYED) {
-            active_containers.push_back(containers[i]);
+        uint64_t ticket;
+        const container_snapshot_t *snapshot = container_manager_snapshot_acquire(&cm, &ticket);
+    vector<const container_view_t*> active_containers;
+    for (int i = 0; snapshot && i < snapshot->count; i++) {
+        if (snapshot->containers[i].state != CONTAINER_DESTROYED) {
+            active_containers.push_back(&snapshot->containers[i]);
         }
     }
     int running_count = 0;
@@ -554,12 +774,12 @@ void display_monitor() {
             printf("No containers\n");
             reset_color();
         } else {
-            vector<container_info_t*> sorted_containers;
+            vector<const container_view_t*> sorted_containers;
             for (size_t i = 0; i < active_containers.size(); i++) {
                 sorted_containers.push_back(active_containers[i]);
             }
             sort(sorted_containers.begin(), sorted_containers.end(),
-                 [](container_info_t* a, container_info_t* b) {
+                 [](const container_view_t* a, const container_view_t* b) {
                      if (a->state == CONTAINER_RUNNING && b->state != CONTAINER_RUNNING) return true;
                      if (a->state != CONTAINER_RUNNING && b->state == CONTAINER_RUNNING) return false;
                      return a->started_at > b->started_at;
@@ -573,6 +793,8 @@ void display_monitor() {
                     state_color = COLOR_RED;
                 } else if (info->state == CONTAINER_CREATED) {
                     state_color = COLOR_YELLOW;
+                } else if (info->state == CONTAINER_PAUSED) {
+                    state_color = COLOR_CYAN;
                 }
                 printf("%-20s %-8d ", info->id, info->pid);
                 set_color(state_color);
@@ -599,6 +821,7 @@ void display_monitor() {
                 printf(" %-10s\n", created_str);
             }
         }
+        container_manager_snapshot_release(&cm, ticket);
         printf("\n");
         set_color(COLOR_CYAN);
         printf("Press 'q' to quit monitor, 'r' to refresh\n");
@@ -612,14 +835,17 @@ void display_monitor() {
         new_term.c_cc[VTIME] = 0;
         tcsetattr(STDIN_FILENO, TCSANOW, &new_term);
         char c;
-        if (read(STDIN_FILENO, &c, 1) > 0) {
+        if (wait_for_key_or_event(5) && read(STDIN_FILENO, &c, 1) > 0) {
             if (c == 'q' || c == 'Q') {
                 monitor_mode = false;
+                tcsetattr(STDIN_FILENO, TCSANOW, &old_term);
                 break;
             }
         }
         tcsetattr(STDIN_FILENO, TCSANOW, &old_term);
-        usleep(5000000); 
+    }
+    if (own_watcher) {
+        stop_event_watcher();
     }
     show_cursor();
     clear_screen();
@@ -1005,8 +1231,8 @@ void run_memory_cpu_test() {
     printf("  Total Memory: %s\n", format_bytes(total_memory).c_str());
     printf("  CPU Cores: %d\n", cpu_count);
     printf("\nCreating test containers...\n");
-    DEBUG_LOG("Starting memory/CPU test");
-    DEBUG_LOG("Total memory: %lu bytes, CPU cores: %d", total_memory, cpu_count);
+    LOG_DEBUG("Starting memory/CPU test");
+    LOG_DEBUG("Total memory: %lu bytes, CPU cores: %d", total_memory, cpu_count);
     unsigned long memory_fractions[] = {
         total_memory / 16,
         total_memory / 8,
@@ -1019,72 +1245,72 @@ void run_memory_cpu_test() {
         25000
     };
     for (int i = 0; i < 3; i++) {
-        DEBUG_LOG("Creating memory container %d", i + 1);
+        LOG_DEBUG("Creating memory container %d", i + 1);
         container_config_t config;
-        DEBUG_LOG("Initializing config structures");
+        LOG_DEBUG("Initializing config structures");
         namespace_config_init(&config.ns_config);
-        DEBUG_LOG("namespace_config_init done");
+        LOG_DEBUG("namespace_config_init done");
         resource_limits_init(&config.res_limits);
-        DEBUG_LOG("resource_limits_init done");
+        LOG_DEBUG("resource_limits_init done");
         fs_config_init(&config.fs_config);
-        DEBUG_LOG("fs_config_init done, fs_config.root_path=%p", (void*)config.fs_config.root_path);
+        LOG_DEBUG("fs_config_init done, fs_config.root_path=%p", (void*)config.fs_config.root_path);
         char container_id[64];
         snprintf(container_id, sizeof(container_id), "C%dMEM", i + 1);
-        DEBUG_LOG("Container ID: %s", container_id);
+        LOG_DEBUG("Container ID: %s", container_id);
         config.id = strdup(container_id);
         if (!config.id) {
-            ERROR_LOG("strdup failed for container_id");
+            LOG_ERROR("strdup failed for container_id");
             perror("strdup failed");
             continue;
         }
-        DEBUG_LOG("config.id set to: %s", config.id);
+        LOG_DEBUG("config.id set to: %s", config.id);
         config.res_limits.memory.limit_bytes = memory_fractions[i];
         config.res_limits.cpu.shares = 1024;
         char root_path[256];
         snprintf(root_path, sizeof(root_path), "/tmp/mini_container_test_%s", container_id);
-        DEBUG_LOG("About to strdup fs_config.root_path: %s", root_path);
+        LOG_DEBUG("About to strdup fs_config.root_path: %s", root_path);
         config.fs_config.root_path = strdup(root_path);
-        DEBUG_LOG("strdup done, fs_config.root_path=%p", (void*)config.fs_config.root_path);
+        LOG_DEBUG("strdup done, fs_config.root_path=%p", (void*)config.fs_config.root_path);
         if (!config.fs_config.root_path) {
-            ERROR_LOG("strdup failed for fs_config.root_path");
+            LOG_ERROR("strdup failed for fs_config.root_path");
             perror("strdup failed");
             free(config.id);
             continue;
         }
-        DEBUG_LOG("fs_config.root_path set to: %s", config.fs_config.root_path);
+        LOG_DEBUG("fs_config.root_path set to: %s", config.fs_config.root_path);
         config.fs_config.create_minimal_fs = 1;
-        DEBUG_LOG("fs_config.create_minimal_fs set to: %d", config.fs_config.create_minimal_fs);
-        DEBUG_LOG("About to prepare cmd_buffer");
+        LOG_DEBUG("fs_config.create_minimal_fs set to: %d", config.fs_config.create_minimal_fs);
+        LOG_DEBUG("About to prepare cmd_buffer");
         char cmd_buffer[512];
         snprintf(cmd_buffer, sizeof(cmd_buffer),
                  "python3 -c 'import time; data = [bytearray(%lu) for _ in range(1)]; time.sleep(3600)'",
                  memory_fractions[i] / 2);
-        DEBUG_LOG("cmd_buffer prepared: %s", cmd_buffer);
-        DEBUG_LOG("About to allocate command array");
+        LOG_DEBUG("cmd_buffer prepared: %s", cmd_buffer);
+        LOG_DEBUG("About to allocate command array");
         char **command = static_cast<char**>(calloc(4, sizeof(char*)));
         if (!command) {
-            ERROR_LOG("calloc failed for command array");
+            LOG_ERROR("calloc failed for command array");
             perror("calloc failed");
             free(config.id);
             free(config.fs_config.root_path);
             continue;
         }
-        DEBUG_LOG("command array allocated: %p", (void*)command);
-        DEBUG_LOG("About to strdup /bin/sh");
+        LOG_DEBUG("command array allocated: %p", (void*)command);
+        LOG_DEBUG("About to strdup /bin/sh");
         command[0] = strdup("/bin/sh");
         if (!command[0]) {
-            ERROR_LOG("strdup failed for /bin/sh");
+            LOG_ERROR("strdup failed for /bin/sh");
             perror("strdup failed");
             free(command);
             free(config.id);
             free(config.fs_config.root_path);
             continue;
         }
-        DEBUG_LOG("command[0] set to: %s", command[0]);
-        DEBUG_LOG("About to strdup -c");
+        LOG_DEBUG("command[0] set to: %s", command[0]);
+        LOG_DEBUG("About to strdup -c");
         command[1] = strdup("-c");
         if (!command[1]) {
-            ERROR_LOG("strdup failed for -c");
+            LOG_ERROR("strdup failed for -c");
             perror("strdup failed");
             free(command[0]);
             free(command);
@@ -1092,11 +1318,11 @@ void run_memory_cpu_test() {
             free(config.fs_config.root_path);
             continue;
         }
-        DEBUG_LOG("command[1] set to: %s", command[1]);
-        DEBUG_LOG("About to strdup cmd_buffer");
+        LOG_DEBUG("command[1] set to: %s", command[1]);
+        LOG_DEBUG("About to strdup cmd_buffer");
         command[2] = strdup(cmd_buffer);
         if (!command[2]) {
-            ERROR_LOG("strdup failed for cmd_buffer");
+            LOG_ERROR("strdup failed for cmd_buffer");
             perror("strdup failed");
             free(command[0]);
             free(command[1]);
@@ -1105,23 +1331,21 @@ void run_memory_cpu_test() {
             free(config.fs_config.root_path);
             continue;
         }
-        DEBUG_LOG("command[2] set to: %s", command[2]);
+        LOG_DEBUG("command[2] set to: %s", command[2]);
         command[3] = nullptr;
-        DEBUG_LOG("Setting config.command and config.command_argc");
+        LOG_DEBUG("Setting config.command and config.command_argc");
         config.command = command;
         config.command_argc = 3;
-        DEBUG_LOG("config.command=%p, config.command_argc=%d", (void*)config.command, config.command_argc);
-        DEBUG_LOG("config.fs_config.root_path before call: %p (%s)", 
+        LOG_DEBUG("config.command=%p, config.command_argc=%d", (void*)config.command, config.command_argc);
+        LOG_DEBUG("config.fs_config.root_path before call: %p (%s)", 
                   (void*)config.fs_config.root_path, 
                   config.fs_config.root_path ? config.fs_config.root_path : "NULL");
-        DEBUG_LOG("config.fs_config.method: %d", config.fs_config.method);
-        DEBUG_LOG("config.fs_config.create_minimal_fs: %d", config.fs_config.create_minimal_fs);
-        DEBUG_LOG("About to call container_manager_run, config address: %p", (void*)&config);
-        DEBUG_LOG("config.fs_config address: %p", (void*)&config.fs_config);
-        DEBUG_LOG("config.fs_config.root_path address: %p", (void*)&config.fs_config.root_path);
-        fflush(stderr);
-        DEBUG_LOG("Calling container_manager_run");
-        fflush(stderr);
+        LOG_DEBUG("config.fs_config.method: %d", config.fs_config.method);
+        LOG_DEBUG("config.fs_config.create_minimal_fs: %d", config.fs_config.create_minimal_fs);
+        LOG_DEBUG("About to call container_manager_run, config address: %p", (void*)&config);
+        LOG_DEBUG("config.fs_config address: %p", (void*)&config.fs_config);
+        LOG_DEBUG("config.fs_config.root_path address: %p", (void*)&config.fs_config.root_path);
+        LOG_DEBUG("Calling container_manager_run");
         if (container_manager_run(&cm, &config) == 0) {
             set_color(COLOR_GREEN);
             printf("  ✓ Created %s with memory limit: %s\n", container_id, format_bytes(memory_fractions[i]).c_str());
@@ -1149,16 +1373,16 @@ void run_memory_cpu_test() {
             config.fs_config.root_path = nullptr;
         }
     }
-    DEBUG_LOG("Starting CPU containers creation");
+    LOG_DEBUG("Starting CPU containers creation");
     for (int i = 0; i < 3; i++) {
-        DEBUG_LOG("Creating CPU container %d", i + 1);
+        LOG_DEBUG("Creating CPU container %d", i + 1);
         container_config_t config;
         namespace_config_init(&config.ns_config);
         resource_limits_init(&config.res_limits);
         fs_config_init(&config.fs_config);
         char container_id[64];
         snprintf(container_id, sizeof(container_id), "C%dCPU", i + 1);
-        DEBUG_LOG("Container ID: %s", container_id);
+        LOG_DEBUG("Container ID: %s", container_id);
         config.id = strdup(container_id);
         if (!config.id) {
             perror("strdup failed");
@@ -1214,13 +1438,13 @@ void run_memory_cpu_test() {
         command[3] = nullptr;
         config.command = command;
         config.command_argc = 3;
-        DEBUG_LOG("CPU Command array allocated: %p, argc: %d", (void*)command, config.command_argc);
-        DEBUG_LOG("CPU Command[0]: %s", command[0] ? command[0] : "NULL");
-        DEBUG_LOG("CPU Command[1]: %s", command[1] ? command[1] : "NULL");
-        DEBUG_LOG("CPU Command[2]: %s", command[2] ? command[2] : "NULL");
-        DEBUG_LOG("Calling container_manager_run for CPU container %s", container_id);
+        LOG_DEBUG("CPU Command array allocated: %p, argc: %d", (void*)command, config.command_argc);
+        LOG_DEBUG("CPU Command[0]: %s", command[0] ? command[0] : "NULL");
+        LOG_DEBUG("CPU Command[1]: %s", command[1] ? command[1] : "NULL");
+        LOG_DEBUG("CPU Command[2]: %s", command[2] ? command[2] : "NULL");
+        LOG_DEBUG("Calling container_manager_run for CPU container %s", container_id);
         if (container_manager_run(&cm, &config) == 0) {
-            DEBUG_LOG("container_manager_run succeeded for CPU container %s", container_id);
+            LOG_DEBUG("container_manager_run succeeded for CPU container %s", container_id);
             set_color(COLOR_GREEN);
             double cpu_percent = (cpu_quotas[i] * 100.0) / cpu_period_us;
             printf("  ✓ Created %s with CPU limit: %.2f%% (quota: %d, period: %d)\n",
@@ -1228,12 +1452,12 @@ void run_memory_cpu_test() {
             reset_color();
             usleep(100000);
         } else {
-            ERROR_LOG("container_manager_run failed for CPU container %s", container_id);
+            LOG_ERROR("container_manager_run failed for CPU container %s", container_id);
             set_color(COLOR_RED);
             printf("  ✗ Failed to create %s\n", container_id);
             reset_color();
         }
-        DEBUG_LOG("Freeing CPU command array for %s", container_id);
+        LOG_DEBUG("Freeing CPU command array for %s", container_id);
         if (command) {
             for (int j = 0; j < 3; j++) {
                 if (command[j]) {
@@ -1531,6 +1755,7 @@ void signal_handler(int signum) {
     (void)signum;
     running = false;
     monitor_mode = false;
+    stop_event_watcher();
     show_cursor();
     printf("\n\n");
     set_color(COLOR_YELLOW);
@@ -1538,60 +1763,13 @@ void signal_handler(int signum) {
     reset_color();
     int count;
     container_info_t** containers = container_manager_list(&cm, &count);
+    std::vector<const char*> running_ids;
     for (int i = 0; i < count; i++) {
-        if (containers[i]->state == CONTAINER_RUNNING) {
-            char cgroup_procs_path[512];
-            if (cm.rm->version == CGROUP_V2) {
-                snprintf(cgroup_procs_path, sizeof(cgroup_procs_path), 
-                         "/sys/fs/cgroup/%s_%s/cgroup.procs", cm.rm->cgroup_path, containers[i]->id);
-            } else {
-                snprintf(cgroup_procs_path, sizeof(cgroup_procs_path), 
-                         "/sys/fs/cgroup/cpu,cpuacct/%s_%s/tasks", cm.rm->cgroup_path, containers[i]->id);
-            }
-            FILE *fp = fopen(cgroup_procs_path, "r");
-            if (fp) {
-                pid_t pid;
-                while (fscanf(fp, "%d", &pid) == 1) {
-                    if (pid > 0) {
-                        kill(pid, SIGTERM);
-                    }
-                }
-                fclose(fp);
-            }
-        }
-    }
-    usleep(500000);
-    for (int i = 0; i < count; i++) {
-        if (containers[i]->state == CONTAINER_RUNNING) {
-            container_manager_stop(&cm, containers[i]->id);
-        }
-    }
-    sleep(1);
-    for (int i = 0; i < count; i++) {
-        if (containers[i]->state == CONTAINER_RUNNING || containers[i]->pid > 0) {
-        char cgroup_procs_path[512];
-        if (cm.rm->version == CGROUP_V2) {
-            snprintf(cgroup_procs_path, sizeof(cgroup_procs_path), 
-                     "/sys/fs/cgroup/%s_%s/cgroup.procs", cm.rm->cgroup_path, containers[i]->id);
-        } else {
-            snprintf(cgroup_procs_path, sizeof(cgroup_procs_path), 
-                     "/sys/fs/cgroup/cpu,cpuacct/%s_%s/tasks", cm.rm->cgroup_path, containers[i]->id);
-        }
-        FILE *fp = fopen(cgroup_procs_path, "r");
-        if (fp) {
-            pid_t pid;
-            while (fscanf(fp, "%d", &pid) == 1) {
-                if (pid > 0) {
-                    kill(pid, SIGKILL);
-                }
-            }
-            fclose(fp);
-        }
-            if (containers[i]->state == CONTAINER_RUNNING) {
-                container_manager_stop(&cm, containers[i]->id);
-            }
+        if (containers[i]->state == CONTAINER_RUNNING || containers[i]->state == CONTAINER_PAUSED) {
+            running_ids.push_back(containers[i]->id);
         }
     }
+    container_manager_stop_many(&cm, running_ids.data(), (int)running_ids.size(), -1, nullptr, nullptr, nullptr);
     containers = container_manager_list(&cm, &count);
     for (int i = 0; i < count; i++) {
         if (containers[i]->state == CONTAINER_CREATED || containers[i]->state == CONTAINER_RUNNING) {
@@ -1621,6 +1799,7 @@ void interactive_menu() {
     new_term.c_lflag &= ~(ICANON | ECHO);
     new_term.c_cc[VMIN] = 0;
     new_term.c_cc[VTIME] = 0;
+    start_event_watcher();
     hide_cursor();
     while (running) {
         clear_screen();
@@ -1635,19 +1814,12 @@ void interactive_menu() {
         printf("0. Exit\n");
         printf("\n");
         set_color(COLOR_YELLOW);
-        printf("Select option (auto-refresh every 5 seconds): ");
+        printf("Select option (refreshes on container events): ");
         reset_color();
         fflush(stdout);
         tcsetattr(STDIN_FILENO, TCSANOW, &new_term);
         char choice = 0;
-        fd_set readfds;
-        struct timeval timeout;
-        FD_ZERO(&readfds);
-        FD_SET(STDIN_FILENO, &readfds);
-        timeout.tv_sec = 5;
-        timeout.tv_usec = 0;
-        int select_result = select(STDIN_FILENO + 1, &readfds, nullptr, nullptr, &timeout);
-        if (select_result > 0 && FD_ISSET(STDIN_FILENO, &readfds)) {
+        if (wait_for_key_or_event(5)) {
             if (read(STDIN_FILENO, &choice, 1) > 0) {
                 int option = choice - '0';
                 tcsetattr(STDIN_FILENO, TCSANOW, &old_term);
@@ -1796,6 +1968,10 @@ void interactive_menu() {
                                     printf("Options:\n");
                                     if (info->state == CONTAINER_RUNNING) {
                                         printf("1. Stop Container\n");
+                                        printf("2. Pause Container\n");
+                                    } else if (info->state == CONTAINER_PAUSED) {
+                                        printf("1. Stop Container\n");
+                                        printf("2. Resume Container\n");
                                     } else if (info->state == CONTAINER_STOPPED) {
                                         printf("1. Start Container\n");
                                     }
@@ -1805,8 +1981,13 @@ void interactive_menu() {
                                     char option[10];
                                     if (fgets(option, sizeof(option), stdin)) {
                                         int opt = atoi(option);
+                                        if (opt == 2 && (info->state == CONTAINER_RUNNING || info->state == CONTAINER_PAUSED)) {
+                                            char cmd_toggle[] = "pause";
+                                            char* argv[] = {cmd_toggle, start, nullptr};
+                                            handle_pause_resume(2, argv, info->state == CONTAINER_RUNNING);
+                                        }
                                         if (opt == 1) {
-                                            if (info->state == CONTAINER_RUNNING) {
+                                            if (info->state == CONTAINER_RUNNING || info->state == CONTAINER_PAUSED) {
                                                 char cmd_stop[] = "stop";
                                                 char* argv[] = {cmd_stop, start, nullptr};
                                                 handle_stop(2, argv);
@@ -1908,11 +2089,395 @@ void interactive_menu() {
             }
         }
     }
+    stop_event_watcher();
     tcsetattr(STDIN_FILENO, TCSANOW, &old_term);
     show_cursor();
 }
+static volatile sig_atomic_t client_interrupted = 0;
+static void client_signal_handler(int signum)
+{
+    (void)signum;
+    client_interrupted = 1;
+}
+static int daemon_call(int fd, uint16_t op, const control_buffer_t *request, const int *fds, int fd_count,
+                       control_buffer_t *reply, int *status)
+{
+    control_header_t header;
+    if (control_send(fd, op, 0, request, fds, fd_count) != 0 ||
+        control_recv(fd, &header, reply, nullptr, nullptr) != 0)
+    {
+        if (errno != EINTR)
+        {
+            fprintf(stderr, "Error: lost connection to mini-containerd\n");
+        }
+        return -1;
+    }
+    *status = header.status;
+    return 0;
+}
+static void read_view(control_buffer_t *reply, container_view_t *view)
+{
+    memset(view, 0, sizeof(*view));
+    strncpy(view->id, control_get_string(reply), CONTAINER_VIEW_ID_MAX - 1);
+    view->pid = (pid_t)control_get_u32(reply);
+    view->state = (container_state_t)control_get_u32(reply);
+    view->created_at = (time_t)control_get_u64(reply);
+    view->started_at = (time_t)control_get_u64(reply);
+    view->stopped_at = (time_t)control_get_u64(reply);
+}
+static int client_batch(int fd, uint16_t op, uint32_t timeout_ms, int count, char *ids[], const batch_verbs *verbs)
+{
+    control_buffer_t request, reply;
+    control_buffer_init(&request);
+    control_buffer_init(&reply);
+    control_put_u32(&request, timeout_ms);
+    control_put_u32(&request, (uint32_t)count);
+    for (int i = 0; i < count; i++)
+    {
+        control_put_string(&request, ids[i]);
+    }
+    int status = -1;
+    int result = EXIT_FAILURE;
+    if (daemon_call(fd, op, &request, nullptr, 0, &reply, &status) == 0)
+    {
+        if (status < 0)
+        {
+            fprintf(stderr, "Error: %s\n", control_get_string(&reply));
+        }
+        else
+        {
+            uint32_t n = control_get_u32(&reply);
+            if (n == 0 && count == 0)
+            {
+                printf("No running containers\n");
+            }
+            for (uint32_t i = 0; i < n && !reply.failed; i++)
+            {
+                const char *container_id = control_get_string(&reply);
+                int item = (int)control_get_u32(&reply);
+                report_batch_item(container_id, item, const_cast<batch_verbs*>(verbs));
+            }
+            result = status == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    control_buffer_free(&request);
+    control_buffer_free(&reply);
+    return result;
+}
+static int client_wait(int fd, const char *container_id)
+{
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = client_signal_handler;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, nullptr);
+    sigaction(SIGTERM, &sa, nullptr);
+    control_buffer_t request, reply;
+    control_buffer_init(&request);
+    control_buffer_init(&reply);
+    int status = 1;
+    int wait_status = 0;
+    while (status == 1 && !client_interrupted)
+    {
+        control_buffer_reset(&request);
+        control_put_string(&request, container_id);
+        control_put_u32(&request, 500);
+        if (daemon_call(fd, CONTROL_OP_WAIT, &request, nullptr, 0, &reply, &status) != 0)
+        {
+            status = -1;
+            break;
+        }
+        if (status == 0)
+        {
+            wait_status = (int)control_get_u32(&reply);
+        }
+    }
+    control_buffer_free(&request);
+    control_buffer_free(&reply);
+    if (client_interrupted)
+    {
+        int stop_fd = control_connect();
+        if (stop_fd != -1)
+        {
+            char *ids[] = { const_cast<char*>(container_id) };
+            batch_verbs verbs = { "stop", "stopped" };
+            client_batch(stop_fd, CONTROL_OP_STOP, 0, 1, ids, &verbs);
+            close(stop_fd);
+        }
+        return 130;
+    }
+    if (status != 0)
+    {
+        return EXIT_FAILURE;
+    }
+    if (WIFEXITED(wait_status))
+    {
+        return WEXITSTATUS(wait_status);
+    }
+    if (WIFSIGNALED(wait_status))
+    {
+        return 128 + WTERMSIG(wait_status);
+    }
+    return EXIT_SUCCESS;
+}
+static int client_run(int fd, int argc, char *argv[])
+{
+    container_config_t config;
+    memset(&config, 0, sizeof(config));
+    int detach = 0;
+    if (parse_run_options(argc, argv, &config, &detach) != 0)
+    {
+        return EXIT_FAILURE;
+    }
+    control_buffer_t request, reply;
+    control_buffer_init(&request);
+    control_buffer_init(&reply);
+    uint32_t flags = detach ? CONTROL_RUN_DETACH : CONTROL_RUN_ATTACH_STDIO;
+    if (config.ns_config.flags & NS_NET) {
+        flags |= CONTROL_RUN_NET;
+    }
+    if (config.ns_config.flags & NS_USER) {
+        flags |= CONTROL_RUN_USERNS;
+    }
+    if (config.fs_config.method == FS_BIND_RO) {
+        flags |= CONTROL_RUN_BIND_RO;
+    }
+    if (config.fs_config.method == FS_OVERLAY) {
+        flags |= CONTROL_RUN_OVERLAY;
+    }
+    if (config.fs_config.create_minimal_fs) {
+        flags |= CONTROL_RUN_MINIMAL;
+    }
+    control_put_u32(&request, flags);
+    control_put_u64(&request, (uint64_t)config.res_limits.memory.limit_bytes);
+    control_put_u32(&request, (uint32_t)config.res_limits.cpu.shares);
+    control_put_string(&request, config.fs_config.root_path ? config.fs_config.root_path : "");
+    control_put_string(&request, "");
+    control_put_u32(&request, (uint32_t)(argc - optind));
+    for (int i = optind; i < argc; i++)
+    {
+        control_put_string(&request, argv[i]);
+    }
+    if (config.fs_config.method == FS_OVERLAY)
+    {
+        control_put_string(&request, config.fs_config.lower_dirs);
+    }
+    int stdio_fds[3] = { STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO };
+    int status = -1;
+    int result = EXIT_FAILURE;
+    if (daemon_call(fd, CONTROL_OP_RUN, &request, detach ? nullptr : stdio_fds, detach ? 0 : 3,
+                    &reply, &status) == 0)
+    {
+        if (status != 0)
+        {
+            fprintf(stderr, "Failed to run container: %s\n", control_get_string(&reply));
+        }
+        else
+        {
+            string container_id = control_get_string(&reply);
+            pid_t pid = (pid_t)control_get_u32(&reply);
+            if (detach)
+            {
+                printf("Container %s started (PID %d)\n", container_id.c_str(), pid);
+                result = EXIT_SUCCESS;
+            }
+            else
+            {
+                result = client_wait(fd, container_id.c_str());
+            }
+        }
+    }
+    control_buffer_free(&request);
+    control_buffer_free(&reply);
+    free(config.fs_config.root_path);
+    return result;
+}
+static int client_stop(int fd, int argc, char *argv[])
+{
+    int arg = 1;
+    uint32_t timeout_ms = 0;
+    if (argc > 2 && strcmp(argv[1], "-t") == 0)
+    {
+        timeout_ms = (uint32_t)atoi(argv[2]) * 1000;
+        arg = 3;
+    }
+    if (argc <= arg)
+    {
+        fprintf(stderr, "Error: container ID required\n");
+        return EXIT_FAILURE;
+    }
+    batch_verbs verbs = { "stop", "stopped" };
+    if (strcmp(argv[arg], "--all") == 0)
+    {
+        return client_batch(fd, CONTROL_OP_STOP, timeout_ms, 0, nullptr, &verbs);
+    }
+    return client_batch(fd, CONTROL_OP_STOP, timeout_ms, argc - arg, argv + arg, &verbs);
+}
+static int client_list(int fd)
+{
+    control_buffer_t reply;
+    control_buffer_init(&reply);
+    int status = -1;
+    int result = EXIT_FAILURE;
+    if (daemon_call(fd, CONTROL_OP_LIST, nullptr, nullptr, 0, &reply, &status) == 0 && status == 0)
+    {
+        uint32_t count = control_get_u32(&reply);
+        vector<container_view_t> views;
+        for (uint32_t i = 0; i < count && !reply.failed; i++)
+        {
+            container_view_t view;
+            read_view(&reply, &view);
+            views.push_back(view);
+        }
+        print_container_table(views);
+        result = EXIT_SUCCESS;
+    }
+    control_buffer_free(&reply);
+    return result;
+}
+static int client_info(int fd, const char *container_id, container_view_t *view, bool print)
+{
+    control_buffer_t request, reply;
+    control_buffer_init(&request);
+    control_buffer_init(&reply);
+    control_put_string(&request, container_id);
+    int status = -1;
+    int result = EXIT_FAILURE;
+    if (daemon_call(fd, CONTROL_OP_INFO, &request, nullptr, 0, &reply, &status) == 0)
+    {
+        if (status != 0)
+        {
+            fprintf(stderr, "Container %s not found\n", container_id);
+        }
+        else
+        {
+            read_view(&reply, view);
+            unsigned long cpu_usage = (unsigned long)control_get_u64(&reply);
+            unsigned long memory_usage = (unsigned long)control_get_u64(&reply);
+            view->start_trace.pooled = (int32_t)control_get_u32(&reply);
+            for (int i = 0; i < START_PHASE_COUNT; i++)
+            {
+                view->start_trace.phase_ns[i] = control_get_u64(&reply);
+            }
+            bool overlay = control_get_u32(&reply) != 0;
+            long long upper_usage = (long long)control_get_u64(&reply);
+            if (print)
+            {
+                print_container_details(view, cpu_usage, memory_usage, overlay ? upper_usage : -1);
+            }
+            result = EXIT_SUCCESS;
+        }
+    }
+    control_buffer_free(&request);
+    control_buffer_free(&reply);
+    return result;
+}
+static int client_exec(int fd, int argc, char *argv[])
+{
+    if (argc < 3)
+    {
+        fprintf(stderr, "Error: container ID and command required\n");
+        return EXIT_FAILURE;
+    }
+    control_buffer_t request, reply;
+    control_buffer_init(&request);
+    control_buffer_init(&reply);
+    control_put_string(&request, argv[1]);
+    control_put_u32(&request, (uint32_t)(argc - 2));
+    for (int i = 2; i < argc; i++)
+    {
+        control_put_string(&request, argv[i]);
+    }
+    int stdio_fds[3] = { STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO };
+    int status = -1;
+    int result = EXIT_FAILURE;
+    if (daemon_call(fd, CONTROL_OP_EXEC, &request, stdio_fds, 3, &reply, &status) == 0)
+    {
+        if (status != 0)
+        {
+            fprintf(stderr, "Failed to exec in container %s: %s\n", argv[1], control_get_string(&reply));
+        }
+        else
+        {
+            int wait_status = (int)control_get_u32(&reply);
+            result = WIFSIGNALED(wait_status) ? 128 + WTERMSIG(wait_status) : WEXITSTATUS(wait_status);
+        }
+    }
+    control_buffer_free(&request);
+    control_buffer_free(&reply);
+    return result;
+}
+static bool is_daemon_command(const char *command)
+{
+    static const char *commands[] = { "run", "start", "stop", "list", "exec", "destroy", "info", "pause", "resume" };
+    for (size_t i = 0; i < sizeof(commands) / sizeof(commands[0]); i++)
+    {
+        if (strcmp(command, commands[i]) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+static int handle_daemon_command(int fd, int argc, char *argv[])
+{
+    const char *command = argv[0];
+    if (strcmp(command, "run") == 0)
+    {
+        return client_run(fd, argc, argv);
+    }
+    if (strcmp(command, "stop") == 0)
+    {
+        return client_stop(fd, argc, argv);
+    }
+    if (strcmp(command, "list") == 0)
+    {
+        return client_list(fd);
+    }
+    if (strcmp(command, "exec") == 0)
+    {
+        return client_exec(fd, argc, argv);
+    }
+    if (argc < 2)
+    {
+        fprintf(stderr, "Error: container ID required\n");
+        return EXIT_FAILURE;
+    }
+    if (strcmp(command, "info") == 0)
+    {
+        container_view_t view;
+        return client_info(fd, argv[1], &view, true);
+    }
+    if (strcmp(command, "start") == 0)
+    {
+        batch_verbs verbs = { "start", "started" };
+        return client_batch(fd, CONTROL_OP_START, 0, argc - 1, argv + 1, &verbs);
+    }
+    if (strcmp(command, "pause") == 0)
+    {
+        batch_verbs verbs = { "pause", "paused" };
+        return client_batch(fd, CONTROL_OP_PAUSE, 0, argc - 1, argv + 1, &verbs);
+    }
+    if (strcmp(command, "resume") == 0)
+    {
+        batch_verbs verbs = { "resume", "resumed" };
+        return client_batch(fd, CONTROL_OP_RESUME, 0, argc - 1, argv + 1, &verbs);
+    }
+    batch_verbs verbs = { "destroy", "destroyed" };
+    return client_batch(fd, CONTROL_OP_DESTROY, 0, argc - 1, argv + 1, &verbs);
+}
 int main(int argc, char *argv[])
 {
+    if (argc >= 2 && is_daemon_command(argv[1]))
+    {
+        int fd = control_connect();
+        if (fd != -1)
+        {
+            int result = handle_daemon_command(fd, argc - 1, &argv[1]);
+            close(fd);
+            return result;
+        }
+    }
     if (container_manager_init(&cm, 10000) != 0)
     {
         fprintf(stderr, "Failed to initialize container manager\n");
@@ -1922,6 +2487,10 @@ int main(int argc, char *argv[])
     {
         fprintf(stderr, "Warning: container operations typically require root privileges\n");
     }
+    if (getuid() == 0 && container_manager_enable_rootfs_cache(&cm, ROOTFS_CACHE_DEFAULT_BUDGET) != 0)
+    {
+        fprintf(stderr, "Warning: failed to open rootfs cache\n");
+    }
     web_server = new SimpleWebServer(&cm, 808);
     signal(SIGINT, signal_handler);
     signal(SIGTERM, signal_handler);
@@ -1962,6 +2531,10 @@ int main(int argc, char *argv[])
     {
         result = handle_destroy(argc - 1, &argv[1]);
     }
+    else if (strcmp(command, "pause") == 0 || strcmp(command, "resume") == 0)
+    {
+        result = handle_pause_resume(argc - 1, &argv[1], strcmp(command, "pause") == 0);
+    }
     else if (strcmp(command, "info") == 0)
     {
         result = handle_info(argc - 1, &argv[1]);
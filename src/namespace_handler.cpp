@@ -4,72 +4,358 @@
 #include <cerrno>
 #include <unistd.h>
 #include <sched.h>
+#include <csignal>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <sys/mount.h>
 #include <sys/wait.h>
+#include <sys/vfs.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <net/if.h>
+#include <grp.h>
+#include <linux/close_range.h>
+#include <linux/sched.h>
+#include <linux/magic.h>
+#include <climits>
+#include <ctime>
 #include <memory>
 #include "../include/namespace_handler.hpp"
+#include "../include/stack_pool.hpp"
+#include "../include/filesystem_manager.hpp"
 using namespace std;
 #define CHILD_STACK_SIZE (8 * 1024 * 1024)
+#define PARKED_CHANNEL_FD 3
+#define PARKED_ARGS_MAX (128 * 1024)
+#define PARKED_ARGV_MAX 4096
 typedef struct {
     namespace_config_t *config;
     char **command;
     int argc;
-    void (*add_to_cgroup_callback)(pid_t pid, void *user_data);
+    int (*add_to_cgroup_callback)(pid_t pid, void *user_data);
     void *cgroup_user_data;
+    const int *stdio_fds;
+    const namespace_fds_t *join;
+    int gate[2];
+    int trace_fd;
 } clone_args_t;
+typedef struct {
+    namespace_config_t *config;
+    int channel_fd;
+} parked_args_t;
+typedef struct {
+    const namespace_fds_t *fds;
+    const int *cgroup_fds;
+    int cgroup_fd_count;
+    char **command;
+    const int *stdio_fds;
+    volatile int error;
+} spawn_args_t;
+typedef struct {
+    int sys_fd;
+    int dev_fd;
+} mount_template_t;
+static const struct {
+    int type;
+    const char *name;
+} namespace_kinds[NAMESPACE_KIND_COUNT] = {
+    { CLONE_NEWPID, "pid" },
+    { CLONE_NEWNET, "net" },
+    { CLONE_NEWIPC, "ipc" },
+    { CLONE_NEWUTS, "uts" },
+    { CLONE_NEWCGROUP, "cgroup" },
+    { CLONE_NEWNS, "mnt" },
+    { CLONE_NEWUSER, "user" }
+};
+static int kind_index(int ns_type) {
+    for (int i = 0; i < NAMESPACE_KIND_COUNT; i++) {
+        if (namespace_kinds[i].type == ns_type) {
+            return i;
+        }
+    }
+    return -1;
+}
+static int join_namespaces(const namespace_fds_t *fds) {
+    if (!fds) return 0;
+    for (int i = 0; i < NAMESPACE_KIND_COUNT; i++) {
+        int type = namespace_kinds[i].type;
+        if (type == CLONE_NEWPID || type == CLONE_NEWUSER || fds->fds[i] < 0) {
+            continue;
+        }
+        if (setns(fds->fds[i], type) == -1) {
+            return -1;
+        }
+    }
+    return 0;
+}
+static int enter_late_namespaces(int flags, const namespace_fds_t *fds) {
+    if ((flags & CLONE_NEWCGROUP) && unshare(CLONE_NEWCGROUP) == -1) {
+        return -1;
+    }
+    int user_fd = namespace_fds_get(fds, CLONE_NEWUSER);
+    if (user_fd < 0) {
+        return 0;
+    }
+    if (setns(user_fd, CLONE_NEWUSER) == -1 || setgroups(0, nullptr) == -1 ||
+        setresgid(0, 0, 0) == -1 || setresuid(0, 0, 0) == -1) {
+        return -1;
+    }
+    return 0;
+}
 void namespace_config_init(namespace_config_t *config) {
     if (!config) return;
     config->flags = CONTAINER_NAMESPACES;
+    config->bind_root = nullptr;
+    config->enter_root = nullptr;
+    config->read_only_root = 0;
 }
-static int setup_container_filesystem(const namespace_config_t *config) {
-    (void)config;
-    if (mount(nullptr, "/", nullptr, MS_REC | MS_PRIVATE, nullptr) == -1) {
-        perror("mount propagation private failed");
+static int create_detached_mount(const char *source, const char *fstype, unsigned int attr) {
+    int fs = fsopen(fstype, FSOPEN_CLOEXEC);
+    if (fs == -1) {
         return -1;
     }
-    auto mount_or_ignore_ebusy = [](const char *source, const char *target,
-                                    const char *fstype, unsigned long flags) {
-        if (mount(source, target, fstype, flags, nullptr) == -1) {
-            if (errno == EBUSY) {
+    int fd = -1;
+    if (fsconfig(fs, FSCONFIG_SET_STRING, "source", source, 0) == 0 &&
+        fsconfig(fs, FSCONFIG_CMD_CREATE, nullptr, nullptr, 0) == 0) {
+        fd = fsmount(fs, FSMOUNT_CLOEXEC, attr);
+    }
+    close(fs);
+    return fd;
+}
+static int clone_detached_mount(int template_fd) {
+    return open_tree(template_fd, "", OPEN_TREE_CLONE | OPEN_TREE_CLOEXEC | AT_EMPTY_PATH);
+}
+static mount_template_t build_mount_template() {
+    mount_template_t tmpl;
+    tmpl.sys_fd = create_detached_mount("sysfs", "sysfs", MOUNT_ATTR_NOSUID | MOUNT_ATTR_NOEXEC | MOUNT_ATTR_NODEV);
+    tmpl.dev_fd = create_detached_mount("dev", "devtmpfs", 0);
+    int probe = clone_detached_mount(tmpl.sys_fd >= 0 ? tmpl.sys_fd : tmpl.dev_fd);
+    if (probe >= 0) {
+        close(probe);
+        return tmpl;
+    }
+    if (tmpl.sys_fd >= 0) close(tmpl.sys_fd);
+    if (tmpl.dev_fd >= 0) close(tmpl.dev_fd);
+    tmpl.sys_fd = -1;
+    tmpl.dev_fd = -1;
+    return tmpl;
+}
+static const mount_template_t *mount_template() {
+    static mount_template_t tmpl = build_mount_template();
+    return &tmpl;
+}
+static int attach_mount(int template_fd, const char *source, const char *target,
+                        const char *fstype, unsigned long flags) {
+    if (template_fd >= 0) {
+        int fd = clone_detached_mount(template_fd);
+        if (fd >= 0) {
+            int result = move_mount(fd, "", AT_FDCWD, target, MOVE_MOUNT_F_EMPTY_PATH);
+            close(fd);
+            if (result == 0) {
                 return 0;
             }
-            perror("mount failed");
-            return -1;
         }
-        return 0;
-    };
-    if (mount_or_ignore_ebusy("proc", "/proc", "proc", 0) == -1) {
+    }
+    if (mount(source, target, fstype, flags, nullptr) == -1) {
+        if (errno == EBUSY) {
+            return 0;
+        }
+        perror("mount failed");
+        return -1;
+    }
+    return 0;
+}
+static int setup_container_filesystem(const namespace_config_t *config) {
+    const mount_template_t *tmpl = mount_template();
+    if (mount(nullptr, "/", nullptr, MS_REC | MS_PRIVATE, nullptr) == -1) {
+        perror("mount propagation private failed");
+        return -1;
+    }
+    if (config->bind_root && (config->flags & CLONE_NEWNS) && fs_enter_bind_root(config->bind_root) != 0) {
+        return -1;
+    }
+    if (config->enter_root && (config->flags & CLONE_NEWNS) &&
+        (config->read_only_root ? fs_enter_read_only_root(config->enter_root) : fs_enter_root(config->enter_root)) != 0) {
+        return -1;
+    }
+    if (attach_mount(-1, "proc", "/proc", "proc", 0) == -1) {
         fprintf(stderr, "mount proc failed\n");
         return -1;
     }
-    if (mount_or_ignore_ebusy("sysfs", "/sys", "sysfs",
-                              MS_NOSUID | MS_NOEXEC | MS_NODEV) == -1) {
+    int sys_fd = (config->flags & CLONE_NEWNET) ? -1 : tmpl->sys_fd;
+    if (attach_mount(sys_fd, "sysfs", "/sys", "sysfs", MS_NOSUID | MS_NOEXEC | MS_NODEV) == -1) {
         fprintf(stderr, "mount sysfs failed\n");
         return -1;
     }
-    if (mount_or_ignore_ebusy("tmpfs", "/tmp", "tmpfs", 0) == -1) {
+    if (attach_mount(-1, "tmpfs", "/tmp", "tmpfs", 0) == -1) {
         fprintf(stderr, "mount tmpfs failed\n");
         return -1;
     }
-    if (mount_or_ignore_ebusy("dev", "/dev", "devtmpfs", 0) == -1) {
+    if (attach_mount(tmpl->dev_fd, "dev", "/dev", "devtmpfs", 0) == -1) {
         fprintf(stderr, "mount devtmpfs failed\n");
         return -1;
     }
     return 0;
 }
+static void reset_child_signals() {
+    sigset_t none;
+    sigemptyset(&none);
+    sigprocmask(SIG_SETMASK, &none, nullptr);
+    signal(SIGPIPE, SIG_DFL);
+}
+static int install_stdio(const int *stdio_fds) {
+    for (int i = 0; stdio_fds && i < 3; i++) {
+        if (stdio_fds[i] >= 0 && stdio_fds[i] != i && dup2(stdio_fds[i], i) == -1) {
+            perror("dup2 container stdio failed");
+            return -1;
+        }
+    }
+    return 0;
+}
+static uint64_t monotonic_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
 static int container_child(void *arg) {
     clone_args_t *args = static_cast<clone_args_t*>(arg);
+    reset_child_signals();
+    if (install_stdio(args->stdio_fds) != 0) {
+        exit(EXIT_FAILURE);
+    }
+    if (join_namespaces(args->join) != 0) {
+        perror("join namespace failed");
+        exit(EXIT_FAILURE);
+    }
+    uint64_t stamps[3];
+    stamps[0] = monotonic_ns();
     if (namespace_setup_isolation(args->config) != 0) {
         fprintf(stderr, "Failed to setup namespace isolation\n");
         exit(EXIT_FAILURE);
     }
+    stamps[1] = monotonic_ns();
+    if (args->gate[0] >= 0) {
+        close(args->gate[1]);
+        char go;
+        ssize_t n;
+        do {
+            n = read(args->gate[0], &go, 1);
+        } while (n < 0 && errno == EINTR);
+        if (n != 1) {
+            _exit(EXIT_FAILURE);
+        }
+        close(args->gate[0]);
+    }
+    if (enter_late_namespaces(args->config->flags, args->join) != 0) {
+        perror("enter namespace failed");
+        exit(EXIT_FAILURE);
+    }
+    if (args->trace_fd >= 0) {
+        stamps[2] = monotonic_ns();
+        if (write(args->trace_fd, stamps, sizeof(stamps)) != (ssize_t)sizeof(stamps)) {
+            close(args->trace_fd);
+        }
+    }
     execvp(args->command[0], args->command);
     perror("execvp failed");
     exit(EXIT_FAILURE);
 }
+static pid_t clone_into_cgroup(int flags, int cgroup_fd, clone_args_t *args) {
+    static volatile bool unsupported = false;
+    if (unsupported) {
+        errno = ENOSYS;
+        return -1;
+    }
+    struct clone_args cl;
+    memset(&cl, 0, sizeof(cl));
+    cl.flags = (flags & ~CSIGNAL) | CLONE_INTO_CGROUP;
+    cl.exit_signal = SIGCHLD;
+    cl.cgroup = (uint64_t)cgroup_fd;
+    long pid = syscall(SYS_clone3, &cl, sizeof(cl));
+    if (pid == 0) {
+        _exit(container_child(args));
+    }
+    if (pid == -1 && (errno == ENOSYS || errno == E2BIG)) {
+        unsupported = true;
+    }
+    return (pid_t)pid;
+}
+static void close_inherited_fds(int first) {
+    if (syscall(SYS_close_range, first, ~0U, 0) == 0) {
+        return;
+    }
+    long max_fd = sysconf(_SC_OPEN_MAX);
+    for (long fd = first; fd < max_fd; fd++) {
+        close((int)fd);
+    }
+}
+static int parked_child(void *arg) {
+    parked_args_t *args = static_cast<parked_args_t*>(arg);
+    reset_child_signals();
+    if (namespace_setup_isolation(args->config) != 0) {
+        fprintf(stderr, "Failed to setup namespace isolation\n");
+        _exit(EXIT_FAILURE);
+    }
+    if (args->channel_fd != PARKED_CHANNEL_FD) {
+        if (dup2(args->channel_fd, PARKED_CHANNEL_FD) == -1) {
+            _exit(EXIT_FAILURE);
+        }
+        fcntl(PARKED_CHANNEL_FD, F_SETFD, FD_CLOEXEC);
+    }
+    close_inherited_fds(PARKED_CHANNEL_FD + 1);
+    char buffer[PARKED_ARGS_MAX];
+    char control[CMSG_SPACE(sizeof(int) * 3)];
+    struct iovec iov;
+    iov.iov_base = buffer;
+    iov.iov_len = sizeof(buffer);
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    ssize_t n;
+    do {
+        n = recvmsg(PARKED_CHANNEL_FD, &msg, 0);
+    } while (n < 0 && errno == EINTR);
+    if (n <= 0 || (msg.msg_flags & (MSG_TRUNC | MSG_CTRUNC)) || buffer[n - 1] != '\0') {
+        _exit(EXIT_SUCCESS);
+    }
+    int stdio_fds[3] = { -1, -1, -1 };
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    if (cmsg && cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS &&
+        cmsg->cmsg_len == CMSG_LEN(sizeof(stdio_fds))) {
+        memcpy(stdio_fds, CMSG_DATA(cmsg), sizeof(stdio_fds));
+    }
+    if (install_stdio(stdio_fds) != 0) {
+        _exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < 3; i++) {
+        if (stdio_fds[i] > 2) {
+            close(stdio_fds[i]);
+        }
+    }
+    char *command[PARKED_ARGV_MAX + 1];
+    int argc = 0;
+    for (char *p = buffer; p < buffer + n && argc < PARKED_ARGV_MAX; p += strlen(p) + 1) {
+        command[argc++] = p;
+    }
+    command[argc] = nullptr;
+    if (enter_late_namespaces(args->config->flags, nullptr) != 0) {
+        perror("enter namespace failed");
+        _exit(EXIT_FAILURE);
+    }
+    execvp(command[0], command);
+    perror("execvp failed");
+    _exit(EXIT_FAILURE);
+}
+static stack_pool_t *child_stacks() {
+    static stack_pool_t *pool = stack_pool_create(CHILD_STACK_SIZE, STACK_POOL_DEFAULT_CACHED,
+                                                  stack_prefault_parse(getenv(STACK_POOL_ENV_PREFAULT)));
+    return pool;
+}
 pid_t namespace_clone_process(int flags, void *child_stack, int stack_size,
                              int (*child_func)(void *), void *arg) {
     pid_t pid = clone(child_func, static_cast<char*>(child_stack) + stack_size,
@@ -92,39 +378,212 @@ pid_t namespace_create_container(const namespace_config_t *config,
 }
 pid_t namespace_create_container_with_cgroup(const namespace_config_t *config,
                                             char **command, int argc,
-                                            void (*add_to_cgroup_callback)(pid_t pid, void *user_data),
+                                            int (*add_to_cgroup_callback)(pid_t pid, void *user_data),
                                             void *cgroup_user_data) {
+    return namespace_create_container_with_stdio(config, command, argc, nullptr,
+                                                 add_to_cgroup_callback, cgroup_user_data);
+}
+pid_t namespace_create_container_with_stdio(const namespace_config_t *config,
+                                           char **command, int argc, const int *stdio_fds,
+                                           int (*add_to_cgroup_callback)(pid_t pid, void *user_data),
+                                           void *cgroup_user_data) {
+    return namespace_create_container_in_cgroup(config, command, argc, stdio_fds, -1, nullptr, nullptr,
+                                                add_to_cgroup_callback, cgroup_user_data);
+}
+static pid_t clone_container(int flags, int cgroup_fd, clone_args_t *args, namespace_start_trace_t *trace) {
+    uint64_t begin = monotonic_ns();
+    if (cgroup_fd >= 0) {
+        pid_t pid = clone_into_cgroup(flags, cgroup_fd, args);
+        if (pid > 0) {
+            if (trace) trace->clone_ns = monotonic_ns() - begin;
+            return pid;
+        }
+    }
+    if (args->add_to_cgroup_callback && pipe2(args->gate, O_CLOEXEC) == -1) {
+        perror("pipe cgroup gate failed");
+        return -1;
+    }
+    void *stack = stack_pool_acquire(child_stacks());
+    pid_t pid = -1;
+    if (stack) {
+        pid = namespace_clone_process(flags, stack, CHILD_STACK_SIZE, container_child, args);
+        stack_pool_release(child_stacks(), stack);
+    }
+    uint64_t cloned = monotonic_ns();
+    if (args->gate[0] >= 0) {
+        close(args->gate[0]);
+        if (pid > 0 && args->add_to_cgroup_callback(pid, args->cgroup_user_data) != 0) {
+            fprintf(stderr, "Error: failed to add container process %d to its cgroup\n", pid);
+            close(args->gate[1]);
+            while (waitpid(pid, nullptr, __WALL) == -1 && errno == EINTR) {
+            }
+            return -1;
+        }
+        if (pid > 0 && write(args->gate[1], "1", 1) != 1) {
+            perror("release container failed");
+        }
+        close(args->gate[1]);
+    }
+    if (trace) {
+        trace->clone_ns = cloned - begin;
+        trace->cgroup_attach_ns = monotonic_ns() - cloned;
+    }
+    return pid;
+}
+static void collect_child_trace(int fd, namespace_start_trace_t *trace) {
+    uint64_t stamps[3];
+    ssize_t n;
+    do {
+        n = read(fd, stamps, sizeof(stamps));
+    } while (n < 0 && errno == EINTR);
+    if (n != (ssize_t)sizeof(stamps)) {
+        return;
+    }
+    char byte;
+    do {
+        n = read(fd, &byte, 1);
+    } while (n < 0 && errno == EINTR);
+    trace->mount_ns = stamps[1] - stamps[0];
+    trace->exec_ns = monotonic_ns() - stamps[2];
+}
+pid_t namespace_create_container_in_cgroup(const namespace_config_t *config,
+                                           char **command, int argc, const int *stdio_fds, int cgroup_fd,
+                                           const namespace_fds_t *join, namespace_start_trace_t *trace,
+                                           int (*add_to_cgroup_callback)(pid_t pid, void *user_data),
+                                           void *cgroup_user_data) {
     if (!config || !command || argc <= 0) {
         fprintf(stderr, "Error: invalid parameters\n");
         return -1;
     }
-    std::unique_ptr<char[]> child_stack(new char[CHILD_STACK_SIZE]);
-    if (!child_stack) {
-        perror("malloc child stack failed");
-        return -1;
+    mount_template();
+    namespace_fds_t joined;
+    namespace_fds_init(&joined);
+    if (join) {
+        joined = *join;
+    }
+    int own_user_fd = -1;
+    if ((config->flags & CLONE_NEWUSER) && namespace_fds_get(&joined, CLONE_NEWUSER) < 0) {
+        own_user_fd = namespace_create_detached(CLONE_NEWUSER);
+        if (own_user_fd == -1) {
+            perror("create user namespace failed");
+            return -1;
+        }
+        namespace_fds_set(&joined, CLONE_NEWUSER, own_user_fd);
     }
     clone_args_t args = {
         .config = const_cast<namespace_config_t*>(config),
         .command = command,
         .argc = argc,
         .add_to_cgroup_callback = add_to_cgroup_callback,
-        .cgroup_user_data = cgroup_user_data
+        .cgroup_user_data = cgroup_user_data,
+        .stdio_fds = stdio_fds,
+        .join = &joined,
+        .gate = { -1, -1 },
+        .trace_fd = -1
     };
-    int flags = config->flags;
-    pid_t pid = namespace_clone_process(flags, child_stack.get(), CHILD_STACK_SIZE,
-                                      container_child, &args);
-    if (pid > 0 && add_to_cgroup_callback) {
-        usleep(1000);
-        add_to_cgroup_callback(pid, cgroup_user_data);
+    int trace_pipe[2] = { -1, -1 };
+    if (trace) {
+        memset(trace, 0, sizeof(*trace));
+        if (pipe2(trace_pipe, O_CLOEXEC) == 0) {
+            args.trace_fd = trace_pipe[1];
+        }
+    }
+    int flags = config->flags & ~(CLONE_NEWUSER | CLONE_NEWCGROUP | joined.flags);
+    pid_t pid = clone_container(flags, cgroup_fd, &args, trace);
+    if (trace_pipe[0] >= 0) {
+        close(trace_pipe[1]);
+        if (pid > 0) {
+            collect_child_trace(trace_pipe[0], trace);
+        }
+        close(trace_pipe[0]);
+    }
+    if (own_user_fd >= 0) {
+        close(own_user_fd);
     }
     return pid;
 }
+pid_t namespace_create_parked(const namespace_config_t *config, int *channel_fd) {
+    if (!config || !channel_fd) {
+        fprintf(stderr, "Error: invalid parameters\n");
+        return -1;
+    }
+    if (config->flags & CLONE_NEWUSER) {
+        fprintf(stderr, "Error: user namespaces cannot be parked\n");
+        errno = EINVAL;
+        return -1;
+    }
+    mount_template();
+    int channel[2];
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, channel) == -1) {
+        perror("socketpair failed");
+        return -1;
+    }
+    parked_args_t args = {
+        .config = const_cast<namespace_config_t*>(config),
+        .channel_fd = channel[1]
+    };
+    void *stack = stack_pool_acquire(child_stacks());
+    pid_t pid = -1;
+    if (stack) {
+        pid = namespace_clone_process(config->flags & ~CLONE_NEWCGROUP, stack, CHILD_STACK_SIZE,
+                                      parked_child, &args);
+        stack_pool_release(child_stacks(), stack);
+    }
+    close(channel[1]);
+    if (pid == -1) {
+        close(channel[0]);
+        return -1;
+    }
+    *channel_fd = channel[0];
+    return pid;
+}
+int namespace_release_parked(int channel_fd, char **command, const int *stdio_fds) {
+    if (channel_fd < 0 || !command || !command[0]) {
+        return -1;
+    }
+    std::unique_ptr<char[]> buffer(new char[PARKED_ARGS_MAX]);
+    size_t length = 0;
+    for (int i = 0; command[i]; i++) {
+        size_t len = strlen(command[i]) + 1;
+        if (i >= PARKED_ARGV_MAX || length + len > PARKED_ARGS_MAX) {
+            errno = E2BIG;
+            return -1;
+        }
+        memcpy(buffer.get() + length, command[i], len);
+        length += len;
+    }
+    int default_fds[3] = { STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO };
+    const int *fds = stdio_fds ? stdio_fds : default_fds;
+    char control[CMSG_SPACE(sizeof(int) * 3)];
+    memset(control, 0, sizeof(control));
+    struct iovec iov;
+    iov.iov_base = buffer.get();
+    iov.iov_len = length;
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int) * 3);
+    memcpy(CMSG_DATA(cmsg), fds, sizeof(int) * 3);
+    ssize_t sent;
+    do {
+        sent = sendmsg(channel_fd, &msg, MSG_NOSIGNAL);
+    } while (sent < 0 && errno == EINTR);
+    return sent == (ssize_t)length ? 0 : -1;
+}
+const char *namespace_kind_name(int ns_type) {
+    int index = kind_index(ns_type);
+    return index < 0 ? "unknown" : namespace_kinds[index].name;
+}
 int namespace_join(pid_t target_pid, int ns_type) {
     char ns_path[256];
     int fd;
-    snprintf(ns_path, sizeof(ns_path), "/proc/%d/ns/%s", target_pid,
-             ns_type == CLONE_NEWPID ? "pid" :
-             ns_type == CLONE_NEWNS ? "mnt" : "unknown");
+    snprintf(ns_path, sizeof(ns_path), "/proc/%d/ns/%s", target_pid, namespace_kind_name(ns_type));
     fd = open(ns_path, O_RDONLY);
     if (fd == -1) {
         perror("open namespace file failed");
@@ -137,4 +596,376 @@ int namespace_join(pid_t target_pid, int ns_type) {
     }
     close(fd);
     return 0;
-}
\ No newline at end of file
+}
+static int open_namespace_file(pid_t pid, const char *name) {
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/ns/%s", pid, name);
+    return open(path, O_RDONLY | O_CLOEXEC);
+}
+static int bring_loopback_up() {
+    int sock = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (sock == -1) {
+        return -1;
+    }
+    struct ifreq ifr;
+    memset(&ifr, 0, sizeof(ifr));
+    strncpy(ifr.ifr_name, "lo", IFNAMSIZ - 1);
+    int result = ioctl(sock, SIOCGIFFLAGS, &ifr);
+    if (result == 0) {
+        ifr.ifr_flags |= IFF_UP;
+        result = ioctl(sock, SIOCSIFFLAGS, &ifr);
+    }
+    close(sock);
+    return result;
+}
+typedef struct {
+    int gate[2];
+} userns_args_t;
+static int userns_child(void *arg) {
+    userns_args_t *args = static_cast<userns_args_t*>(arg);
+    close(args->gate[1]);
+    char byte;
+    while (read(args->gate[0], &byte, 1) < 0 && errno == EINTR) {
+    }
+    _exit(EXIT_SUCCESS);
+}
+static int write_id_map(pid_t pid, const char *file) {
+    char path[64];
+    char map[64];
+    snprintf(path, sizeof(path), "/proc/%d/%s", pid, file);
+    int length = snprintf(map, sizeof(map), "0 %d %d\n", NAMESPACE_USERNS_BASE, NAMESPACE_USERNS_RANGE);
+    int fd = open(path, O_WRONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return -1;
+    }
+    int result = write(fd, map, length) == length ? 0 : -1;
+    close(fd);
+    return result;
+}
+static int create_user_namespace() {
+    userns_args_t args;
+    if (pipe2(args.gate, O_CLOEXEC) == -1) {
+        return -1;
+    }
+    void *stack = stack_pool_acquire(child_stacks());
+    pid_t pid = -1;
+    if (stack) {
+        pid = clone(userns_child, static_cast<char*>(stack) + CHILD_STACK_SIZE, CLONE_NEWUSER | SIGCHLD, &args);
+        stack_pool_release(child_stacks(), stack);
+    }
+    close(args.gate[0]);
+    int fd = -1;
+    int saved = errno;
+    if (pid > 0) {
+        if (write_id_map(pid, "uid_map") == 0 && write_id_map(pid, "gid_map") == 0) {
+            fd = open_namespace_file(pid, "user");
+        }
+        saved = errno;
+    }
+    close(args.gate[1]);
+    if (pid > 0) {
+        while (waitpid(pid, nullptr, 0) == -1 && errno == EINTR) {
+        }
+    }
+    errno = saved;
+    return fd;
+}
+int namespace_create_detached(int ns_type) {
+    if (ns_type == CLONE_NEWUSER) {
+        return create_user_namespace();
+    }
+    if (ns_type == CLONE_NEWPID || ns_type == CLONE_NEWNS || kind_index(ns_type) < 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/thread-self/ns/%s", namespace_kind_name(ns_type));
+    int original = open(path, O_RDONLY | O_CLOEXEC);
+    if (original == -1) {
+        return -1;
+    }
+    if (unshare(ns_type) == -1) {
+        int saved = errno;
+        close(original);
+        errno = saved;
+        return -1;
+    }
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    int saved = errno;
+    if (fd != -1 && ns_type == CLONE_NEWNET && bring_loopback_up() != 0) {
+        saved = errno;
+        close(fd);
+        fd = -1;
+    }
+    if (setns(original, ns_type) == -1) {
+        perror("restore namespace failed");
+    }
+    close(original);
+    errno = saved;
+    return fd;
+}
+int namespace_exec(pid_t target_pid, char **command) {
+    if (target_pid <= 0 || !command || !command[0]) {
+        fprintf(stderr, "Error: invalid parameters\n");
+        return -1;
+    }
+    namespace_fds_t fds;
+    namespace_fds_init(&fds);
+    if (namespace_open_fds(target_pid, CONTAINER_NAMESPACES, &fds) != 0) {
+        perror("open namespace file failed");
+        return -1;
+    }
+    pid_t pid = namespace_spawn(&fds, nullptr, 0, command, nullptr, nullptr);
+    namespace_close_fds(&fds);
+    if (pid == -1) {
+        return -1;
+    }
+    int status;
+    while (waitpid(pid, &status, 0) == -1) {
+        if (errno != EINTR) {
+            perror("waitpid failed");
+            return -1;
+        }
+    }
+    return WEXITSTATUS(status);
+}
+void namespace_fds_init(namespace_fds_t *fds) {
+    if (!fds) return;
+    fds->flags = 0;
+    for (int i = 0; i < NAMESPACE_KIND_COUNT; i++) {
+        fds->fds[i] = -1;
+    }
+}
+int namespace_fds_get(const namespace_fds_t *fds, int ns_type) {
+    int index = kind_index(ns_type);
+    return (!fds || index < 0) ? -1 : fds->fds[index];
+}
+void namespace_fds_set(namespace_fds_t *fds, int ns_type, int fd) {
+    int index = kind_index(ns_type);
+    if (!fds || index < 0) return;
+    fds->fds[index] = fd;
+    fds->flags |= ns_type;
+}
+int namespace_fds_count(const namespace_fds_t *fds) {
+    int count = 0;
+    for (int i = 0; fds && i < NAMESPACE_KIND_COUNT; i++) {
+        if (fds->fds[i] >= 0) {
+            count++;
+        }
+    }
+    return count;
+}
+int namespace_open_fds(pid_t target_pid, int flags, namespace_fds_t *fds) {
+    if (target_pid <= 0 || !fds) {
+        errno = EINVAL;
+        return -1;
+    }
+    for (int i = 0; i < NAMESPACE_KIND_COUNT; i++) {
+        int type = namespace_kinds[i].type;
+        if (!(flags & type) || type == CLONE_NEWCGROUP || fds->fds[i] >= 0) {
+            continue;
+        }
+        if ((fds->fds[i] = open_namespace_file(target_pid, namespace_kinds[i].name)) == -1) {
+            int saved = errno;
+            namespace_close_fds(fds);
+            errno = saved;
+            return -1;
+        }
+    }
+    fds->flags |= flags;
+    return 0;
+}
+void namespace_close_fds(namespace_fds_t *fds) {
+    if (!fds) return;
+    for (int i = 0; i < NAMESPACE_KIND_COUNT; i++) {
+        if (fds->fds[i] >= 0) close(fds->fds[i]);
+    }
+    namespace_fds_init(fds);
+}
+static void pinned_path(char *path, size_t size, const char *dir, const char *name, const char *kind) {
+    snprintf(path, size, "%s/%s.%s", dir, name, kind);
+}
+static int make_private_dir(const char *dir) {
+    if (mkdir(dir, 0700) == -1 && errno != EEXIST) {
+        return -1;
+    }
+    if (mount(nullptr, dir, nullptr, MS_PRIVATE, nullptr) == 0) {
+        return 0;
+    }
+    if (errno != EINVAL || mount(dir, dir, nullptr, MS_BIND, nullptr) == -1) {
+        return -1;
+    }
+    return mount(nullptr, dir, nullptr, MS_PRIVATE, nullptr);
+}
+static int pin_fd(int fd, const char *dir, const char *name, const char *kind) {
+    if (fd < 0) {
+        return 0;
+    }
+    char target[PATH_MAX];
+    char source[64];
+    pinned_path(target, sizeof(target), dir, name, kind);
+    int file = open(target, O_WRONLY | O_CREAT | O_CLOEXEC, 0600);
+    if (file == -1) {
+        return -1;
+    }
+    close(file);
+    snprintf(source, sizeof(source), "/proc/self/fd/%d", fd);
+    return mount(source, target, nullptr, MS_BIND, nullptr);
+}
+int namespace_pin_fds(const namespace_fds_t *fds, const char *dir, const char *name) {
+    if (!fds || !dir || !name) {
+        errno = EINVAL;
+        return -1;
+    }
+    namespace_unpin(dir, name);
+    if (make_private_dir(dir) != 0) {
+        perror("prepare namespace pin directory failed");
+        return -1;
+    }
+    for (int i = 0; i < NAMESPACE_KIND_COUNT; i++) {
+        if (pin_fd(fds->fds[i], dir, name, namespace_kinds[i].name) != 0) {
+            perror("pin namespace failed");
+            namespace_unpin(dir, name);
+            return -1;
+        }
+    }
+    return 0;
+}
+static int open_pinned_file(const char *dir, const char *name, const char *kind, int *fd) {
+    char path[PATH_MAX];
+    pinned_path(path, sizeof(path), dir, name, kind);
+    *fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (*fd == -1) {
+        return errno == ENOENT ? 0 : -1;
+    }
+    struct statfs st;
+    if (fstatfs(*fd, &st) != 0 || st.f_type != NSFS_MAGIC) {
+        close(*fd);
+        *fd = -1;
+        errno = ESTALE;
+        return -1;
+    }
+    return 1;
+}
+int namespace_open_pinned(const char *dir, const char *name, namespace_fds_t *fds) {
+    if (!dir || !name || !fds) {
+        errno = EINVAL;
+        return -1;
+    }
+    namespace_fds_init(fds);
+    int found = 0;
+    for (int i = 0; i < NAMESPACE_KIND_COUNT; i++) {
+        int result = open_pinned_file(dir, name, namespace_kinds[i].name, &fds->fds[i]);
+        if (result < 0) {
+            int saved = errno;
+            namespace_close_fds(fds);
+            errno = saved;
+            return -1;
+        }
+        if (result > 0) {
+            fds->flags |= namespace_kinds[i].type;
+            found++;
+        }
+    }
+    if (found == 0) {
+        errno = ENOENT;
+        return -1;
+    }
+    return 0;
+}
+void namespace_unpin(const char *dir, const char *name) {
+    if (!dir || !name) return;
+    for (int i = 0; i < NAMESPACE_KIND_COUNT; i++) {
+        char path[PATH_MAX];
+        pinned_path(path, sizeof(path), dir, name, namespace_kinds[i].name);
+        umount2(path, MNT_DETACH);
+        unlink(path);
+    }
+}
+static int spawn_child(void *arg) {
+    spawn_args_t *args = static_cast<spawn_args_t*>(arg);
+    for (int sig = 1; sig < NSIG; sig++) {
+        struct sigaction action;
+        if (sigaction(sig, nullptr, &action) == 0 && action.sa_handler != SIG_IGN &&
+            action.sa_handler != SIG_DFL) {
+            memset(&action, 0, sizeof(action));
+            action.sa_handler = SIG_DFL;
+            sigaction(sig, &action, nullptr);
+        }
+    }
+    reset_child_signals();
+    for (int i = 0; i < args->cgroup_fd_count; i++) {
+        if (write(args->cgroup_fds[i], "0", 1) != 1) {
+            args->error = errno;
+            _exit(127);
+        }
+    }
+    if (join_namespaces(args->fds) != 0 || install_stdio(args->stdio_fds) != 0 ||
+        enter_late_namespaces(args->fds->flags, args->fds) != 0) {
+        args->error = errno;
+        _exit(127);
+    }
+    syscall(SYS_close_range, 3, ~0U, CLOSE_RANGE_CLOEXEC);
+    execvp(args->command[0], args->command);
+    args->error = errno;
+    _exit(127);
+}
+static int own_pid_namespace() {
+    static int fd = open("/proc/self/ns/pid", O_RDONLY | O_CLOEXEC);
+    return fd;
+}
+pid_t namespace_spawn(const namespace_fds_t *fds, const int *cgroup_fds, int cgroup_fd_count,
+                      char **command, const int *stdio_fds, int *pidfd) {
+    if (!fds || !command || !command[0] || (cgroup_fd_count > 0 && !cgroup_fds)) {
+        fprintf(stderr, "Error: invalid parameters\n");
+        errno = EINVAL;
+        return -1;
+    }
+    int restore_fd = -1;
+    int pid_fd = namespace_fds_get(fds, CLONE_NEWPID);
+    if (pid_fd >= 0) {
+        restore_fd = own_pid_namespace();
+        if (restore_fd == -1) {
+            perror("open own pid namespace failed");
+            return -1;
+        }
+        if (setns(pid_fd, CLONE_NEWPID) == -1) {
+            perror("setns pid namespace failed");
+            return -1;
+        }
+    }
+    void *stack = stack_pool_acquire(child_stacks());
+    pid_t pid = -1;
+    int saved_errno = ENOMEM;
+    spawn_args_t args = { fds, cgroup_fds, cgroup_fd_count, command, stdio_fds, 0 };
+    if (stack) {
+        sigset_t all, saved;
+        sigfillset(&all);
+        pthread_sigmask(SIG_BLOCK, &all, &saved);
+        pid = clone(spawn_child, static_cast<char*>(stack) + CHILD_STACK_SIZE,
+                    CLONE_VM | CLONE_VFORK | (pidfd ? CLONE_PIDFD : 0) | SIGCHLD, &args, pidfd);
+        saved_errno = errno;
+        pthread_sigmask(SIG_SETMASK, &saved, nullptr);
+        stack_pool_release(child_stacks(), stack);
+    }
+    if (restore_fd >= 0 && setns(restore_fd, CLONE_NEWPID) == -1) {
+        perror("restore pid namespace failed");
+    }
+    if (pid == -1) {
+        errno = saved_errno;
+        perror("clone exec process failed");
+        return -1;
+    }
+    if (args.error != 0) {
+        while (waitpid(pid, nullptr, 0) == -1 && errno == EINTR) {
+        }
+        if (pidfd) {
+            close(*pidfd);
+            *pidfd = -1;
+        }
+        fprintf(stderr, "exec %s failed: %s\n", command[0], strerror(args.error));
+        errno = args.error;
+        return -1;
+    }
+    return pid;
+}
@@ -0,0 +1,223 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <climits>
+#include <unistd.h>
+#include <dirent.h>
+#include <deque>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
+#include "../include/ns_pool.hpp"
+#include "../include/logger.hpp"
+using namespace std;
+#define NS_POOL_RETRY_DELAY_MS 1000
+#define NS_POOL_KIND_COUNT 2
+struct ns_entry {
+    int fd;
+    unsigned long seq;
+};
+struct ns_kind_pool {
+    int type;
+    bool active;
+    deque<ns_entry> idle;
+};
+struct ns_pool {
+    string dir;
+    int target;
+    ns_kind_pool kinds[NS_POOL_KIND_COUNT];
+    vector<unsigned long> retired;
+    unsigned long next_seq;
+    unsigned long hits;
+    unsigned long misses;
+    bool shutdown;
+    mutex lock;
+    condition_variable cond;
+    thread worker;
+};
+static void entry_name(char *name, size_t size, unsigned long seq) {
+    snprintf(name, size, "%lu", seq);
+}
+static ns_kind_pool *find_kind(ns_pool_t *pool, int ns_type) {
+    for (int i = 0; i < NS_POOL_KIND_COUNT; i++) {
+        if (pool->kinds[i].type == ns_type) {
+            return &pool->kinds[i];
+        }
+    }
+    return nullptr;
+}
+static void pin_entry(ns_pool_t *pool, int ns_type, int fd, unsigned long seq) {
+    char name[32];
+    entry_name(name, sizeof(name), seq);
+    namespace_fds_t fds;
+    namespace_fds_init(&fds);
+    namespace_fds_set(&fds, ns_type, fd);
+    if (namespace_pin_fds(&fds, pool->dir.c_str(), name) != 0) {
+        LOG_DEBUG("pooled %s namespace %s is not pinned", namespace_kind_name(ns_type), name);
+    }
+}
+static void unpin_entry(ns_pool_t *pool, unsigned long seq) {
+    char name[32];
+    entry_name(name, sizeof(name), seq);
+    namespace_unpin(pool->dir.c_str(), name);
+}
+static void adopt_pinned(ns_pool_t *pool) {
+    DIR *dir = opendir(pool->dir.c_str());
+    if (!dir) return;
+    vector<unsigned long> seqs;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        char *end;
+        unsigned long seq = strtoul(entry->d_name, &end, 10);
+        if (end != entry->d_name && *end == '.') {
+            seqs.push_back(seq);
+        }
+    }
+    closedir(dir);
+    for (size_t i = 0; i < seqs.size(); i++) {
+        char name[32];
+        entry_name(name, sizeof(name), seqs[i]);
+        namespace_fds_t fds;
+        if (namespace_open_pinned(pool->dir.c_str(), name, &fds) != 0) {
+            namespace_unpin(pool->dir.c_str(), name);
+            continue;
+        }
+        for (int k = 0; k < NS_POOL_KIND_COUNT; k++) {
+            ns_kind_pool *kind = &pool->kinds[k];
+            int fd = namespace_fds_get(&fds, kind->type);
+            if (fd >= 0 && (int)kind->idle.size() < pool->target) {
+                ns_entry adopted = { fd, seqs[i] };
+                kind->idle.push_back(adopted);
+                kind->active = true;
+                namespace_fds_set(&fds, kind->type, -1);
+            }
+        }
+        if (namespace_fds_count(&fds) > 0) {
+            namespace_close_fds(&fds);
+            namespace_unpin(pool->dir.c_str(), name);
+        }
+        if (seqs[i] >= pool->next_seq) {
+            pool->next_seq = seqs[i] + 1;
+        }
+    }
+    LOG_DEBUG("adopted %zu net and %zu user namespaces from %s", pool->kinds[0].idle.size(),
+              pool->kinds[1].idle.size(), pool->dir.c_str());
+}
+static ns_kind_pool *next_to_refill(ns_pool_t *pool) {
+    for (int i = 0; i < NS_POOL_KIND_COUNT; i++) {
+        ns_kind_pool *kind = &pool->kinds[i];
+        if (kind->active && (int)kind->idle.size() < pool->target) {
+            return kind;
+        }
+    }
+    return nullptr;
+}
+static void refill_loop(ns_pool_t *pool) {
+    unique_lock<mutex> guard(pool->lock);
+    while (!pool->shutdown) {
+        if (!pool->retired.empty()) {
+            vector<unsigned long> retired;
+            retired.swap(pool->retired);
+            guard.unlock();
+            for (size_t i = 0; i < retired.size(); i++) {
+                unpin_entry(pool, retired[i]);
+            }
+            guard.lock();
+            continue;
+        }
+        ns_kind_pool *kind = next_to_refill(pool);
+        if (!kind) {
+            pool->cond.wait(guard);
+            continue;
+        }
+        int type = kind->type;
+        unsigned long seq = pool->next_seq++;
+        guard.unlock();
+        int fd = namespace_create_detached(type);
+        if (fd != -1) {
+            pin_entry(pool, type, fd, seq);
+        }
+        guard.lock();
+        if (fd == -1) {
+            LOG_WARN("failed to pre-create a %s namespace, retrying in %dms", namespace_kind_name(type),
+                     NS_POOL_RETRY_DELAY_MS);
+            pool->cond.wait_for(guard, chrono::milliseconds(NS_POOL_RETRY_DELAY_MS));
+            continue;
+        }
+        ns_entry entry = { fd, seq };
+        kind->idle.push_back(entry);
+    }
+}
+ns_pool_t *ns_pool_create(const char *dir, int target) {
+    if (!dir || target <= 0) return nullptr;
+    ns_pool_t *pool = new ns_pool();
+    pool->dir = dir;
+    pool->target = target;
+    pool->kinds[0].type = NS_NET;
+    pool->kinds[1].type = NS_USER;
+    for (int i = 0; i < NS_POOL_KIND_COUNT; i++) {
+        pool->kinds[i].active = false;
+    }
+    pool->next_seq = 0;
+    pool->hits = 0;
+    pool->misses = 0;
+    pool->shutdown = false;
+    adopt_pinned(pool);
+    pool->worker = thread(refill_loop, pool);
+    return pool;
+}
+void ns_pool_destroy(ns_pool_t *pool) {
+    if (!pool) return;
+    {
+        lock_guard<mutex> guard(pool->lock);
+        pool->shutdown = true;
+        pool->cond.notify_all();
+    }
+    if (pool->worker.joinable()) {
+        pool->worker.join();
+    }
+    for (int i = 0; i < NS_POOL_KIND_COUNT; i++) {
+        deque<ns_entry> &idle = pool->kinds[i].idle;
+        for (size_t j = 0; j < idle.size(); j++) {
+            close(idle[j].fd);
+            unpin_entry(pool, idle[j].seq);
+        }
+    }
+    for (size_t i = 0; i < pool->retired.size(); i++) {
+        unpin_entry(pool, pool->retired[i]);
+    }
+    delete pool;
+}
+int ns_pool_acquire(ns_pool_t *pool, int ns_type) {
+    ns_kind_pool *kind = pool ? find_kind(pool, ns_type) : nullptr;
+    if (!kind) {
+        return namespace_create_detached(ns_type);
+    }
+    ns_entry entry = { -1, 0 };
+    {
+        lock_guard<mutex> guard(pool->lock);
+        kind->active = true;
+        if (kind->idle.empty()) {
+            pool->misses++;
+        } else {
+            entry = kind->idle.front();
+            kind->idle.pop_front();
+            pool->retired.push_back(entry.seq);
+            pool->hits++;
+        }
+        pool->cond.notify_all();
+    }
+    return entry.fd == -1 ? namespace_create_detached(ns_type) : entry.fd;
+}
+void ns_pool_get_stats(ns_pool_t *pool, ns_pool_stats_t *stats) {
+    if (!pool || !stats) return;
+    lock_guard<mutex> guard(pool->lock);
+    stats->idle_net = (int)find_kind(pool, NS_NET)->idle.size();
+    stats->idle_user = (int)find_kind(pool, NS_USER)->idle.size();
+    stats->hits = pool->hits;
+    stats->misses = pool->misses;
+}
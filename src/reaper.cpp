@@ -0,0 +1,316 @@
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unordered_map>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
+#include "../include/reaper.hpp"
+using namespace std;
+#ifndef P_PIDFD
+#define P_PIDFD 3
+#endif
+#define REAPER_WAKE_KEY UINT64_MAX
+#define REAPER_MAX_EVENTS 64
+struct reaper_entry {
+    int pidfd;
+    bool exited;
+    int status;
+};
+struct reaper {
+    int epoll_fd;
+    int wake_fd;
+    bool shutdown;
+    reaper_status_fn status_fn;
+    void *status_data;
+    unordered_map<pid_t, reaper_entry> entries;
+    deque<pid_t> exits;
+    mutex lock;
+    condition_variable cond;
+    thread worker;
+};
+static int pidfd_open(pid_t pid) {
+    return (int)syscall(SYS_pidfd_open, pid, 0);
+}
+static int pidfd_send_signal(int pidfd, int sig) {
+    return (int)syscall(SYS_pidfd_send_signal, pidfd, sig, nullptr, 0);
+}
+static int decode_status(const siginfo_t *info) {
+    if (info->si_code == CLD_EXITED) {
+        return W_EXITCODE(info->si_status, 0);
+    }
+    if (info->si_code == CLD_DUMPED) {
+        return info->si_status | WCOREFLAG;
+    }
+    return info->si_status;
+}
+static void reap_exited(reaper_t *reaper, pid_t pid) {
+    unique_lock<mutex> guard(reaper->lock);
+    auto it = reaper->entries.find(pid);
+    if (it == reaper->entries.end() || it->second.exited) {
+        return;
+    }
+    siginfo_t info;
+    memset(&info, 0, sizeof(info));
+    int status;
+    if (waitid(static_cast<idtype_t>(P_PIDFD), it->second.pidfd, &info, WEXITED | WNOHANG | __WALL) == 0) {
+        if (info.si_pid == 0) {
+            return;
+        }
+        status = decode_status(&info);
+    } else if (errno == ECHILD && reaper->status_fn) {
+        reaper_status_fn fn = reaper->status_fn;
+        void *data = reaper->status_data;
+        int pidfd = it->second.pidfd;
+        guard.unlock();
+        if (fn(pid, &status, data) != 0) {
+            status = 0;
+        }
+        guard.lock();
+        it = reaper->entries.find(pid);
+        if (it == reaper->entries.end() || it->second.exited || it->second.pidfd != pidfd) {
+            return;
+        }
+    } else {
+        status = decode_status(&info);
+    }
+    reaper_entry &entry = it->second;
+    entry.status = status;
+    entry.exited = true;
+    epoll_ctl(reaper->epoll_fd, EPOLL_CTL_DEL, entry.pidfd, nullptr);
+    reaper->exits.push_back(pid);
+    reaper->cond.notify_all();
+}
+static void reaper_thread(reaper_t *reaper) {
+    struct epoll_event events[REAPER_MAX_EVENTS];
+    while (true) {
+        int n = epoll_wait(reaper->epoll_fd, events, REAPER_MAX_EVENTS, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("epoll_wait reaper failed");
+            return;
+        }
+        for (int i = 0; i < n; i++) {
+            if (events[i].data.u64 == REAPER_WAKE_KEY) {
+                uint64_t value;
+                if (read(reaper->wake_fd, &value, sizeof(value)) < 0) {
+                    continue;
+                }
+                lock_guard<mutex> guard(reaper->lock);
+                if (reaper->shutdown) {
+                    return;
+                }
+                continue;
+            }
+            reap_exited(reaper, (pid_t)events[i].data.u64);
+        }
+    }
+}
+reaper_t *reaper_create(void) {
+    int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd == -1) {
+        perror("epoll_create1 failed");
+        return nullptr;
+    }
+    int wake_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (wake_fd == -1) {
+        perror("eventfd failed");
+        close(epoll_fd);
+        return nullptr;
+    }
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.u64 = REAPER_WAKE_KEY;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wake_fd, &ev) == -1) {
+        perror("epoll_ctl reaper wake fd failed");
+        close(wake_fd);
+        close(epoll_fd);
+        return nullptr;
+    }
+    reaper_t *reaper = new struct reaper();
+    reaper->epoll_fd = epoll_fd;
+    reaper->wake_fd = wake_fd;
+    reaper->shutdown = false;
+    reaper->status_fn = nullptr;
+    reaper->status_data = nullptr;
+    reaper->worker = thread(reaper_thread, reaper);
+    return reaper;
+}
+void reaper_shutdown(reaper_t *reaper) {
+    if (!reaper) return;
+    {
+        lock_guard<mutex> guard(reaper->lock);
+        if (reaper->shutdown) {
+            return;
+        }
+        reaper->shutdown = true;
+        reaper->cond.notify_all();
+    }
+    uint64_t one = 1;
+    if (write(reaper->wake_fd, &one, sizeof(one)) < 0) {
+        perror("write reaper wake fd failed");
+    }
+    if (reaper->worker.joinable()) {
+        reaper->worker.join();
+    }
+}
+void reaper_destroy(reaper_t *reaper) {
+    if (!reaper) return;
+    reaper_shutdown(reaper);
+    for (auto &it : reaper->entries) {
+        close(it.second.pidfd);
+    }
+    close(reaper->wake_fd);
+    close(reaper->epoll_fd);
+    delete reaper;
+}
+static int watch_locked(reaper_t *reaper, pid_t pid, int pidfd) {
+    auto it = reaper->entries.find(pid);
+    if (it != reaper->entries.end()) {
+        if (!it->second.exited) {
+            if (pidfd >= 0) {
+                close(pidfd);
+            }
+            return 0;
+        }
+        close(it->second.pidfd);
+        reaper->entries.erase(it);
+    }
+    if (pidfd < 0) {
+        pidfd = pidfd_open(pid);
+        if (pidfd == -1) {
+            return -1;
+        }
+    }
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.u64 = (uint64_t)pid;
+    if (epoll_ctl(reaper->epoll_fd, EPOLL_CTL_ADD, pidfd, &ev) == -1) {
+        perror("epoll_ctl pidfd failed");
+        close(pidfd);
+        return -1;
+    }
+    reaper_entry entry;
+    entry.pidfd = pidfd;
+    entry.exited = false;
+    entry.status = 0;
+    reaper->entries[pid] = entry;
+    return 0;
+}
+int reaper_watch(reaper_t *reaper, pid_t pid) {
+    if (!reaper || pid <= 0) {
+        return -1;
+    }
+    lock_guard<mutex> guard(reaper->lock);
+    return watch_locked(reaper, pid, -1);
+}
+int reaper_watch_pidfd(reaper_t *reaper, pid_t pid, int pidfd) {
+    if (!reaper || pid <= 0 || pidfd < 0) {
+        if (pidfd >= 0) {
+            close(pidfd);
+        }
+        return -1;
+    }
+    lock_guard<mutex> guard(reaper->lock);
+    return watch_locked(reaper, pid, pidfd);
+}
+void reaper_forget(reaper_t *reaper, pid_t pid) {
+    if (!reaper || pid <= 0) return;
+    lock_guard<mutex> guard(reaper->lock);
+    auto it = reaper->entries.find(pid);
+    if (it == reaper->entries.end()) {
+        return;
+    }
+    if (!it->second.exited) {
+        epoll_ctl(reaper->epoll_fd, EPOLL_CTL_DEL, it->second.pidfd, nullptr);
+    }
+    close(it->second.pidfd);
+    reaper->entries.erase(it);
+}
+int reaper_signal(reaper_t *reaper, pid_t pid, int sig) {
+    if (!reaper || pid <= 0) {
+        return -1;
+    }
+    lock_guard<mutex> guard(reaper->lock);
+    auto it = reaper->entries.find(pid);
+    if (it == reaper->entries.end()) {
+        errno = ESRCH;
+        return -1;
+    }
+    if (it->second.exited) {
+        return 0;
+    }
+    if (pidfd_send_signal(it->second.pidfd, sig) == -1 && errno != ESRCH) {
+        return -1;
+    }
+    return 0;
+}
+int reaper_wait(reaper_t *reaper, pid_t pid, int timeout_ms, int *status) {
+    if (!reaper || pid <= 0) {
+        return -1;
+    }
+    unique_lock<mutex> guard(reaper->lock);
+    auto exited = [reaper, pid]() {
+        auto it = reaper->entries.find(pid);
+        return it == reaper->entries.end() || it->second.exited;
+    };
+    if (timeout_ms < 0) {
+        reaper->cond.wait(guard, exited);
+    } else if (!reaper->cond.wait_for(guard, chrono::milliseconds(timeout_ms), exited)) {
+        return 1;
+    }
+    auto it = reaper->entries.find(pid);
+    if (it == reaper->entries.end()) {
+        return -1;
+    }
+    if (status) {
+        *status = it->second.status;
+    }
+    return 0;
+}
+int reaper_next_exit(reaper_t *reaper, pid_t *pid, int *status) {
+    if (!reaper || !pid) {
+        return -1;
+    }
+    unique_lock<mutex> guard(reaper->lock);
+    while (true) {
+        reaper->cond.wait(guard, [reaper]() { return reaper->shutdown || !reaper->exits.empty(); });
+        if (reaper->shutdown) {
+            return -1;
+        }
+        pid_t exited = reaper->exits.front();
+        reaper->exits.pop_front();
+        auto it = reaper->entries.find(exited);
+        if (it == reaper->entries.end() || !it->second.exited) {
+            continue;
+        }
+        *pid = exited;
+        if (status) {
+            *status = it->second.status;
+        }
+        return 0;
+    }
+}
+int reaper_is_alive(reaper_t *reaper, pid_t pid) {
+    if (!reaper || pid <= 0) {
+        return 0;
+    }
+    lock_guard<mutex> guard(reaper->lock);
+    auto it = reaper->entries.find(pid);
+    return it != reaper->entries.end() && !it->second.exited;
+}
+void reaper_set_status_source(reaper_t *reaper, reaper_status_fn fn, void *user_data) {
+    if (!reaper) return;
+    lock_guard<mutex> guard(reaper->lock);
+    reaper->status_fn = fn;
+    reaper->status_data = user_data;
+}
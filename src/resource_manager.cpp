@@ -7,8 +7,11 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <dirent.h>
+#include <poll.h>
+#include <ctime>
 #include <memory>
 #include "../include/resource_manager.hpp"
+#include "../include/logger.hpp"
 using namespace std;
 #define CGROUP_ROOT "/sys/fs/cgroup"
 #define CGROUP_V2_CONTROLLERS CGROUP_ROOT "/cgroup.controllers"
@@ -16,12 +19,9 @@ using namespace std;
 #define CPUACCT_CGROUP_PATH CGROUP_ROOT "/cpuacct"
 #define CPU_CPUACCT_CGROUP_PATH CGROUP_ROOT "/cpu,cpuacct"
 #define MEMORY_CGROUP_PATH CGROUP_ROOT "/memory"
+#define FREEZER_CGROUP_PATH CGROUP_ROOT "/freezer"
+#define FREEZE_TIMEOUT_MS 1000
 #define BUF_SIZE 512
-#define DEBUG_LOG(rm, fmt, ...) \
-    do { \
-        fprintf(stderr, "[DEBUG] %s:%d [resource_manager] " fmt, __FILE__, __LINE__, ##__VA_ARGS__); \
-        fflush(stderr); \
-    } while(0)
 static int find_cpuacct_usage_path(resource_manager_t *rm, const char *container_id, char *path, size_t path_size) {
     snprintf(path, path_size, "%s/%s_%s/cpuacct.usage", CPU_CPUACCT_CGROUP_PATH, rm->cgroup_path, container_id);
     if (access(path, R_OK) == 0) {
@@ -68,13 +68,13 @@ static int read_file(const char *path, char *buffer, size_t size, resource_manag
     int fd = open(path, O_RDONLY);
     if (fd == -1) {
         if (errno != ENOENT) {
-            DEBUG_LOG(rm, "Warning: failed to open cgroup file %s: %s\n", path, strerror(errno));
+            LOG_DEBUG("failed to open cgroup file %s: %s", path, strerror(errno));
         }
         return -1;
     }
     ssize_t read_bytes = read(fd, buffer, size - 1);
     if (read_bytes == -1) {
-        DEBUG_LOG(rm, "Warning: failed to read from cgroup file %s: %s\n", path, strerror(errno));
+        LOG_DEBUG("failed to read from cgroup file %s: %s", path, strerror(errno));
         close(fd);
         return -1;
     }
@@ -234,6 +234,12 @@ int resource_manager_init(resource_manager_t *rm, const char *base_path) {
 int resource_manager_create_cgroup(resource_manager_t *rm,
                                   const char *container_id,
                                   const resource_limits_t *limits) {
+    if (resource_manager_make_cgroup(rm, container_id) != 0) {
+        return -1;
+    }
+    return resource_manager_apply_limits(rm, container_id, limits);
+}
+int resource_manager_make_cgroup(resource_manager_t *rm, const char *container_id) {
     if (!rm || !rm->initialized || !container_id) {
         return -1;
     }
@@ -261,6 +267,18 @@ int resource_manager_create_cgroup(resource_manager_t *rm,
             perror("mkdir memory cgroup failed");
             return -1;
         }
+        snprintf(path, sizeof(path), "%s/%s_%s", FREEZER_CGROUP_PATH, rm->cgroup_path, container_id);
+        if (access(FREEZER_CGROUP_PATH, F_OK) == 0 && mkdir(path, 0755) == -1 && errno != EEXIST) {
+            LOG_WARN("failed to create freezer cgroup %s: %s", path, strerror(errno));
+        }
+    }
+    return 0;
+}
+int resource_manager_apply_limits(resource_manager_t *rm,
+                                  const char *container_id,
+                                  const resource_limits_t *limits) {
+    if (!rm || !rm->initialized || !container_id || !limits) {
+        return -1;
     }
     if (limits->cpu.shares > 0 || limits->cpu.quota_us > 0) {
         if (set_cpu_limits(rm, container_id, &limits->cpu) != 0) {
@@ -309,51 +327,100 @@ int resource_manager_add_process(resource_manager_t *rm,
     snprintf(pid_str, sizeof(pid_str), "%d", pid);
     if (rm->version == CGROUP_V2) {
         snprintf(path, sizeof(path), "%s/%s_%s/cgroup.procs", CGROUP_ROOT, rm->cgroup_path, container_id);
-        DEBUG_LOG(rm, "Debug: Adding process %d to cgroup v2: %s\n", pid, path);
+        LOG_DEBUG("Adding process %d to cgroup v2: %s", pid, path);
         if (write_file(path, pid_str, rm) != 0) {
-            DEBUG_LOG(rm, "Warning: failed to add process %d to cgroup v2: %s (errno=%d: %s)\n", pid, path, errno, strerror(errno));
+            LOG_WARN("failed to add process %d to cgroup v2: %s (errno=%d: %s)", pid, path, errno, strerror(errno));
             return -1;
         }
-        DEBUG_LOG(rm, "Debug: Successfully added process %d to cgroup v2\n", pid);
+        LOG_DEBUG("Successfully added process %d to cgroup v2", pid);
     } else {
         int added = 0;
         snprintf(path, sizeof(path), "%s/%s_%s/tasks", CPU_CPUACCT_CGROUP_PATH, rm->cgroup_path, container_id);
-        DEBUG_LOG(rm, "Debug: Trying to add process %d to cgroup v1: %s\n", pid, path);
+        LOG_DEBUG("Trying to add process %d to cgroup v1: %s", pid, path);
         if (add_all_threads_to_cgroup(rm, container_id, pid, path) == 0) {
             added = 1;
-            DEBUG_LOG(rm, "Debug: Successfully added process %d threads to cpu,cpuacct cgroup\n", pid);
+            LOG_DEBUG("Successfully added process %d threads to cpu,cpuacct cgroup", pid);
         } else {
-            DEBUG_LOG(rm, "Debug: Failed to add to cpu,cpuacct (errno=%d: %s), trying fallback...\n", errno, strerror(errno));
+            LOG_DEBUG("Failed to add to cpu,cpuacct (errno=%d: %s), trying fallback...", errno, strerror(errno));
             snprintf(path, sizeof(path), "%s/%s_%s/tasks", CPU_CGROUP_PATH, rm->cgroup_path, container_id);
             if (add_all_threads_to_cgroup(rm, container_id, pid, path) == 0) {
                 added = 1;
-                DEBUG_LOG(rm, "Debug: Successfully added process %d threads to CPU cgroup\n", pid);
+                LOG_DEBUG("Successfully added process %d threads to CPU cgroup", pid);
             } else {
-                DEBUG_LOG(rm, "Warning: failed to add process %d threads to CPU cgroup: %s (errno=%d: %s)\n", pid, path, errno, strerror(errno));
+                LOG_WARN("failed to add process %d threads to CPU cgroup: %s (errno=%d: %s)", pid, path, errno, strerror(errno));
             }
             snprintf(path, sizeof(path), "%s/%s_%s/tasks", CPUACCT_CGROUP_PATH, rm->cgroup_path, container_id);
             if (add_all_threads_to_cgroup(rm, container_id, pid, path) == 0) {
                 added = 1;
-                DEBUG_LOG(rm, "Debug: Successfully added process %d threads to cpuacct cgroup\n", pid);
+                LOG_DEBUG("Successfully added process %d threads to cpuacct cgroup", pid);
             } else {
-                DEBUG_LOG(rm, "Debug: Failed to add to cpuacct cgroup (errno=%d: %s)\n", errno, strerror(errno));
+                LOG_DEBUG("Failed to add to cpuacct cgroup (errno=%d: %s)", errno, strerror(errno));
             }
         }
         if (!added) {
-            DEBUG_LOG(rm, "Warning: failed to add process %d to any CPU cgroup\n", pid);
+            LOG_WARN("failed to add process %d to any CPU cgroup", pid);
             return -1;
         }
         snprintf(path, sizeof(path), "%s/%s_%s/tasks", MEMORY_CGROUP_PATH, rm->cgroup_path, container_id);
-        DEBUG_LOG(rm, "Debug: Adding process %d threads to memory cgroup: %s\n", pid, path);
+        LOG_DEBUG("Adding process %d threads to memory cgroup: %s", pid, path);
         if (add_all_threads_to_cgroup(rm, container_id, pid, path) != 0) {
-            DEBUG_LOG(rm, "Warning: failed to add process %d threads to memory cgroup: %s (errno=%d: %s)\n", pid, path, errno, strerror(errno));
+            LOG_WARN("failed to add process %d threads to memory cgroup: %s (errno=%d: %s)", pid, path, errno, strerror(errno));
             return -1;
         } else {
-            DEBUG_LOG(rm, "Debug: Successfully added process %d threads to memory cgroup\n", pid);
+            LOG_DEBUG("Successfully added process %d threads to memory cgroup", pid);
+        }
+        snprintf(path, sizeof(path), "%s/%s_%s/tasks", FREEZER_CGROUP_PATH, rm->cgroup_path, container_id);
+        if (access(path, W_OK) == 0 && add_all_threads_to_cgroup(rm, container_id, pid, path) != 0) {
+            LOG_WARN("failed to add process %d threads to freezer cgroup: %s", pid, path);
         }
     }
     return 0;
 }
+int resource_manager_open_cgroup(resource_manager_t *rm, const char *container_id) {
+    if (!rm || !rm->initialized || !container_id) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (rm->version != CGROUP_V2) {
+        errno = EOPNOTSUPP;
+        return -1;
+    }
+    char path[BUF_SIZE];
+    snprintf(path, sizeof(path), "%s/%s_%s", CGROUP_ROOT, rm->cgroup_path, container_id);
+    return open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+}
+int resource_manager_open_procs(resource_manager_t *rm,
+                               const char *container_id,
+                               int *fds,
+                               int max_fds) {
+    if (!rm || !rm->initialized || !container_id || !fds || max_fds <= 0) {
+        return -1;
+    }
+    static const char *hierarchies[] = {
+        CPU_CPUACCT_CGROUP_PATH, CPU_CGROUP_PATH, CPUACCT_CGROUP_PATH, MEMORY_CGROUP_PATH, FREEZER_CGROUP_PATH
+    };
+    char path[BUF_SIZE];
+    int count = 0;
+    if (rm->version == CGROUP_V2) {
+        snprintf(path, sizeof(path), "%s/%s_%s/cgroup.procs", CGROUP_ROOT, rm->cgroup_path, container_id);
+        fds[count] = open(path, O_WRONLY | O_CLOEXEC);
+        if (fds[count] == -1) {
+            LOG_WARN("failed to open %s: %s", path, strerror(errno));
+            return -1;
+        }
+        return 1;
+    }
+    for (size_t i = 0; i < sizeof(hierarchies) / sizeof(hierarchies[0]) && count < max_fds; i++) {
+        snprintf(path, sizeof(path), "%s/%s_%s/tasks", hierarchies[i], rm->cgroup_path, container_id);
+        int fd = open(path, O_WRONLY | O_CLOEXEC);
+        if (fd != -1) {
+            fds[count++] = fd;
+        } else if (errno != ENOENT) {
+            LOG_WARN("failed to open %s: %s", path, strerror(errno));
+        }
+    }
+    return count;
+}
 int resource_manager_remove_process(resource_manager_t *rm,
                                    const char *container_id,
                                    pid_t pid) {
@@ -380,9 +447,184 @@ int resource_manager_destroy_cgroup(resource_manager_t *rm,
         rmdir(path);
         snprintf(path, sizeof(path), "%s/%s_%s", MEMORY_CGROUP_PATH, rm->cgroup_path, container_id);
         rmdir(path);
+        snprintf(path, sizeof(path), "%s/%s_%s", FREEZER_CGROUP_PATH, rm->cgroup_path, container_id);
+        rmdir(path);
+    }
+    return 0;
+}
+static int rename_cgroup_dir(const char *hierarchy, resource_manager_t *rm,
+                             const char *from_id, const char *to_id) {
+    char from[BUF_SIZE];
+    char to[BUF_SIZE];
+    snprintf(from, sizeof(from), "%s/%s_%s", hierarchy, rm->cgroup_path, from_id);
+    snprintf(to, sizeof(to), "%s/%s_%s", hierarchy, rm->cgroup_path, to_id);
+    if (rename(from, to) == 0 || errno == ENOENT) {
+        return 0;
+    }
+    if ((errno == EEXIST || errno == ENOTEMPTY) && rmdir(to) == 0 && rename(from, to) == 0) {
+        return 0;
+    }
+    fprintf(stderr, "Error: failed to rename cgroup %s to %s: %s\n", from, to, strerror(errno));
+    return -1;
+}
+int resource_manager_rename_cgroup(resource_manager_t *rm,
+                                  const char *from_id,
+                                  const char *to_id) {
+    if (!rm || !rm->initialized || !from_id || !to_id) {
+        return -1;
+    }
+    if (rm->version == CGROUP_V2) {
+        return rename_cgroup_dir(CGROUP_ROOT, rm, from_id, to_id);
+    }
+    const char *hierarchies[] = {
+        CPU_CPUACCT_CGROUP_PATH,
+        CPU_CGROUP_PATH,
+        CPUACCT_CGROUP_PATH,
+        MEMORY_CGROUP_PATH,
+        FREEZER_CGROUP_PATH,
+        nullptr
+    };
+    for (int i = 0; hierarchies[i] != nullptr; i++) {
+        if (rename_cgroup_dir(hierarchies[i], rm, from_id, to_id) != 0) {
+            return -1;
+        }
     }
     return 0;
 }
+static int cgroup_event(int events_fd, const char *key) {
+    char buffer[BUF_SIZE];
+    ssize_t n = pread(events_fd, buffer, sizeof(buffer) - 1, 0);
+    if (n <= 0) {
+        return -1;
+    }
+    buffer[n] = '\0';
+    size_t key_len = strlen(key);
+    for (const char *p = buffer; (p = strstr(p, key)) != nullptr; p += key_len) {
+        if ((p == buffer || p[-1] == '\n') && p[key_len] == ' ') {
+            return atoi(p + key_len + 1);
+        }
+    }
+    return -1;
+}
+static int wait_cgroup_event(int events_fd, const char *key, int value, int timeout_ms) {
+    struct timespec start, now;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    while (true) {
+        int current = cgroup_event(events_fd, key);
+        if (current == value) {
+            return 0;
+        }
+        if (current < 0) {
+            return -1;
+        }
+        int remaining = -1;
+        if (timeout_ms >= 0) {
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            long elapsed = (now.tv_sec - start.tv_sec) * 1000 + (now.tv_nsec - start.tv_nsec) / 1000000;
+            if (elapsed >= timeout_ms) {
+                return 1;
+            }
+            remaining = timeout_ms - (int)elapsed;
+        }
+        struct pollfd pfd;
+        pfd.fd = events_fd;
+        pfd.events = POLLPRI;
+        pfd.revents = 0;
+        if (poll(&pfd, 1, remaining) == -1 && errno != EINTR) {
+            return -1;
+        }
+    }
+}
+int resource_manager_kill(resource_manager_t *rm, const char *container_id, int timeout_ms) {
+    if (!rm || !rm->initialized || !container_id || rm->version != CGROUP_V2) {
+        return -1;
+    }
+    char path[BUF_SIZE];
+    snprintf(path, sizeof(path), "%s/%s_%s/cgroup.kill", CGROUP_ROOT, rm->cgroup_path, container_id);
+    if (access(path, W_OK) != 0) {
+        return -1;
+    }
+    char events_path[BUF_SIZE];
+    snprintf(events_path, sizeof(events_path), "%s/%s_%s/cgroup.events", CGROUP_ROOT, rm->cgroup_path, container_id);
+    int events_fd = open(events_path, O_RDONLY | O_CLOEXEC);
+    if (events_fd == -1) {
+        return -1;
+    }
+    if (write_file(path, "1", rm) != 0) {
+        close(events_fd);
+        return -1;
+    }
+    int ret = wait_cgroup_event(events_fd, "populated", 0, timeout_ms);
+    close(events_fd);
+    return ret;
+}
+static int freeze_v2(resource_manager_t *rm, const char *container_id, int frozen) {
+    char path[BUF_SIZE];
+    snprintf(path, sizeof(path), "%s/%s_%s/cgroup.freeze", CGROUP_ROOT, rm->cgroup_path, container_id);
+    if (write_file(path, frozen ? "1" : "0", rm) != 0) {
+        return -1;
+    }
+    if (!frozen) {
+        return 0;
+    }
+    snprintf(path, sizeof(path), "%s/%s_%s/cgroup.events", CGROUP_ROOT, rm->cgroup_path, container_id);
+    int events_fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (events_fd == -1) {
+        return -1;
+    }
+    int ret = wait_cgroup_event(events_fd, "frozen", 1, FREEZE_TIMEOUT_MS);
+    close(events_fd);
+    return ret;
+}
+static int freeze_v1(resource_manager_t *rm, const char *container_id, int frozen) {
+    char path[BUF_SIZE];
+    snprintf(path, sizeof(path), "%s/%s_%s/freezer.state", FREEZER_CGROUP_PATH, rm->cgroup_path, container_id);
+    if (write_file(path, frozen ? "FROZEN" : "THAWED", rm) != 0) {
+        return -1;
+    }
+    if (!frozen) {
+        return 0;
+    }
+    char buffer[64];
+    for (int waited_ms = 0; waited_ms < FREEZE_TIMEOUT_MS; waited_ms++) {
+        if (read_file(path, buffer, sizeof(buffer), rm) == 0 && strncmp(buffer, "FROZEN", 6) == 0) {
+            return 0;
+        }
+        usleep(1000);
+    }
+    return 1;
+}
+int resource_manager_freeze(resource_manager_t *rm, const char *container_id, int frozen) {
+    if (!rm || !rm->initialized || !container_id) {
+        return -1;
+    }
+    int ret = rm->version == CGROUP_V2 ? freeze_v2(rm, container_id, frozen)
+                                       : freeze_v1(rm, container_id, frozen);
+    if (ret == 1) {
+        fprintf(stderr, "Error: container %s did not freeze within %dms\n", container_id, FREEZE_TIMEOUT_MS);
+        resource_manager_freeze(rm, container_id, 0);
+        return -1;
+    }
+    return ret;
+}
+int resource_manager_oom_kills(resource_manager_t *rm, const char *container_id) {
+    if (!rm || !rm->initialized || !container_id) {
+        return -1;
+    }
+    char path[BUF_SIZE];
+    if (rm->version == CGROUP_V2) {
+        snprintf(path, sizeof(path), "%s/%s_%s/memory.events", CGROUP_ROOT, rm->cgroup_path, container_id);
+    } else {
+        snprintf(path, sizeof(path), "%s/%s_%s/memory.oom_control", MEMORY_CGROUP_PATH, rm->cgroup_path, container_id);
+    }
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return -1;
+    }
+    int count = cgroup_event(fd, "oom_kill");
+    close(fd);
+    return count;
+}
 int resource_manager_get_stats(resource_manager_t *rm,
                               const char *container_id,
                               unsigned long *cpu_usage,
@@ -396,15 +638,15 @@ int resource_manager_get_stats(resource_manager_t *rm,
     char buffer[BUF_SIZE];
     if (cpu_usage) *cpu_usage = 0;
     if (memory_usage) *memory_usage = 0;
-    DEBUG_LOG(rm, "Debug: Getting stats for container %s, cgroup_path=%s, version=%s\n",
+    LOG_TRACE("Getting stats for container %s, cgroup_path=%s, version=%s",
             container_id, rm->cgroup_path, rm->version == CGROUP_V2 ? "v2" : "v1");
     if (rm->version == CGROUP_V2) {
         snprintf(path, sizeof(path), "%s/%s_%s/cgroup.procs", CGROUP_ROOT, rm->cgroup_path, container_id);
         if (read_file(path, buffer, sizeof(buffer), rm) == 0) {
             if (strlen(buffer) > 0 && buffer[0] != '\n' && buffer[0] != '\0') {
-                DEBUG_LOG(rm, "Debug: Found processes in cgroup.procs: '%s'\n", buffer);
+                LOG_TRACE("Found processes in cgroup.procs: '%s'", buffer);
             } else {
-                DEBUG_LOG(rm, "Debug: No processes found in cgroup.procs (container may have finished)\n");
+                LOG_TRACE("No processes found in cgroup.procs (container may have finished)");
             }
         }
     }
@@ -412,12 +654,12 @@ int resource_manager_get_stats(resource_manager_t *rm,
         *cpu_usage = 0;
         if (rm->version == CGROUP_V2) {
             snprintf(path, sizeof(path), "%s/%s_%s/cpu.stat", CGROUP_ROOT, rm->cgroup_path, container_id);
-            DEBUG_LOG(rm, "Debug: Attempting to read cpu.stat from %s\n", path);
+            LOG_TRACE("Attempting to read cpu.stat from %s", path);
             if (read_file(path, buffer, sizeof(buffer), rm) == 0) {
-                DEBUG_LOG(rm, "Debug: Successfully read cpu.stat, content length: %zu, content: '%s'\n", strlen(buffer), buffer);
+                LOG_TRACE("Successfully read cpu.stat, content length: %zu, content: '%s'", strlen(buffer), buffer);
                 char *usage_line = strstr(buffer, "usage_usec");
                 if (usage_line) {
-                    DEBUG_LOG(rm, "Debug: Found usage_usec line in cpu.stat\n");
+                    LOG_TRACE("Found usage_usec line in cpu.stat");
                     char *value_start = usage_line;
                     while (*value_start && *value_start != ' ' && *value_start != '\t') value_start++;
                     while (*value_start && (*value_start == ' ' || *value_start == '\t')) value_start++;
@@ -426,44 +668,44 @@ int resource_manager_get_stats(resource_manager_t *rm,
                         unsigned long val = strtoul(value_start, &endptr, 10);
                         if (endptr != value_start) {
                             *cpu_usage = val * 1000;
-                            DEBUG_LOG(rm, "Debug: Parsed CPU usage from cpu.stat: %lu microseconds = %lu nanoseconds\n", val, *cpu_usage);
+                            LOG_TRACE("Parsed CPU usage from cpu.stat: %lu microseconds = %lu nanoseconds", val, *cpu_usage);
                         } else {
-                            DEBUG_LOG(rm, "Debug: Failed to parse usage_usec value from '%s'\n", value_start);
+                            LOG_TRACE("Failed to parse usage_usec value from '%s'", value_start);
                         }
                     } else {
-                        DEBUG_LOG(rm, "Debug: No value found after usage_usec in cpu.stat\n");
+                        LOG_TRACE("No value found after usage_usec in cpu.stat");
                     }
                 } else {
-                    DEBUG_LOG(rm, "Debug: usage_usec not found in cpu.stat content\n");
+                    LOG_TRACE("usage_usec not found in cpu.stat content");
                 }
             } else {
-                DEBUG_LOG(rm, "Debug: Failed to read cpu.stat from %s (errno=%d: %s)\n", path, errno, strerror(errno));
+                LOG_TRACE("Failed to read cpu.stat from %s (errno=%d: %s)", path, errno, strerror(errno));
             }
         } else {
             char cpuacct_path[BUF_SIZE];
             if (find_cpuacct_usage_path(rm, container_id, cpuacct_path, sizeof(cpuacct_path)) == 0) {
-                DEBUG_LOG(rm, "Debug: Found cpuacct.usage at %s\n", cpuacct_path);
+                LOG_TRACE("Found cpuacct.usage at %s", cpuacct_path);
                 if (read_file(cpuacct_path, buffer, sizeof(buffer), rm) == 0) {
-                    DEBUG_LOG(rm, "Debug: Read from cpuacct.usage: '%s'\n", buffer);
+                    LOG_TRACE("Read from cpuacct.usage: '%s'", buffer);
                     char *endptr;
                     unsigned long val = strtoul(buffer, &endptr, 10);
                     if (endptr != buffer && (*endptr == '\0' || *endptr == '\n' || *endptr == ' ')) {
                         *cpu_usage = val;
-                        DEBUG_LOG(rm, "Debug: Parsed CPU usage: %lu ns\n", val);
+                        LOG_TRACE("Parsed CPU usage: %lu ns", val);
                     } else {
-                        DEBUG_LOG(rm, "Debug: Failed to parse CPU usage from %s: '%s' (endptr='%s')\n", cpuacct_path, buffer, endptr);
+                        LOG_TRACE("Failed to parse CPU usage from %s: '%s' (endptr='%s')", cpuacct_path, buffer, endptr);
                     }
                 } else {
-                    DEBUG_LOG(rm, "Debug: Failed to read cpuacct.usage from %s (errno=%d: %s)\n", cpuacct_path, errno, strerror(errno));
+                    LOG_TRACE("Failed to read cpuacct.usage from %s (errno=%d: %s)", cpuacct_path, errno, strerror(errno));
                 }
             } else {
-                DEBUG_LOG(rm, "Debug: Could not find cpuacct.usage path for container %s\n", container_id);
+                LOG_TRACE("Could not find cpuacct.usage path for container %s", container_id);
                 snprintf(path, sizeof(path), "%s/%s_%s/cpuacct.usage", CPU_CPUACCT_CGROUP_PATH, rm->cgroup_path, container_id);
-                DEBUG_LOG(rm, "Debug: Tried path: %s (exists: %s)\n", path, access(path, F_OK) == 0 ? "yes" : "no");
+                LOG_TRACE("Tried path: %s (exists: %s)", path, access(path, F_OK) == 0 ? "yes" : "no");
                 snprintf(path, sizeof(path), "%s/%s_%s/cpuacct.usage", CPUACCT_CGROUP_PATH, rm->cgroup_path, container_id);
-                DEBUG_LOG(rm, "Debug: Tried path: %s (exists: %s)\n", path, access(path, F_OK) == 0 ? "yes" : "no");
+                LOG_TRACE("Tried path: %s (exists: %s)", path, access(path, F_OK) == 0 ? "yes" : "no");
                 snprintf(path, sizeof(path), "%s/%s_%s/cpuacct.usage", CPU_CGROUP_PATH, rm->cgroup_path, container_id);
-                DEBUG_LOG(rm, "Debug: Tried path: %s (exists: %s)\n", path, access(path, F_OK) == 0 ? "yes" : "no");
+                LOG_TRACE("Tried path: %s (exists: %s)", path, access(path, F_OK) == 0 ? "yes" : "no");
             }
         }
     }
@@ -471,36 +713,36 @@ int resource_manager_get_stats(resource_manager_t *rm,
         *memory_usage = 0;
         if (rm->version == CGROUP_V2) {
             snprintf(path, sizeof(path), "%s/%s_%s/memory.current", CGROUP_ROOT, rm->cgroup_path, container_id);
-            DEBUG_LOG(rm, "Debug: Attempting to read memory.current from %s\n", path);
-            DEBUG_LOG(rm, "Debug: File exists: %s\n", access(path, F_OK) == 0 ? "yes" : "no");
+            LOG_TRACE("Attempting to read memory.current from %s", path);
+            LOG_TRACE("File exists: %s", access(path, F_OK) == 0 ? "yes" : "no");
             if (read_file(path, buffer, sizeof(buffer), rm) == 0) {
-                DEBUG_LOG(rm, "Debug: Successfully read memory.current, content: '%s' (length: %zu)\n", buffer, strlen(buffer));
+                LOG_TRACE("Successfully read memory.current, content: '%s' (length: %zu)", buffer, strlen(buffer));
                 char *endptr;
                 unsigned long val = strtoul(buffer, &endptr, 10);
                 if (endptr != buffer && (*endptr == '\0' || *endptr == '\n' || *endptr == ' ')) {
                     *memory_usage = val;
-                    DEBUG_LOG(rm, "Debug: Parsed memory usage: %lu bytes (%.2f MB)\n", val, val / (1024.0 * 1024.0));
+                    LOG_TRACE("Parsed memory usage: %lu bytes (%.2f MB)", val, val / (1024.0 * 1024.0));
                 } else {
-                    DEBUG_LOG(rm, "Debug: Failed to parse memory usage from %s: '%s' (endptr='%s')\n", path, buffer, endptr);
+                    LOG_TRACE("Failed to parse memory usage from %s: '%s' (endptr='%s')", path, buffer, endptr);
                 }
             } else {
-                DEBUG_LOG(rm, "Debug: Failed to read memory.current from %s (errno=%d: %s)\n", path, errno, strerror(errno));
+                LOG_TRACE("Failed to read memory.current from %s (errno=%d: %s)", path, errno, strerror(errno));
             }
         } else {
             snprintf(path, sizeof(path), "%s/%s_%s/memory.usage_in_bytes", MEMORY_CGROUP_PATH, rm->cgroup_path, container_id);
-            DEBUG_LOG(rm, "Debug: Reading memory from %s (exists: %s)\n", path, access(path, F_OK) == 0 ? "yes" : "no");
+            LOG_TRACE("Reading memory from %s (exists: %s)", path, access(path, F_OK) == 0 ? "yes" : "no");
             if (read_file(path, buffer, sizeof(buffer), rm) == 0) {
-                DEBUG_LOG(rm, "Debug: Read from memory.usage_in_bytes: '%s' (length: %zu)\n", buffer, strlen(buffer));
+                LOG_TRACE("Read from memory.usage_in_bytes: '%s' (length: %zu)", buffer, strlen(buffer));
                 char *endptr;
                 unsigned long val = strtoul(buffer, &endptr, 10);
                 if (endptr != buffer && (*endptr == '\0' || *endptr == '\n' || *endptr == ' ')) {
                     *memory_usage = val;
-                    DEBUG_LOG(rm, "Debug: Parsed memory usage: %lu bytes (%.2f MB)\n", val, val / (1024.0 * 1024.0));
+                    LOG_TRACE("Parsed memory usage: %lu bytes (%.2f MB)", val, val / (1024.0 * 1024.0));
                 } else {
-                    DEBUG_LOG(rm, "Debug: Failed to parse memory usage from %s: '%s' (endptr='%s')\n", path, buffer, endptr);
+                    LOG_TRACE("Failed to parse memory usage from %s: '%s' (endptr='%s')", path, buffer, endptr);
                 }
             } else {
-                DEBUG_LOG(rm, "Debug: Failed to read memory.usage_in_bytes from %s (errno=%d: %s)\n", path, errno, strerror(errno));
+                LOG_TRACE("Failed to read memory.usage_in_bytes from %s (errno=%d: %s)", path, errno, strerror(errno));
             }
         }
     }
@@ -0,0 +1,370 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <climits>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <algorithm>
+#include "../include/rootfs_cache.hpp"
+#include "../include/filesystem_manager.hpp"
+#include "../include/logger.hpp"
+using namespace std;
+struct rootfs_template {
+    unsigned long long bytes;
+    unsigned long long last_used;
+};
+struct rootfs_cache {
+    string dir;
+    unsigned long long budget;
+    map<string, rootfs_template> templates;
+    unsigned long long clock;
+    unsigned long long bytes;
+    unsigned long hits;
+    unsigned long misses;
+    unsigned long evictions;
+    unsigned long seq;
+    int reflink;
+    mutex lock;
+};
+static string recipe_hash(const char *recipe) {
+    unsigned long long h = 14695981039346656037ULL;
+    for (const unsigned char *p = reinterpret_cast<const unsigned char*>(recipe); *p; p++) {
+        h ^= *p;
+        h *= 1099511628211ULL;
+    }
+    char hex[17];
+    snprintf(hex, sizeof(hex), "%016llx", h);
+    return hex;
+}
+static bool read_file(const string &path, string *out) {
+    FILE *fp = fopen(path.c_str(), "re");
+    if (!fp) {
+        return false;
+    }
+    out->clear();
+    char buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), fp)) > 0) {
+        out->append(buffer, n);
+    }
+    bool ok = !ferror(fp);
+    fclose(fp);
+    return ok;
+}
+static int write_file(const string &path, const char *data) {
+    FILE *fp = fopen(path.c_str(), "we");
+    if (!fp) {
+        perror("open recipe failed");
+        return -1;
+    }
+    size_t len = strlen(data);
+    int result = fwrite(data, 1, len, fp) == len ? 0 : -1;
+    if (fclose(fp) != 0) {
+        result = -1;
+    }
+    return result;
+}
+static bool recipe_matches(const string &path, const char *recipe) {
+    string stored;
+    return read_file(path + "/recipe", &stored) && stored == recipe;
+}
+static int clone_file(rootfs_cache_t *cache, int src_dir, int dst_dir, const char *name, const struct stat *st,
+                      int allow_links, int *shared) {
+    if (cache->reflink != 0) {
+        int in = openat(src_dir, name, O_RDONLY | O_CLOEXEC);
+        int out = in == -1 ? -1 : openat(dst_dir, name, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, st->st_mode & 07777);
+        int result = -1, err = errno;
+        if (out != -1) {
+            result = ioctl(out, FICLONE, in);
+            err = errno;
+            if (result == 0) {
+                fchmod(out, st->st_mode & 07777);
+            }
+        }
+        if (in != -1) {
+            close(in);
+        }
+        if (out != -1) {
+            close(out);
+            if (result == 0) {
+                cache->reflink = 1;
+                return 0;
+            }
+            unlinkat(dst_dir, name, 0);
+        }
+        if (err == EOPNOTSUPP || err == ENOTTY || err == EINVAL || err == EBADF) {
+            cache->reflink = 0;
+        }
+    }
+    if (allow_links) {
+        if (linkat(src_dir, name, dst_dir, name, 0) == 0) {
+            *shared = 1;
+            return 0;
+        }
+        if (errno != EXDEV && errno != EMLINK && errno != EPERM) {
+            return -1;
+        }
+    }
+    char src[PATH_MAX], dst[PATH_MAX];
+    snprintf(src, sizeof(src), "/proc/self/fd/%d/%s", src_dir, name);
+    snprintf(dst, sizeof(dst), "/proc/self/fd/%d/%s", dst_dir, name);
+    fs_copy_method_t method;
+    return fs_copy_file(src, dst, &method);
+}
+static int clone_tree(rootfs_cache_t *cache, int src_dir, int dst_dir, int allow_links, int *shared) {
+    DIR *dir = fdopendir(src_dir);
+    if (!dir) {
+        close(src_dir);
+        return -1;
+    }
+    int result = 0;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        const char *name = entry->d_name;
+        if (strcmp(name, ".") == 0 || strcmp(name, "..") == 0) {
+            continue;
+        }
+        struct stat st, existing;
+        if (fstatat(dirfd(dir), name, &st, AT_SYMLINK_NOFOLLOW) == -1) {
+            result = -1;
+            continue;
+        }
+        bool exists = fstatat(dst_dir, name, &existing, AT_SYMLINK_NOFOLLOW) == 0;
+        if (S_ISDIR(st.st_mode)) {
+            if (!exists && mkdirat(dst_dir, name, st.st_mode & 07777) == -1) {
+                result = -1;
+                continue;
+            }
+            int src_child = openat(dirfd(dir), name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+            if (src_child == -1) {
+                result = -1;
+                continue;
+            }
+            int dst_child = openat(dst_dir, name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+            if (dst_child == -1) {
+                close(src_child);
+                result = -1;
+                continue;
+            }
+            if (clone_tree(cache, src_child, dst_child, allow_links, shared) != 0) {
+                result = -1;
+            }
+            close(dst_child);
+            continue;
+        }
+        if (exists) {
+            continue;
+        }
+        if (S_ISLNK(st.st_mode)) {
+            char target[PATH_MAX];
+            ssize_t n = readlinkat(dirfd(dir), name, target, sizeof(target) - 1);
+            if (n < 0) {
+                result = -1;
+                continue;
+            }
+            target[n] = '\0';
+            if (symlinkat(target, dst_dir, name) == -1) {
+                result = -1;
+            }
+        } else if (S_ISCHR(st.st_mode) || S_ISBLK(st.st_mode)) {
+            if (mknodat(dst_dir, name, st.st_mode, st.st_rdev) == -1) {
+                result = -1;
+            }
+        } else if (S_ISREG(st.st_mode)) {
+            if (clone_file(cache, dirfd(dir), dst_dir, name, &st, allow_links, shared) != 0) {
+                result = -1;
+            }
+        }
+    }
+    closedir(dir);
+    return result;
+}
+static void drop_template(rootfs_cache_t *cache, const string &hash) {
+    string path = cache->dir + "/" + hash;
+    char trash[PATH_MAX];
+    snprintf(trash, sizeof(trash), "%s.evict.%d.%lu", path.c_str(), (int)getpid(), ++cache->seq);
+    if (rename(path.c_str(), trash) == 0) {
+        fs_remove_tree(trash);
+    } else {
+        fs_remove_tree(path.c_str());
+    }
+    auto it = cache->templates.find(hash);
+    if (it != cache->templates.end()) {
+        cache->bytes -= it->second.bytes;
+        cache->templates.erase(it);
+    }
+}
+static void evict(rootfs_cache_t *cache, const string &keep) {
+    while (cache->bytes > cache->budget) {
+        auto victim = cache->templates.end();
+        for (auto it = cache->templates.begin(); it != cache->templates.end(); ++it) {
+            if (it->first != keep && (victim == cache->templates.end() || it->second.last_used < victim->second.last_used)) {
+                victim = it;
+            }
+        }
+        if (victim == cache->templates.end()) {
+            return;
+        }
+        string hash = victim->first;
+        LOG_DEBUG("evicting rootfs template %s (%llu bytes)", hash.c_str(), victim->second.bytes);
+        drop_template(cache, hash);
+        cache->evictions++;
+    }
+}
+static void add_template(rootfs_cache_t *cache, const string &hash) {
+    rootfs_template tmpl;
+    tmpl.bytes = 0;
+    fs_tree_usage((cache->dir + "/" + hash + "/root").c_str(), &tmpl.bytes);
+    tmpl.last_used = ++cache->clock;
+    cache->templates[hash] = tmpl;
+    cache->bytes += tmpl.bytes;
+}
+static void scan(rootfs_cache_t *cache) {
+    DIR *dir = opendir(cache->dir.c_str());
+    if (!dir) {
+        return;
+    }
+    vector<pair<long long, string> > found;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        string name = entry->d_name;
+        if (name == "." || name == "..") {
+            continue;
+        }
+        string path = cache->dir + "/" + name;
+        struct stat st;
+        if (name.find('.') != string::npos || stat((path + "/recipe").c_str(), &st) == -1) {
+            fs_remove_tree(path.c_str());
+            continue;
+        }
+        found.push_back(make_pair((long long)st.st_mtime, name));
+    }
+    closedir(dir);
+    sort(found.begin(), found.end());
+    for (size_t i = 0; i < found.size(); i++) {
+        add_template(cache, found[i].second);
+    }
+}
+static int build_template(rootfs_cache_t *cache, const string &hash, const char *recipe, const char *host_root,
+                          const char *const *binaries, int count) {
+    string path = cache->dir + "/" + hash;
+    char tmp[PATH_MAX];
+    snprintf(tmp, sizeof(tmp), "%s.tmp.%d.%lu", path.c_str(), (int)getpid(), ++cache->seq);
+    if (mkdir(tmp, 0755) == -1) {
+        perror("mkdir rootfs template failed");
+        return -1;
+    }
+    string root = string(tmp) + "/root";
+    if (fs_build_container_root(root.c_str(), host_root, binaries, count) != 0 ||
+        write_file(string(tmp) + "/recipe", recipe) != 0) {
+        fs_remove_tree(tmp);
+        return -1;
+    }
+    if (rename(tmp, path.c_str()) == -1) {
+        if ((errno != ENOTEMPTY && errno != EEXIST) || fs_remove_tree(path.c_str()) != 0 ||
+            rename(tmp, path.c_str()) == -1) {
+            perror("rename rootfs template failed");
+            fs_remove_tree(tmp);
+            return -1;
+        }
+    }
+    add_template(cache, hash);
+    return 0;
+}
+rootfs_cache_t *rootfs_cache_create(const char *dir, unsigned long long budget) {
+    if (!dir) {
+        fprintf(stderr, "Error: rootfs cache directory cannot be NULL\n");
+        return nullptr;
+    }
+    if (fs_mkdir_p(dir) != 0) {
+        perror("mkdir rootfs cache failed");
+        return nullptr;
+    }
+    rootfs_cache_t *cache = new rootfs_cache_t();
+    cache->dir = dir;
+    cache->budget = budget;
+    cache->clock = 0;
+    cache->bytes = 0;
+    cache->hits = 0;
+    cache->misses = 0;
+    cache->evictions = 0;
+    cache->seq = 0;
+    cache->reflink = -1;
+    scan(cache);
+    evict(cache, string());
+    LOG_DEBUG("rootfs cache %s: %zu templates, %llu bytes", dir, cache->templates.size(), cache->bytes);
+    return cache;
+}
+void rootfs_cache_destroy(rootfs_cache_t *cache) {
+    delete cache;
+}
+int rootfs_cache_instantiate(rootfs_cache_t *cache, const char *root_path, const char *host_root,
+                             const char *const *binaries, int count, int allow_links, int *shared) {
+    if (!cache || !root_path || !host_root || !shared) {
+        fprintf(stderr, "Error: rootfs cache arguments cannot be NULL\n");
+        return -1;
+    }
+    char *recipe;
+    if (fs_root_recipe(host_root, binaries, count, &recipe) != 0) {
+        return -1;
+    }
+    string hash = recipe_hash(recipe);
+    string path = cache->dir + "/" + hash;
+    lock_guard<mutex> guard(cache->lock);
+    auto it = cache->templates.find(hash);
+    if (it != cache->templates.end() && recipe_matches(path, recipe)) {
+        cache->hits++;
+        it->second.last_used = ++cache->clock;
+        utimensat(AT_FDCWD, (path + "/recipe").c_str(), nullptr, 0);
+    } else {
+        cache->misses++;
+        if (it != cache->templates.end()) {
+            drop_template(cache, hash);
+        }
+        if (build_template(cache, hash, recipe, host_root, binaries, count) != 0) {
+            free(recipe);
+            return -1;
+        }
+        evict(cache, hash);
+    }
+    free(recipe);
+    if (fs_mkdir_p(root_path) != 0) {
+        perror("mkdir container root failed");
+        return -1;
+    }
+    int dst = open(root_path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dst == -1) {
+        perror("open container root failed");
+        return -1;
+    }
+    int src = open((path + "/root").c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (src == -1) {
+        perror("open rootfs template failed");
+        close(dst);
+        return -1;
+    }
+    *shared = 0;
+    int result = clone_tree(cache, src, dst, allow_links, shared);
+    close(dst);
+    return result;
+}
+void rootfs_cache_get_stats(rootfs_cache_t *cache, rootfs_cache_stats_t *stats) {
+    if (!cache || !stats) return;
+    lock_guard<mutex> guard(cache->lock);
+    stats->hits = cache->hits;
+    stats->misses = cache->misses;
+    stats->evictions = cache->evictions;
+    stats->templates = (int)cache->templates.size();
+    stats->bytes = cache->bytes;
+    stats->budget = cache->budget;
+    stats->reflink = cache->reflink;
+}
@@ -0,0 +1,122 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include "../include/slab_allocator.hpp"
+using namespace std;
+#define SLAB_CLASSES 12
+#define SLAB_CHUNK_SIZE (64 * 1024)
+#define SLAB_LARGE_CLASS 0xffffffffu
+#define SLAB_MAGIC 0x534c4142u
+static const size_t slab_class_sizes[SLAB_CLASSES] = {
+    64, 128, 192, 256, 320, 384, 448, 512, 768, 1024, 2048, 4096
+};
+typedef union slab_header {
+    struct {
+        uint32_t size_class;
+        uint32_t magic;
+    } tag;
+    union slab_header *next_free;
+    uint64_t pad;
+} slab_header_t;
+typedef struct slab_chunk {
+    struct slab_chunk *next;
+} slab_chunk_t;
+struct slab_allocator {
+    slab_header_t *free_lists[SLAB_CLASSES];
+    slab_chunk_t *chunks;
+    slab_stats_t stats;
+};
+static unsigned int size_to_class(size_t total) {
+    for (unsigned int c = 0; c < SLAB_CLASSES; c++) {
+        if (total <= slab_class_sizes[c]) {
+            return c;
+        }
+    }
+    return SLAB_LARGE_CLASS;
+}
+static int refill(slab_allocator_t *slab, unsigned int size_class) {
+    size_t block = slab_class_sizes[size_class];
+    size_t header = sizeof(slab_header_t);
+    slab_chunk_t *chunk = static_cast<slab_chunk_t*>(malloc(SLAB_CHUNK_SIZE));
+    if (!chunk) {
+        perror("malloc slab chunk failed");
+        return -1;
+    }
+    chunk->next = slab->chunks;
+    slab->chunks = chunk;
+    slab->stats.chunks++;
+    char *base = reinterpret_cast<char*>(chunk) + header;
+    size_t blocks = (SLAB_CHUNK_SIZE - header) / block;
+    for (size_t i = blocks; i-- > 0;) {
+        slab_header_t *h = reinterpret_cast<slab_header_t*>(base + i * block);
+        h->next_free = slab->free_lists[size_class];
+        slab->free_lists[size_class] = h;
+    }
+    slab->stats.blocks_free += blocks;
+    return 0;
+}
+slab_allocator_t *slab_create(void) {
+    slab_allocator_t *slab = static_cast<slab_allocator_t*>(calloc(1, sizeof(slab_allocator_t)));
+    if (!slab) {
+        perror("calloc slab allocator failed");
+    }
+    return slab;
+}
+void slab_destroy(slab_allocator_t *slab) {
+    if (!slab) return;
+    while (slab->chunks) {
+        slab_chunk_t *next = slab->chunks->next;
+        free(slab->chunks);
+        slab->chunks = next;
+    }
+    free(slab);
+}
+void *slab_alloc(slab_allocator_t *slab, size_t size) {
+    if (!slab) return nullptr;
+    size_t total = sizeof(slab_header_t) + size;
+    unsigned int size_class = size_to_class(total);
+    slab_header_t *h;
+    if (size_class == SLAB_LARGE_CLASS) {
+        h = static_cast<slab_header_t*>(malloc(total));
+        if (!h) {
+            perror("malloc slab block failed");
+            return nullptr;
+        }
+        slab->stats.large_in_use++;
+    } else {
+        if (!slab->free_lists[size_class] && refill(slab, size_class) != 0) {
+            return nullptr;
+        }
+        h = slab->free_lists[size_class];
+        slab->free_lists[size_class] = h->next_free;
+        slab->stats.blocks_free--;
+        slab->stats.blocks_in_use++;
+    }
+    h->tag.size_class = size_class;
+    h->tag.magic = SLAB_MAGIC;
+    return h + 1;
+}
+void slab_free(slab_allocator_t *slab, void *ptr) {
+    if (!slab || !ptr) return;
+    slab_header_t *h = static_cast<slab_header_t*>(ptr) - 1;
+    if (h->tag.magic != SLAB_MAGIC) {
+        fprintf(stderr, "Error: slab_free on foreign pointer %p\n", ptr);
+        return;
+    }
+    unsigned int size_class = h->tag.size_class;
+    h->tag.magic = 0;
+    if (size_class == SLAB_LARGE_CLASS) {
+        slab->stats.large_in_use--;
+        free(h);
+        return;
+    }
+    h->next_free = slab->free_lists[size_class];
+    slab->free_lists[size_class] = h;
+    slab->stats.blocks_in_use--;
+    slab->stats.blocks_free++;
+}
+void slab_get_stats(slab_allocator_t *slab, slab_stats_t *stats) {
+    if (!slab || !stats) return;
+    *stats = slab->stats;
+}
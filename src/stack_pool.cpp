@@ -0,0 +1,100 @@
+#include <cstdio>
+#include <cstring>
+#include <strings.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <vector>
+#include <mutex>
+#include "../include/stack_pool.hpp"
+using namespace std;
+struct stack_pool {
+    size_t stack_size;
+    size_t guard_size;
+    size_t max_cached;
+    stack_prefault_t prefault;
+    mutex lock;
+    vector<void*> free_stacks;
+};
+static size_t round_to_page(size_t size, size_t page) {
+    return (size + page - 1) & ~(page - 1);
+}
+static void *map_stack(stack_pool_t *pool) {
+    size_t total = pool->guard_size + pool->stack_size;
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK | MAP_NORESERVE;
+    if (pool->prefault == STACK_PREFAULT_FULL) {
+        flags |= MAP_POPULATE;
+    }
+    char *region = static_cast<char*>(mmap(nullptr, total, PROT_READ | PROT_WRITE, flags, -1, 0));
+    if (region == MAP_FAILED) {
+        perror("mmap child stack failed");
+        return nullptr;
+    }
+    if (mprotect(region, pool->guard_size, PROT_NONE) == -1) {
+        perror("mprotect stack guard failed");
+        munmap(region, total);
+        return nullptr;
+    }
+    char *stack = region + pool->guard_size;
+    if (pool->prefault == STACK_PREFAULT_TOP) {
+        size_t page = pool->guard_size;
+        size_t bytes = STACK_POOL_PREFAULT_TOP_BYTES < pool->stack_size ? STACK_POOL_PREFAULT_TOP_BYTES : pool->stack_size;
+        for (size_t offset = page; offset <= bytes; offset += page) {
+            stack[pool->stack_size - offset] = 0;
+        }
+    }
+    return stack;
+}
+static void unmap_stack(stack_pool_t *pool, void *stack) {
+    munmap(static_cast<char*>(stack) - pool->guard_size, pool->guard_size + pool->stack_size);
+}
+stack_pool_t *stack_pool_create(size_t stack_size, int max_cached, stack_prefault_t prefault) {
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    if (stack_size == 0) {
+        return nullptr;
+    }
+    stack_pool_t *pool = new stack_pool();
+    pool->guard_size = page;
+    pool->stack_size = round_to_page(stack_size, page);
+    pool->max_cached = max_cached > 0 ? (size_t)max_cached : 0;
+    pool->prefault = prefault;
+    pool->free_stacks.reserve(pool->max_cached);
+    return pool;
+}
+void stack_pool_destroy(stack_pool_t *pool) {
+    if (!pool) return;
+    for (size_t i = 0; i < pool->free_stacks.size(); i++) {
+        unmap_stack(pool, pool->free_stacks[i]);
+    }
+    delete pool;
+}
+void *stack_pool_acquire(stack_pool_t *pool) {
+    if (!pool) return nullptr;
+    {
+        lock_guard<mutex> guard(pool->lock);
+        if (!pool->free_stacks.empty()) {
+            void *stack = pool->free_stacks.back();
+            pool->free_stacks.pop_back();
+            return stack;
+        }
+    }
+    return map_stack(pool);
+}
+void stack_pool_release(stack_pool_t *pool, void *stack) {
+    if (!pool || !stack) return;
+    {
+        lock_guard<mutex> guard(pool->lock);
+        if (pool->free_stacks.size() < pool->max_cached) {
+            pool->free_stacks.push_back(stack);
+            return;
+        }
+    }
+    unmap_stack(pool, stack);
+}
+size_t stack_pool_stack_size(const stack_pool_t *pool) {
+    return pool ? pool->stack_size : 0;
+}
+stack_prefault_t stack_prefault_parse(const char *name) {
+    if (name && strcasecmp(name, "top") == 0) return STACK_PREFAULT_TOP;
+    if (name && strcasecmp(name, "full") == 0) return STACK_PREFAULT_FULL;
+    return STACK_PREFAULT_NONE;
+}
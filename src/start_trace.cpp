@@ -0,0 +1,78 @@
+#include <cstring>
+#include <ctime>
+#include "../include/start_trace.hpp"
+using namespace std;
+uint64_t start_trace_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+void start_trace_begin(start_trace_t *trace) {
+    if (!trace) return;
+    memset(trace, 0, sizeof(*trace));
+    trace->begin_ns = start_trace_now();
+}
+void start_trace_finish(start_trace_t *trace) {
+    if (!trace || trace->begin_ns == 0) return;
+    trace->phase_ns[START_PHASE_TOTAL] = start_trace_now() - trace->begin_ns;
+}
+const char *start_phase_name(int phase) {
+    static const char *names[] = {
+        "cgroup_mkdir", "cgroup_limits", "rootfs_create", "rootfs_populate",
+        "clone", "cgroup_attach", "mount_setup", "exec", "total"
+    };
+    if (phase < 0 || phase >= START_PHASE_COUNT) {
+        return "unknown";
+    }
+    return names[phase];
+}
+static int bucket_index(uint64_t value) {
+    if (value < START_HISTOGRAM_SUB_BUCKETS) {
+        return (int)value;
+    }
+    int exponent = 63 - __builtin_clzll(value);
+    int sub = (int)((value >> (exponent - 2)) & (START_HISTOGRAM_SUB_BUCKETS - 1));
+    return (exponent - 1) * START_HISTOGRAM_SUB_BUCKETS + sub;
+}
+static uint64_t bucket_upper_bound(int index) {
+    if (index < START_HISTOGRAM_SUB_BUCKETS) {
+        return (uint64_t)index;
+    }
+    int exponent = index / START_HISTOGRAM_SUB_BUCKETS + 1;
+    uint64_t sub = (uint64_t)(index % START_HISTOGRAM_SUB_BUCKETS);
+    uint64_t width = 1ULL << (exponent - 2);
+    return (1ULL << exponent) + (sub + 1) * width - 1;
+}
+void start_histogram_init(start_histogram_t *histogram) {
+    if (!histogram) return;
+    memset(histogram, 0, sizeof(*histogram));
+}
+void start_histogram_record(start_histogram_t *histogram, const start_trace_t *trace) {
+    if (!histogram || !trace) return;
+    for (int phase = 0; phase < START_PHASE_COUNT; phase++) {
+        if (trace->pooled && phase != START_PHASE_TOTAL) continue;
+        histogram->buckets[phase][bucket_index(trace->phase_ns[phase])]++;
+    }
+    histogram->count++;
+}
+uint64_t start_histogram_percentile(const start_histogram_t *histogram, int phase, double percentile) {
+    if (!histogram || histogram->count == 0 || phase < 0 || phase >= START_PHASE_COUNT) {
+        return 0;
+    }
+    uint64_t samples = 0;
+    for (int i = 0; i < START_HISTOGRAM_BUCKETS; i++) {
+        samples += histogram->buckets[phase][i];
+    }
+    if (samples == 0) return 0;
+    uint64_t rank = (uint64_t)(percentile / 100.0 * (double)samples + 0.5);
+    if (rank == 0) rank = 1;
+    if (rank > samples) rank = samples;
+    uint64_t seen = 0;
+    for (int i = 0; i < START_HISTOGRAM_BUCKETS; i++) {
+        seen += histogram->buckets[phase][i];
+        if (seen >= rank) {
+            return bucket_upper_bound(i);
+        }
+    }
+    return bucket_upper_bound(START_HISTOGRAM_BUCKETS - 1);
+}
@@ -0,0 +1,404 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <cstddef>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
+#include "../include/state_journal.hpp"
+#include "../include/state_snapshot.hpp"
+using namespace std;
+#define STATE_RECORD_MAGIC 0x524a434du
+#define STATE_RECORD_VERSION 1
+#define JOURNAL_SYNC_BATCH 32
+#define JOURNAL_SYNC_INTERVAL_MS 50
+#define JOURNAL_COMPACT_MIN_RECORDS 1024
+struct state_journal {
+    string snapshot_path;
+    string journal_path;
+    string rotated_path;
+    int fd;
+    uint64_t next_sequence;
+    int journal_records;
+    int unsynced;
+    bool compacting;
+    bool has_job;
+    bool shutdown;
+    vector<state_record_t> job_records;
+    uint64_t job_sequence;
+    mutex lock;
+    condition_variable cond;
+    thread worker;
+};
+static uint32_t record_checksum(const state_record_t *record) {
+    const unsigned char *p = reinterpret_cast<const unsigned char*>(record);
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < offsetof(state_record_t, checksum); i++) {
+        h ^= p[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+static bool record_valid(const state_record_t *record) {
+    return record->magic == STATE_RECORD_MAGIC &&
+           record->version == STATE_RECORD_VERSION &&
+           (record->op == STATE_RECORD_UPSERT || record->op == STATE_RECORD_REMOVE) &&
+           record->checksum == record_checksum(record);
+}
+static off_t replay_journal(int fd, uint64_t after_sequence, vector<state_record_t> &out,
+                            uint64_t *max_sequence) {
+    off_t valid_end = 0;
+    state_record_t rec;
+    while (pread(fd, &rec, sizeof(rec), valid_end) == (ssize_t)sizeof(rec)) {
+        if (!record_valid(&rec)) {
+            break;
+        }
+        valid_end += sizeof(rec);
+        if (rec.sequence > *max_sequence) {
+            *max_sequence = rec.sequence;
+        }
+        if (rec.sequence > after_sequence) {
+            out.push_back(rec);
+        }
+    }
+    return valid_end;
+}
+static void fold_records(const vector<state_record_t> &log, vector<state_record_t> &live) {
+    if (log.empty()) {
+        return;
+    }
+    unordered_map<string, size_t> positions;
+    positions.reserve(live.size() + log.size());
+    for (size_t i = 0; i < live.size(); i++) {
+        positions[string(live[i].id)] = i;
+    }
+    vector<bool> removed(live.size(), false);
+    for (size_t i = 0; i < log.size(); i++) {
+        const state_record_t &rec = log[i];
+        string key(rec.id);
+        auto it = positions.find(key);
+        if (rec.op == STATE_RECORD_REMOVE) {
+            if (it != positions.end()) {
+                removed[it->second] = true;
+                positions.erase(it);
+            }
+        } else if (it != positions.end()) {
+            live[it->second] = rec;
+        } else {
+            positions[key] = live.size();
+            live.push_back(rec);
+            removed.push_back(false);
+        }
+    }
+    size_t kept = 0;
+    for (size_t i = 0; i < live.size(); i++) {
+        if (!removed[i]) {
+            live[kept++] = live[i];
+        }
+    }
+    live.resize(kept);
+}
+static void compactor_thread(state_journal_t *journal) {
+    unique_lock<mutex> guard(journal->lock);
+    while (true) {
+        journal->cond.wait_for(guard, chrono::milliseconds(JOURNAL_SYNC_INTERVAL_MS), [journal]() {
+            return journal->has_job || journal->shutdown;
+        });
+        if (journal->unsynced > 0 && journal->fd != -1) {
+            fdatasync(journal->fd);
+            journal->unsynced = 0;
+        }
+        if (journal->has_job) {
+            vector<state_record_t> records;
+            records.swap(journal->job_records);
+            uint64_t sequence = journal->job_sequence;
+            journal->has_job = false;
+            guard.unlock();
+            if (state_snapshot_write(journal->snapshot_path.c_str(), records.data(), (int)records.size(), sequence) == 0) {
+                unlink(journal->rotated_path.c_str());
+            }
+            guard.lock();
+            journal->compacting = false;
+            journal->cond.notify_all();
+        }
+        if (journal->shutdown) {
+            break;
+        }
+    }
+}
+static int lock_journal(int fd, const char *journal_path) {
+    if (flock(fd, LOCK_EX | LOCK_NB) == 0) {
+        return 0;
+    }
+    if (errno == EWOULDBLOCK) {
+        fprintf(stderr, "Error: state journal %s is held by another container manager\n", journal_path);
+    } else {
+        fprintf(stderr, "Error: failed to lock state journal %s: %s\n", journal_path, strerror(errno));
+    }
+    return -1;
+}
+static int append_journal(int fd, const char *rotated_path) {
+    int out = open(rotated_path, O_WRONLY | O_APPEND | O_CLOEXEC);
+    if (out == -1) {
+        return -1;
+    }
+    char buf[65536];
+    off_t offset = 0;
+    ssize_t n;
+    while ((n = pread(fd, buf, sizeof(buf), offset)) > 0) {
+        if (write(out, buf, n) != n) {
+            n = -1;
+            break;
+        }
+        offset += n;
+    }
+    int result = n == 0 && fdatasync(out) == 0 ? 0 : -1;
+    close(out);
+    return result;
+}
+void state_record_init(state_record_t *record, state_record_op_t op, const char *id) {
+    if (!record) return;
+    memset(record, 0, sizeof(*record));
+    record->magic = STATE_RECORD_MAGIC;
+    record->version = STATE_RECORD_VERSION;
+    record->op = (uint16_t)op;
+    if (id) {
+        strncpy(record->id, id, STATE_RECORD_ID_MAX - 1);
+    }
+}
+state_journal_t *state_journal_open(const char *snapshot_path, const char *journal_path) {
+    if (!snapshot_path || !journal_path) {
+        return nullptr;
+    }
+    int fd = open(journal_path, O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd == -1) {
+        fprintf(stderr, "Warning: failed to open state journal %s: %s\n", journal_path, strerror(errno));
+        return nullptr;
+    }
+    if (lock_journal(fd, journal_path) != 0) {
+        close(fd);
+        return nullptr;
+    }
+    state_journal_t *journal = new state_journal();
+    journal->snapshot_path = snapshot_path;
+    journal->journal_path = journal_path;
+    journal->rotated_path = string(journal_path) + ".1";
+    journal->fd = fd;
+    journal->next_sequence = 1;
+    journal->journal_records = 0;
+    journal->unsynced = 0;
+    journal->compacting = false;
+    journal->has_job = false;
+    journal->shutdown = false;
+    journal->job_sequence = 0;
+    journal->worker = thread(compactor_thread, journal);
+    return journal;
+}
+int state_journal_load(state_journal_t *journal, state_record_t **records, int *count) {
+    if (!journal || !records || !count) {
+        return -1;
+    }
+    *records = nullptr;
+    *count = 0;
+    lock_guard<mutex> guard(journal->lock);
+    vector<state_record_t> live;
+    uint64_t snapshot_sequence = 0;
+    state_snapshot_t snapshot;
+    if (state_snapshot_open(&snapshot, journal->snapshot_path.c_str()) == 0) {
+        int snapshot_count = state_snapshot_count(&snapshot);
+        snapshot_sequence = state_snapshot_sequence(&snapshot);
+        live.resize(snapshot_count);
+        int loaded = 0;
+        for (int i = 0; i < snapshot_count; i++) {
+            if (state_snapshot_get(&snapshot, i, &live[loaded]) == 0) {
+                loaded++;
+            }
+        }
+        live.resize(loaded);
+        state_snapshot_close(&snapshot);
+    }
+    vector<state_record_t> log;
+    uint64_t max_sequence = snapshot_sequence;
+    bool had_rotated = false;
+    int rotated_fd = open(journal->rotated_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (rotated_fd != -1) {
+        had_rotated = true;
+        replay_journal(rotated_fd, snapshot_sequence, log, &max_sequence);
+        close(rotated_fd);
+    }
+    off_t valid_end = replay_journal(journal->fd, snapshot_sequence, log, &max_sequence);
+    struct stat st;
+    if (fstat(journal->fd, &st) == 0 && st.st_size > valid_end) {
+        fprintf(stderr, "Warning: discarding %lld bytes of torn state journal\n",
+                (long long)(st.st_size - valid_end));
+        if (ftruncate(journal->fd, valid_end) == -1) {
+            perror("ftruncate state journal failed");
+        }
+    }
+    journal->next_sequence = max_sequence + 1;
+    journal->journal_records = (int)log.size();
+    fold_records(log, live);
+    if (had_rotated) {
+        if (state_snapshot_write(journal->snapshot_path.c_str(), live.data(), (int)live.size(), max_sequence) == 0) {
+            unlink(journal->rotated_path.c_str());
+            if (ftruncate(journal->fd, 0) == 0) {
+                journal->journal_records = 0;
+            }
+        }
+    }
+    if (live.empty()) {
+        return 0;
+    }
+    *records = static_cast<state_record_t*>(malloc(live.size() * sizeof(state_record_t)));
+    if (!*records) {
+        perror("malloc state records failed");
+        return -1;
+    }
+    memcpy(*records, live.data(), live.size() * sizeof(state_record_t));
+    *count = (int)live.size();
+    return 0;
+}
+int state_journal_append(state_journal_t *journal, state_record_t *record) {
+    if (!journal || !record) {
+        return -1;
+    }
+    lock_guard<mutex> guard(journal->lock);
+    record->magic = STATE_RECORD_MAGIC;
+    record->version = STATE_RECORD_VERSION;
+    record->sequence = journal->next_sequence++;
+    record->checksum = record_checksum(record);
+    if (write(journal->fd, record, sizeof(*record)) != (ssize_t)sizeof(*record)) {
+        fprintf(stderr, "Error: failed to append to state journal: %s\n", strerror(errno));
+        return -1;
+    }
+    journal->journal_records++;
+    if (++journal->unsynced >= JOURNAL_SYNC_BATCH) {
+        fdatasync(journal->fd);
+        journal->unsynced = 0;
+    }
+    return 0;
+}
+int state_journal_append_batch(state_journal_t *journal, state_record_t *records, int count) {
+    if (!journal || count < 0 || (count > 0 && !records)) {
+        return -1;
+    }
+    if (count == 0) {
+        return 0;
+    }
+    lock_guard<mutex> guard(journal->lock);
+    for (int i = 0; i < count; i++) {
+        records[i].magic = STATE_RECORD_MAGIC;
+        records[i].version = STATE_RECORD_VERSION;
+        records[i].sequence = journal->next_sequence++;
+        records[i].checksum = record_checksum(&records[i]);
+    }
+    size_t len = count * sizeof(state_record_t);
+    if (write(journal->fd, records, len) != (ssize_t)len) {
+        fprintf(stderr, "Error: failed to append to state journal: %s\n", strerror(errno));
+        return -1;
+    }
+    journal->journal_records += count;
+    journal->unsynced += count;
+    return 0;
+}
+int state_journal_sync(state_journal_t *journal) {
+    if (!journal) {
+        return -1;
+    }
+    lock_guard<mutex> guard(journal->lock);
+    if (journal->unsynced == 0) {
+        return 0;
+    }
+    journal->unsynced = 0;
+    return fdatasync(journal->fd);
+}
+int state_journal_should_compact(state_journal_t *journal, int live_count) {
+    if (!journal) {
+        return 0;
+    }
+    lock_guard<mutex> guard(journal->lock);
+    int threshold = live_count * 2;
+    if (threshold < JOURNAL_COMPACT_MIN_RECORDS) {
+        threshold = JOURNAL_COMPACT_MIN_RECORDS;
+    }
+    return !journal->compacting && journal->journal_records >= threshold;
+}
+int state_journal_compact(state_journal_t *journal, const state_record_t *records,
+                          int count, int wait) {
+    if (!journal || (count > 0 && !records)) {
+        return -1;
+    }
+    unique_lock<mutex> guard(journal->lock);
+    if (journal->compacting) {
+        if (!wait) {
+            return 0;
+        }
+        journal->cond.wait(guard, [journal]() { return !journal->compacting; });
+    }
+    fdatasync(journal->fd);
+    journal->unsynced = 0;
+    if (access(journal->rotated_path.c_str(), F_OK) == 0) {
+        if (append_journal(journal->fd, journal->rotated_path.c_str()) != 0) {
+            fprintf(stderr, "Error: failed to append state journal to %s: %s\n",
+                    journal->rotated_path.c_str(), strerror(errno));
+            return -1;
+        }
+        if (ftruncate(journal->fd, 0) == -1) {
+            fprintf(stderr, "Error: failed to truncate state journal: %s\n", strerror(errno));
+            return -1;
+        }
+    } else {
+        if (rename(journal->journal_path.c_str(), journal->rotated_path.c_str()) == -1) {
+            fprintf(stderr, "Error: failed to rotate state journal: %s\n", strerror(errno));
+            return -1;
+        }
+        int fd = open(journal->journal_path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644);
+        if (fd == -1 || lock_journal(fd, journal->journal_path.c_str()) != 0) {
+            if (fd == -1) {
+                fprintf(stderr, "Error: failed to reopen state journal: %s\n", strerror(errno));
+            } else {
+                close(fd);
+            }
+            rename(journal->rotated_path.c_str(), journal->journal_path.c_str());
+            return -1;
+        }
+        close(journal->fd);
+        journal->fd = fd;
+    }
+    journal->journal_records = 0;
+    journal->job_records.assign(records, records + count);
+    journal->job_sequence = journal->next_sequence - 1;
+    journal->has_job = true;
+    journal->compacting = true;
+    journal->cond.notify_all();
+    if (wait) {
+        journal->cond.wait(guard, [journal]() { return !journal->compacting; });
+    }
+    return 0;
+}
+void state_journal_close(state_journal_t *journal) {
+    if (!journal) return;
+    {
+        lock_guard<mutex> guard(journal->lock);
+        journal->shutdown = true;
+        journal->cond.notify_all();
+    }
+    if (journal->worker.joinable()) {
+        journal->worker.join();
+    }
+    if (journal->fd != -1) {
+        fdatasync(journal->fd);
+        close(journal->fd);
+    }
+    delete journal;
+}
@@ -0,0 +1,222 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <cstddef>
+#include <unistd.h>
+#include <fcntl.h>
+#include <libgen.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <string>
+#include <vector>
+#include "../include/state_snapshot.hpp"
+using namespace std;
+#define STATE_SNAPSHOT_MAGIC 0x50534d4du
+static uint32_t header_checksum(const state_snapshot_header_t *header) {
+    const unsigned char *p = reinterpret_cast<const unsigned char*>(header);
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < offsetof(state_snapshot_header_t, checksum); i++) {
+        h ^= p[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+static int fsync_parent_dir(const char *path) {
+    string copy = path;
+    int dir_fd = open(dirname(&copy[0]), O_RDONLY | O_DIRECTORY);
+    if (dir_fd == -1) {
+        return -1;
+    }
+    int ret = fsync(dir_fd);
+    close(dir_fd);
+    return ret;
+}
+static int write_all(int fd, const void *buf, size_t len) {
+    const char *p = static_cast<const char*>(buf);
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        p += n;
+        len -= n;
+    }
+    return 0;
+}
+int state_snapshot_open(state_snapshot_t *snapshot, const char *path) {
+    if (!snapshot || !path) {
+        return -1;
+    }
+    memset(snapshot, 0, sizeof(*snapshot));
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == -1 || (size_t)st.st_size < sizeof(state_snapshot_header_t)) {
+        close(fd);
+        fprintf(stderr, "Warning: state snapshot %s is truncated\n", path);
+        return -1;
+    }
+    void *base = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        perror("mmap state snapshot failed");
+        return -1;
+    }
+    const state_snapshot_header_t *header = static_cast<const state_snapshot_header_t*>(base);
+    uint64_t records_end = sizeof(state_snapshot_header_t) + (uint64_t)header->record_count * header->record_size;
+    if (header->magic != STATE_SNAPSHOT_MAGIC ||
+        header->version == 0 || header->version > STATE_SNAPSHOT_VERSION ||
+        header->record_size < sizeof(state_snapshot_record_t) ||
+        header->checksum != header_checksum(header) ||
+        header->strings_offset < records_end ||
+        header->strings_offset + header->strings_size != (uint64_t)st.st_size) {
+        fprintf(stderr, "Warning: state snapshot %s is invalid\n", path);
+        munmap(base, st.st_size);
+        return -1;
+    }
+    snapshot->base = base;
+    snapshot->size = st.st_size;
+    snapshot->header = header;
+    snapshot->records = static_cast<const unsigned char*>(base) + sizeof(state_snapshot_header_t);
+    snapshot->strings = static_cast<const char*>(base) + header->strings_offset;
+    return 0;
+}
+int state_snapshot_count(const state_snapshot_t *snapshot) {
+    return (snapshot && snapshot->header) ? (int)snapshot->header->record_count : 0;
+}
+uint64_t state_snapshot_sequence(const state_snapshot_t *snapshot) {
+    return (snapshot && snapshot->header) ? snapshot->header->sequence : 0;
+}
+int state_snapshot_get(const state_snapshot_t *snapshot, int index, state_record_t *record) {
+    if (!snapshot || !snapshot->header || !record || index < 0 ||
+        index >= (int)snapshot->header->record_count) {
+        return -1;
+    }
+    const state_snapshot_record_t *src = reinterpret_cast<const state_snapshot_record_t*>(
+        snapshot->records + (size_t)index * snapshot->header->record_size);
+    if (src->id_length == 0 || src->id_length >= STATE_RECORD_ID_MAX ||
+        (uint64_t)src->id_offset + src->id_length > snapshot->header->strings_size) {
+        return -1;
+    }
+    state_record_init(record, STATE_RECORD_UPSERT, nullptr);
+    memcpy(record->id, snapshot->strings + src->id_offset, src->id_length);
+    record->pid = src->pid;
+    record->state = src->state;
+    record->created_at = src->created_at;
+    record->started_at = src->started_at;
+    record->stopped_at = src->stopped_at;
+    return 0;
+}
+void state_snapshot_close(state_snapshot_t *snapshot) {
+    if (!snapshot || !snapshot->base) return;
+    munmap(snapshot->base, snapshot->size);
+    memset(snapshot, 0, sizeof(*snapshot));
+}
+int state_snapshot_write(const char *path, const state_record_t *records, int count, uint64_t sequence) {
+    if (!path || count < 0 || (count > 0 && !records)) {
+        return -1;
+    }
+    vector<state_snapshot_record_t> table(count);
+    string strings;
+    for (int i = 0; i < count; i++) {
+        size_t len = strnlen(records[i].id, STATE_RECORD_ID_MAX - 1);
+        table[i].id_offset = (uint32_t)strings.size();
+        table[i].id_length = (uint32_t)len;
+        table[i].pid = records[i].pid;
+        table[i].state = records[i].state;
+        table[i].created_at = records[i].created_at;
+        table[i].started_at = records[i].started_at;
+        table[i].stopped_at = records[i].stopped_at;
+        strings.append(records[i].id, len);
+        strings.push_back('\0');
+    }
+    state_snapshot_header_t header;
+    memset(&header, 0, sizeof(header));
+    header.magic = STATE_SNAPSHOT_MAGIC;
+    header.version = STATE_SNAPSHOT_VERSION;
+    header.record_size = sizeof(state_snapshot_record_t);
+    header.record_count = (uint32_t)count;
+    header.sequence = sequence;
+    header.strings_offset = sizeof(header) + (uint64_t)count * sizeof(state_snapshot_record_t);
+    header.strings_size = strings.size();
+    header.checksum = header_checksum(&header);
+    string tmp_path = string(path) + ".tmp";
+    int fd = open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd == -1) {
+        fprintf(stderr, "Error: failed to open %s: %s\n", tmp_path.c_str(), strerror(errno));
+        return -1;
+    }
+    if (write_all(fd, &header, sizeof(header)) != 0 ||
+        write_all(fd, table.data(), table.size() * sizeof(state_snapshot_record_t)) != 0 ||
+        write_all(fd, strings.data(), strings.size()) != 0 ||
+        fsync(fd) != 0) {
+        fprintf(stderr, "Error: failed to write %s: %s\n", tmp_path.c_str(), strerror(errno));
+        close(fd);
+        unlink(tmp_path.c_str());
+        return -1;
+    }
+    close(fd);
+    if (rename(tmp_path.c_str(), path) == -1) {
+        fprintf(stderr, "Error: failed to replace %s: %s\n", path, strerror(errno));
+        unlink(tmp_path.c_str());
+        return -1;
+    }
+    fsync_parent_dir(path);
+    return 0;
+}
+int state_snapshot_import_json(const char *json_path, const char *snapshot_path) {
+    if (!json_path || !snapshot_path) {
+        return -1;
+    }
+    FILE *fp = fopen(json_path, "r");
+    if (!fp) {
+        return -1;
+    }
+    vector<state_record_t> records;
+    unsigned long long sequence = 0;
+    char line[1024];
+    state_record_t rec;
+    state_record_init(&rec, STATE_RECORD_UPSERT, nullptr);
+    bool in_container = false;
+    while (fgets(line, sizeof(line), fp)) {
+        char *p = line;
+        while (*p == ' ' || *p == '\t') p++;
+        if (*p == '\n' || *p == '\0' || *p == '{' || *p == '[' || *p == ']') {
+            continue;
+        }
+        long long value = 0;
+        if (!in_container && strstr(p, "\"sequence\"")) {
+            sscanf(p, " \"sequence\": %llu", &sequence);
+        } else if (strstr(p, "\"id\"")) {
+            in_container = true;
+            sscanf(p, " \"id\": \"%63[^\"]\"", rec.id);
+        } else if (in_container && strstr(p, "\"pid\"")) {
+            sscanf(p, " \"pid\": %d", &rec.pid);
+        } else if (in_container && strstr(p, "\"state\"")) {
+            sscanf(p, " \"state\": %d", &rec.state);
+        } else if (in_container && strstr(p, "\"created_at\"")) {
+            if (sscanf(p, " \"created_at\": %lld", &value) == 1) rec.created_at = value;
+        } else if (in_container && strstr(p, "\"started_at\"")) {
+            if (sscanf(p, " \"started_at\": %lld", &value) == 1) rec.started_at = value;
+        } else if (in_container && strstr(p, "\"stopped_at\"")) {
+            if (sscanf(p, " \"stopped_at\": %lld", &value) == 1) rec.stopped_at = value;
+        }
+        if (in_container && strstr(p, "}")) {
+            if (rec.id[0] != '\0') {
+                records.push_back(rec);
+            }
+            state_record_init(&rec, STATE_RECORD_UPSERT, nullptr);
+            in_container = false;
+        }
+    }
+    fclose(fp);
+    if (state_snapshot_write(snapshot_path, records.data(), (int)records.size(), sequence) != 0) {
+        return -1;
+    }
+    fprintf(stderr, "Imported %d container(s) from %s\n", (int)records.size(), json_path);
+    return 0;
+}
@@ -12,6 +12,10 @@
 #include <cstdlib>
 #include <map>
 #include <string>
+#define EVENTS_DEFAULT_TIMEOUT_MS 25000
+#define EVENTS_MAX_TIMEOUT_MS 60000
+#define EVENTS_TICK_MS 250
+#define EVENTS_BATCH_MAX 64
 SimpleWebServer::SimpleWebServer(container_manager_t* cm, int port)
     : cm_(cm), port_(port), running_(false), server_socket_(-1) {
 }
@@ -22,17 +26,21 @@ void SimpleWebServer::start() {
     if (running_) return;
     running_ = true;
     server_thread_ = std::thread(&SimpleWebServer::serverThread, this);
+    events_thread_ = std::thread(&SimpleWebServer::eventsThread, this);
 }
 void SimpleWebServer::stop() {
     if (!running_) return;
     running_ = false;
-    if (server_socket_ != -1) {
-        close(server_socket_);
-        server_socket_ = -1;
+    int fd = server_socket_;
+    if (fd != -1) {
+        shutdown(fd, SHUT_RDWR);
     }
     if (server_thread_.joinable()) {
         server_thread_.join();
     }
+    if (events_thread_.joinable()) {
+        events_thread_.join();
+    }
 }
 void SimpleWebServer::serverThread() {
         server_socket_ = socket(AF_INET, SOCK_STREAM, 0);
@@ -57,6 +65,7 @@ void SimpleWebServer::serverThread() {
         if (listen(server_socket_, 5) == -1) {
             std::cerr << "Failed to listen on socket" << std::endl;
             close(server_socket_);
+            server_socket_ = -1;
             return;
         }
         std::cout << "Web server started on port " << port_ << std::endl;
@@ -75,6 +84,9 @@ void SimpleWebServer::serverThread() {
             ssize_t bytes_read = read(client_socket, buffer, sizeof(buffer) - 1);
             if (bytes_read > 0) {
                 buffer[bytes_read] = '\0';
+                if (parkEventWaiter(client_socket, buffer)) {
+                    continue;
+                }
                 std::string response = handleRequest(buffer);
                 write(client_socket, response.c_str(), response.size());
             }
@@ -83,6 +95,98 @@ void SimpleWebServer::serverThread() {
         close(server_socket_);
         server_socket_ = -1;
 }
+static long query_param(const std::string& path, const char* name, long fallback) {
+    size_t query = path.find('?');
+    std::string key = std::string(name) + "=";
+    while (query != std::string::npos) {
+        if (path.compare(query + 1, key.size(), key) == 0) {
+            return strtol(path.c_str() + query + 1 + key.size(), nullptr, 10);
+        }
+        query = path.find('&', query + 1);
+    }
+    return fallback;
+}
+static void send_events(int client_socket, const event_cursor_t& cursor,
+                        const container_event_t* events, int count) {
+    std::ostringstream json;
+    json << "{\"next\":" << cursor.next << ",\"dropped\":" << cursor.dropped << ",\"events\":[";
+    for (int i = 0; i < count; i++) {
+        if (i > 0) json << ",";
+        json << "{\"seq\":" << events[i].seq
+             << ",\"type\":\"" << container_event_name(events[i].type) << "\""
+             << ",\"id\":\"" << events[i].id << "\""
+             << ",\"pid\":" << events[i].pid
+             << ",\"exit_code\":" << events[i].exit_code
+             << ",\"signal\":" << events[i].signal
+             << ",\"time\":" << events[i].time_ns / 1000000 << "}";
+    }
+    json << "]}";
+    std::string response = "HTTP/1.1 200 OK\r\n"
+                           "Content-Type: application/json\r\n"
+                           "Access-Control-Allow-Origin: *\r\n"
+                           "Cache-Control: no-store\r\n"
+                           "Connection: close\r\n\r\n" + json.str();
+    write(client_socket, response.c_str(), response.size());
+    close(client_socket);
+}
+bool SimpleWebServer::parkEventWaiter(int client_socket, const std::string& request) {
+        std::istringstream iss(request);
+        std::string method, path;
+        iss >> method >> path;
+        if (method != "GET" || path.compare(0, 11, "/api/events") != 0 ||
+            (path.size() > 11 && path[11] != '?')) {
+            return false;
+        }
+        EventWaiter waiter;
+        waiter.socket = client_socket;
+        long since = query_param(path, "since", -1);
+        if (since >= 0) {
+            waiter.cursor.next = (uint64_t)since;
+            waiter.cursor.dropped = 0;
+        } else {
+            event_bus_subscribe(cm_->events, &waiter.cursor);
+        }
+        long timeout_ms = query_param(path, "timeout", EVENTS_DEFAULT_TIMEOUT_MS);
+        if (timeout_ms < 0 || timeout_ms > EVENTS_MAX_TIMEOUT_MS) {
+            timeout_ms = EVENTS_MAX_TIMEOUT_MS;
+        }
+        waiter.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+        container_event_t events[EVENTS_BATCH_MAX];
+        int count = event_bus_poll(cm_->events, &waiter.cursor, events, EVENTS_BATCH_MAX);
+        if (count > 0 || waiter.cursor.dropped > 0 || timeout_ms == 0) {
+            send_events(client_socket, waiter.cursor, events, count);
+            return true;
+        }
+        std::lock_guard<std::mutex> guard(events_lock_);
+        event_waiters_.push_back(waiter);
+        return true;
+}
+void SimpleWebServer::eventsThread() {
+        event_cursor_t wake;
+        event_bus_subscribe(cm_->events, &wake);
+        container_event_t events[EVENTS_BATCH_MAX];
+        while (running_) {
+            event_bus_wait(cm_->events, &wake, events, EVENTS_BATCH_MAX, EVENTS_TICK_MS);
+            std::lock_guard<std::mutex> guard(events_lock_);
+            auto now = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < event_waiters_.size();) {
+                EventWaiter& waiter = event_waiters_[i];
+                uint64_t dropped = waiter.cursor.dropped;
+                int count = event_bus_poll(cm_->events, &waiter.cursor, events, EVENTS_BATCH_MAX);
+                if (count == 0 && waiter.cursor.dropped == dropped && now < waiter.deadline) {
+                    i++;
+                    continue;
+                }
+                send_events(waiter.socket, waiter.cursor, events, count);
+                event_waiters_.erase(event_waiters_.begin() + i);
+            }
+        }
+        std::lock_guard<std::mutex> guard(events_lock_);
+        for (size_t i = 0; i < event_waiters_.size(); i++) {
+            send_events(event_waiters_[i].socket, event_waiters_[i].cursor, events, 0);
+        }
+        event_waiters_.clear();
+}
 std::string SimpleWebServer::handleRequest(const std::string& request) {
         std::istringstream iss(request);
         std::string method, path, version;
@@ -105,16 +209,20 @@ std::string SimpleWebServer::handleRequest(const std::string& request) {
                       "Access-Control-Allow-Origin: *\r\n"
                       "Connection: close\r\n\r\n" +
                       getSystemInfoJSON();
+            } else if (path.compare(0, 16, "/api/containers/") == 0) {
+                return handleContainerInfo(path);
             } else {
                 return "HTTP/1.1 404 Not Found\r\n"
                       "Content-Type: text/plain\r\n"
                       "Connection: close\r\n\r\n"
                       "Not Found";
             }
+        } else if (method == "POST") {
+            return handleContainerAction(path);
         } else if (method == "OPTIONS") {
             return "HTTP/1.1 200 OK\r\n"
                   "Access-Control-Allow-Origin: *\r\n"
-                  "Access-Control-Allow-Methods: GET, OPTIONS\r\n"
+                  "Access-Control-Allow-Methods: GET, POST, OPTIONS\r\n"
                   "Access-Control-Allow-Headers: Content-Type\r\n"
                   "Connection: close\r\n\r\n";
         } else {
@@ -124,6 +232,81 @@ std::string SimpleWebServer::handleRequest(const std::string& request) {
                   "Method Not Allowed";
         }
 }
+static std::string json_response(const char* status, const std::string& body) {
+    return std::string("HTTP/1.1 ") + status + "\r\n"
+           "Content-Type: application/json\r\n"
+           "Access-Control-Allow-Origin: *\r\n"
+           "Connection: close\r\n\r\n" + body;
+}
+std::string SimpleWebServer::handleContainerAction(const std::string& path) {
+        const std::string prefix = "/api/containers/";
+        size_t slash = path.rfind('/');
+        if (path.compare(0, prefix.size(), prefix) != 0 || slash <= prefix.size()) {
+            return json_response("404 Not Found", "{\"error\":\"not found\"}");
+        }
+        std::string id = path.substr(prefix.size(), slash - prefix.size());
+        std::string action = path.substr(slash + 1);
+        if (action != "pause" && action != "resume") {
+            return json_response("404 Not Found", "{\"error\":\"unknown action\"}");
+        }
+        int result = action == "pause" ? container_manager_pause(cm_, id.c_str())
+                                       : container_manager_resume(cm_, id.c_str());
+        if (result == CONTAINER_NOT_FOUND) {
+            return json_response("404 Not Found", "{\"error\":\"container not found\"}");
+        }
+        if (result != 0) {
+            return json_response("409 Conflict", "{\"error\":\"cannot " + action + " container in its current state\"}");
+        }
+        return json_response("200 OK", "{\"id\":\"" + id + "\",\"state\":\"" +
+                             (action == "pause" ? "PAUSED" : "RUNNING") + "\"}");
+}
+static std::string start_trace_json(const start_trace_t& trace) {
+    std::string json = "{\"pooled\":" + std::string(trace.pooled ? "true" : "false");
+    for (int i = 0; i < START_PHASE_COUNT; i++) {
+        json += ",\"" + std::string(start_phase_name(i)) + "_us\":" + std::to_string(trace.phase_ns[i] / 1000);
+    }
+    json += "}";
+    return json;
+}
+std::string SimpleWebServer::handleContainerInfo(const std::string& path) {
+        std::string id = path.substr(16);
+        if (id.empty() || id.find('/') != std::string::npos) {
+            return json_response("404 Not Found", "{\"error\":\"not found\"}");
+        }
+        uint64_t ticket;
+        const container_snapshot_t* snapshot = container_manager_snapshot_acquire(cm_, &ticket);
+        container_view_t view;
+        bool found = false;
+        for (int i = 0; snapshot && i < snapshot->count; i++) {
+            if (id == snapshot->containers[i].id) {
+                view = snapshot->containers[i];
+                found = true;
+                break;
+            }
+        }
+        container_manager_snapshot_release(cm_, ticket);
+        if (!found) {
+            return json_response("404 Not Found", "{\"error\":\"container not found\"}");
+        }
+        const char* state_names[] = {"CREATED", "RUNNING", "STOPPED", "DESTROYED", "PAUSED"};
+        const char* state_str = "UNKNOWN";
+        if ((int)view.state >= 0 && (int)view.state < (int)(sizeof(state_names) / sizeof(state_names[0]))) {
+            state_str = state_names[view.state];
+        }
+        std::string json = "{";
+        json += "\"id\":\"" + std::string(view.id) + "\",";
+        json += "\"pid\":" + std::to_string(view.pid) + ",";
+        json += "\"state\":\"" + std::string(state_str) + "\",";
+        json += "\"created_at\":" + std::to_string((long long)view.created_at) + ",";
+        json += "\"started_at\":" + std::to_string((long long)view.started_at) + ",";
+        unsigned long long upper_usage = 0;
+        if (view.fs_method == FS_OVERLAY && fs_overlay_usage(view.id, &upper_usage) == 0) {
+            json += "\"upper_bytes\":" + std::to_string(upper_usage) + ",";
+        }
+        json += "\"start_trace\":" + start_trace_json(view.start_trace);
+        json += "}";
+        return json_response("200 OK", json);
+}
 static unsigned long read_cgroup_limit(const char* path) {
     char buffer[256];
     std::ifstream file(path);
@@ -146,23 +329,23 @@ std::string SimpleWebServer::getContainerListJSON() {
         static std::map<std::string, unsigned long> prev_cpu_usage;
         static std::map<std::string, time_t> prev_time;
         std::string json = "{\"containers\":[";
-        int count;
-        container_info_t** containers = container_manager_list(cm_, &count);
-        std::vector<container_info_t*> active_containers;
-        for (int i = 0; i < count; i++) {
-            if (containers[i]->state != CONTAINER_DESTROYED) {
-                active_containers.push_back(containers[i]);
+        uint64_t ticket;
+        const container_snapshot_t* snapshot = container_manager_snapshot_acquire(cm_, &ticket);
+        std::vector<const container_view_t*> active_containers;
+        for (int i = 0; snapshot && i < snapshot->count; i++) {
+            if (snapshot->containers[i].state != CONTAINER_DESTROYED) {
+                active_containers.push_back(&snapshot->containers[i]);
             }
         }
         time_t current_time = time(nullptr);
         for (size_t i = 0; i < active_containers.size(); i++) {
-            container_info_t* info = active_containers[i];
+            const container_view_t* info = active_containers[i];
             if (i > 0) json += ",";
             unsigned long cpu_usage = 0, memory_usage = 0;
             unsigned long cpu_limit = 0, memory_limit = 0;
             double cpu_percent = 0.0;
             double memory_percent = 0.0;
-            if (info->state == CONTAINER_RUNNING) {
+            if (info->state == CONTAINER_RUNNING || info->state == CONTAINER_PAUSED) {
                 resource_manager_get_stats(cm_->rm, info->id, &cpu_usage, &memory_usage);
                 char path[1024];
                 unsigned long cpu_quota_us = 0;
@@ -239,7 +422,7 @@ std::string SimpleWebServer::getContainerListJSON() {
                 prev_cpu_usage.erase(container_id_str);
                 prev_time.erase(container_id_str);
             }
-            const char* state_names[] = {"CREATED", "RUNNING", "STOPPED", "DESTROYED"};
+            const char* state_names[] = {"CREATED", "RUNNING", "STOPPED", "DESTROYED", "PAUSED"};
             const char* state_str = "UNKNOWN";
             if ((int)info->state >= 0 && (int)info->state < (int)(sizeof(state_names) / sizeof(state_names[0]))) {
                 state_str = state_names[info->state];
@@ -248,7 +431,7 @@ std::string SimpleWebServer::getContainerListJSON() {
             json += "\"id\":\"" + std::string(info->id) + "\",";
             json += "\"pid\":" + std::to_string(info->pid) + ",";
             json += "\"state\":\"" + std::string(state_str) + "\"";
-            if (info->state == CONTAINER_RUNNING) {
+            if (info->state == CONTAINER_RUNNING || info->state == CONTAINER_PAUSED) {
                 json += ",\"cpu_usage\":" + std::to_string(cpu_usage);
                 json += ",\"cpu_limit\":" + std::to_string(cpu_limit);
                 json += ",\"cpu_percent\":" + std::to_string(cpu_percent);
@@ -258,6 +441,7 @@ std::string SimpleWebServer::getContainerListJSON() {
             }
             json += "}";
         }
+        container_manager_snapshot_release(cm_, ticket);
         json += "]}";
         return json;
 }
@@ -345,8 +529,26 @@ std::string SimpleWebServer::getSystemInfoJSON() {
     std::string json = "{";
     json += "\"used_memory\":" + std::to_string(used_mem) + ",";
     json += "\"total_memory\":" + std::to_string(total_mem) + ",";
-    json += "\"cpu_percent\":" + std::to_string(cpu_percent);
-    json += "}";
+    json += "\"cpu_percent\":" + std::to_string(cpu_percent) + ",";
+    start_histogram_t stats;
+    container_manager_get_start_stats(cm_, &stats);
+    json += "\"start_latency\":{\"count\":" + std::to_string(stats.count);
+    for (int i = 0; i < START_PHASE_COUNT; i++) {
+        json += ",\"" + std::string(start_phase_name(i)) + "\":{";
+        json += "\"p50_us\":" + std::to_string(start_histogram_percentile(&stats, i, 50.0) / 1000) + ",";
+        json += "\"p90_us\":" + std::to_string(start_histogram_percentile(&stats, i, 90.0) / 1000) + ",";
+        json += "\"p99_us\":" + std::to_string(start_histogram_percentile(&stats, i, 99.0) / 1000) + "}";
+    }
+    json += "},";
+    rootfs_cache_stats_t cache_stats;
+    container_manager_get_rootfs_cache_stats(cm_, &cache_stats);
+    json += "\"rootfs_cache\":{";
+    json += "\"hits\":" + std::to_string(cache_stats.hits) + ",";
+    json += "\"misses\":" + std::to_string(cache_stats.misses) + ",";
+    json += "\"evictions\":" + std::to_string(cache_stats.evictions) + ",";
+    json += "\"templates\":" + std::to_string(cache_stats.templates) + ",";
+    json += "\"bytes\":" + std::to_string(cache_stats.bytes) + ",";
+    json += "\"budget\":" + std::to_string(cache_stats.budget) + "}}";
     return json;
 }
 std::string SimpleWebServer::generateHTML() {
@@ -413,6 +615,11 @@ std::string SimpleWebServer::generateHTML() {
                 }
             });
         }
+        function toggleContainer(id, action) {
+            fetch('/api/containers/' + encodeURIComponent(id) + '/' + action, { method: 'POST' })
+                .then(() => updateContainers())
+                .catch(error => console.error('Error:', error));
+        }
         function updateContainers() {
             fetch('/api/containers')
                 .then(r => r.json())
@@ -434,7 +641,11 @@ std::string SimpleWebServer::generateHTML() {
                             containerDiv.id = containerId;
                             const containerTitle = document.createElement('div');
                             containerTitle.className = 'container-title';
-                            containerTitle.textContent = 'Container: ' + container.id;
+                            containerTitle.textContent = 'Container: ' + container.id + ' ';
+                            const toggleButton = document.createElement('button');
+                            toggleButton.id = 'toggle-' + container.id;
+                            toggleButton.onclick = () => toggleContainer(container.id, toggleButton.dataset.action);
+                            containerTitle.appendChild(toggleButton);
                             containerDiv.appendChild(containerTitle);
                             const chartsDiv = document.createElement('div');
                             chartsDiv.className = 'charts';
@@ -469,7 +680,11 @@ std::string SimpleWebServer::generateHTML() {
                             charts['cpu-' + container.id] = createChart(container.id, 'cpu', 'cpu-' + container.id);
                             charts['ram-' + container.id] = createChart(container.id, 'ram', 'ram-' + container.id);
                         }
-                        if (container.state === 'RUNNING') {
+                        const toggleButton = document.getElementById('toggle-' + container.id);
+                        toggleButton.dataset.action = container.state === 'PAUSED' ? 'resume' : 'pause';
+                        toggleButton.textContent = container.state === 'PAUSED' ? 'Resume' : 'Pause';
+                        toggleButton.style.display = (container.state === 'RUNNING' || container.state === 'PAUSED') ? '' : 'none';
+                        if (container.state === 'RUNNING' || container.state === 'PAUSED') {
                             if (container.cpu_percent !== undefined && !isNaN(container.cpu_percent)) {
                                 const cpuPercent = Math.min(100, Math.max(0, parseFloat(container.cpu_percent)));
                                 if (charts['cpu-' + container.id]) {
@@ -510,7 +725,21 @@ std::string SimpleWebServer::generateHTML() {
                     console.error('Error:', error);
                 });
         }
+        let eventCursor = null;
+        function watchEvents() {
+            fetch('/api/events' + (eventCursor === null ? '' : '?since=' + eventCursor))
+                .then(response => response.json())
+                .then(data => {
+                    eventCursor = data.next;
+                    if (data.events.length > 0 || data.dropped > 0) {
+                        updateContainers();
+                    }
+                    watchEvents();
+                })
+                .catch(() => setTimeout(watchEvents, 5000));
+        }
         updateContainers();
+        watchEvents();
         setInterval(updateContainers, 10000);
     </script>
 </body>
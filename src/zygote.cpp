@@ -0,0 +1,646 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <csignal>
+#include <unistd.h>
+#include <sched.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/signalfd.h>
+#include <sys/syscall.h>
+#include <linux/close_range.h>
+#include <chrono>
+#include <mutex>
+#include <vector>
+#include <unordered_map>
+#include <condition_variable>
+#include "../include/zygote.hpp"
+using namespace std;
+#define ZYGOTE_STACK_SIZE (8 * 1024 * 1024)
+#define ZYGOTE_WORKER_STACK_SIZE (256 * 1024)
+#define ZYGOTE_REQUEST_MAX (128 * 1024)
+#define ZYGOTE_ARGV_MAX 4096
+#define ZYGOTE_CHANNEL_FD 3
+#define ZYGOTE_EXIT_FD 4
+#define ZYGOTE_SIGNAL_FD 5
+#define ZYGOTE_INHERIT_ENV 0x1
+#define ZYGOTE_EXIT_BATCH 64
+typedef struct {
+    uint64_t cookie;
+    uint32_t argc;
+    uint32_t envc;
+    uint32_t cgroup_fd_count;
+    uint32_t flags;
+} zygote_request_t;
+typedef struct {
+    uint64_t cookie;
+    int32_t error;
+    int32_t status;
+} zygote_reply_t;
+typedef struct {
+    namespace_config_t config;
+    int channel_fd;
+    int exit_fd;
+    int net_fd;
+    char *worker_stack;
+} zygote_args_t;
+typedef struct {
+    char **command;
+    char **env;
+    const int *cgroup_fds;
+    int cgroup_fd_count;
+    const int *stdio_fds;
+    int cgroup_ns;
+    volatile int error;
+} worker_args_t;
+typedef struct {
+    pid_t pid;
+    uint64_t cookie;
+} worker_slot_t;
+typedef struct {
+    worker_slot_t workers[ZYGOTE_MAX_WORKERS];
+    int worker_count;
+    zygote_reply_t pending[ZYGOTE_MAX_WORKERS];
+    int pending_head;
+    int pending_count;
+} zygote_state_t;
+struct zygote {
+    pid_t pid;
+    int channel_fd;
+    int exit_fd;
+    uint64_t next_cookie;
+    mutex spawn_lock;
+    mutex wait_lock;
+    condition_variable exited;
+    bool reading;
+    bool closed;
+    unordered_map<pid_t, uint64_t> cookies;
+    unordered_map<uint64_t, int> exits;
+};
+static void reset_signals() {
+    for (int sig = 1; sig < NSIG; sig++) {
+        struct sigaction action;
+        if (sigaction(sig, nullptr, &action) == 0 && action.sa_handler != SIG_IGN &&
+            action.sa_handler != SIG_DFL) {
+            memset(&action, 0, sizeof(action));
+            action.sa_handler = SIG_DFL;
+            sigaction(sig, &action, nullptr);
+        }
+    }
+    signal(SIGPIPE, SIG_DFL);
+    signal(SIGCHLD, SIG_DFL);
+}
+static int worker_main(void *arg) {
+    worker_args_t *args = static_cast<worker_args_t*>(arg);
+    sigset_t none;
+    sigemptyset(&none);
+    sigprocmask(SIG_SETMASK, &none, nullptr);
+    for (int i = 0; i < args->cgroup_fd_count; i++) {
+        if (write(args->cgroup_fds[i], "0", 1) != 1) {
+            args->error = errno;
+            _exit(127);
+        }
+    }
+    if (args->cgroup_ns && unshare(CLONE_NEWCGROUP) == -1) {
+        args->error = errno;
+        _exit(127);
+    }
+    for (int i = 0; i < 3; i++) {
+        if (args->stdio_fds[i] != i && dup2(args->stdio_fds[i], i) == -1) {
+            args->error = errno;
+            _exit(127);
+        }
+    }
+    syscall(SYS_close_range, 3, ~0U, CLOSE_RANGE_CLOEXEC);
+    execvpe(args->command[0], args->command, args->env);
+    args->error = errno;
+    _exit(127);
+}
+static void send_reply(const zygote_reply_t *reply, pid_t pid, int pidfd) {
+    struct iovec iov;
+    iov.iov_base = const_cast<zygote_reply_t*>(reply);
+    iov.iov_len = sizeof(*reply);
+    char control[CMSG_SPACE(sizeof(struct ucred)) + CMSG_SPACE(sizeof(int))];
+    memset(control, 0, sizeof(control));
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    if (pid > 0) {
+        struct ucred cred;
+        cred.pid = pid;
+        cred.uid = getuid();
+        cred.gid = getgid();
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_CREDENTIALS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(cred));
+        memcpy(CMSG_DATA(cmsg), &cred, sizeof(cred));
+        if (pidfd >= 0) {
+            cmsg = CMSG_NXTHDR(&msg, cmsg);
+            cmsg->cmsg_level = SOL_SOCKET;
+            cmsg->cmsg_type = SCM_RIGHTS;
+            cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+            memcpy(CMSG_DATA(cmsg), &pidfd, sizeof(int));
+        } else {
+            msg.msg_controllen = CMSG_SPACE(sizeof(struct ucred));
+        }
+    }
+    while (sendmsg(ZYGOTE_CHANNEL_FD, &msg, MSG_NOSIGNAL) < 0 && errno == EINTR) {
+    }
+}
+static int unpack_strings(char *data, size_t length, uint32_t count, char **out, size_t *used) {
+    size_t offset = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        char *end = static_cast<char*>(memchr(data + offset, '\0', length - offset));
+        if (!end) {
+            return -1;
+        }
+        out[i] = data + offset;
+        offset = end - data + 1;
+    }
+    out[count] = nullptr;
+    *used = offset;
+    return 0;
+}
+static int spawn_worker(zygote_state_t *state, const zygote_request_t *request, char *strings, size_t length,
+                        const int *fds, int cgroup_ns, char *worker_stack, pid_t *pid, int *pidfd) {
+    static char *command[ZYGOTE_ARGV_MAX + 1];
+    static char *env[ZYGOTE_ARGV_MAX + 1];
+    size_t used = 0;
+    if (request->argc == 0 || request->argc > ZYGOTE_ARGV_MAX || request->envc > ZYGOTE_ARGV_MAX ||
+        request->cgroup_fd_count > ZYGOTE_MAX_CGROUP_FDS ||
+        unpack_strings(strings, length, request->argc, command, &used) != 0) {
+        return EINVAL;
+    }
+    if (!(request->flags & ZYGOTE_INHERIT_ENV) &&
+        unpack_strings(strings + used, length - used, request->envc, env, &used) != 0) {
+        return EINVAL;
+    }
+    if (state->worker_count + state->pending_count >= ZYGOTE_MAX_WORKERS) {
+        return EAGAIN;
+    }
+    worker_args_t args;
+    args.command = command;
+    args.env = (request->flags & ZYGOTE_INHERIT_ENV) ? environ : env;
+    args.cgroup_fds = fds + 3;
+    args.cgroup_fd_count = (int)request->cgroup_fd_count;
+    args.stdio_fds = fds;
+    args.cgroup_ns = cgroup_ns;
+    args.error = 0;
+    pid_t child = clone(worker_main, worker_stack + ZYGOTE_WORKER_STACK_SIZE, CLONE_VM | CLONE_VFORK | SIGCHLD,
+                        &args);
+    if (child == -1) {
+        return errno;
+    }
+    if (args.error != 0) {
+        while (waitpid(child, nullptr, 0) == -1 && errno == EINTR) {
+        }
+        return args.error;
+    }
+    state->workers[state->worker_count].pid = child;
+    state->workers[state->worker_count].cookie = request->cookie;
+    state->worker_count++;
+    *pid = child;
+    *pidfd = (int)syscall(SYS_pidfd_open, child, 0);
+    return 0;
+}
+static void serve_request(zygote_state_t *state, char *buffer, int cgroup_ns, char *worker_stack) {
+    int fds[3 + ZYGOTE_MAX_CGROUP_FDS];
+    char control[CMSG_SPACE(sizeof(fds))];
+    struct iovec iov;
+    iov.iov_base = buffer;
+    iov.iov_len = ZYGOTE_REQUEST_MAX;
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    ssize_t n;
+    do {
+        n = recvmsg(ZYGOTE_CHANNEL_FD, &msg, MSG_CMSG_CLOEXEC);
+    } while (n < 0 && errno == EINTR);
+    if (n <= 0) {
+        _exit(EXIT_SUCCESS);
+    }
+    int fd_count = 0;
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+            fd_count = (int)((cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int));
+            memcpy(fds, CMSG_DATA(cmsg), fd_count * sizeof(int));
+        }
+    }
+    zygote_reply_t reply;
+    memset(&reply, 0, sizeof(reply));
+    pid_t pid = 0;
+    int pidfd = -1;
+    if ((size_t)n < sizeof(zygote_request_t) || (msg.msg_flags & (MSG_TRUNC | MSG_CTRUNC))) {
+        reply.error = EINVAL;
+    } else {
+        zygote_request_t request;
+        memcpy(&request, buffer, sizeof(request));
+        reply.cookie = request.cookie;
+        if (fd_count != 3 + (int)request.cgroup_fd_count) {
+            reply.error = EBADF;
+        } else {
+            reply.error = spawn_worker(state, &request, buffer + sizeof(request), n - sizeof(request), fds,
+                                       cgroup_ns, worker_stack, &pid, &pidfd);
+        }
+    }
+    for (int i = 0; i < fd_count; i++) {
+        close(fds[i]);
+    }
+    send_reply(&reply, reply.error == 0 ? pid : 0, pidfd);
+    if (pidfd >= 0) {
+        close(pidfd);
+    }
+}
+static void reap_workers(zygote_state_t *state) {
+    struct signalfd_siginfo info;
+    while (read(ZYGOTE_SIGNAL_FD, &info, sizeof(info)) == (ssize_t)sizeof(info)) {
+    }
+    int status;
+    pid_t pid;
+    while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+        for (int i = 0; i < state->worker_count; i++) {
+            if (state->workers[i].pid != pid) {
+                continue;
+            }
+            zygote_reply_t *exit = &state->pending[(state->pending_head + state->pending_count) % ZYGOTE_MAX_WORKERS];
+            exit->cookie = state->workers[i].cookie;
+            exit->error = 0;
+            exit->status = status;
+            state->pending_count++;
+            state->workers[i] = state->workers[--state->worker_count];
+            break;
+        }
+    }
+}
+static void flush_exits(zygote_state_t *state) {
+    while (state->pending_count > 0) {
+        ssize_t sent = send(ZYGOTE_EXIT_FD, &state->pending[state->pending_head], sizeof(zygote_reply_t),
+                            MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        if (sent < 0 && errno == EAGAIN) {
+            return;
+        }
+        state->pending_head = (state->pending_head + 1) % ZYGOTE_MAX_WORKERS;
+        state->pending_count--;
+    }
+}
+static int install_fd(int fd, int target) {
+    if (fd == target) {
+        return fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+    return dup3(fd, target, O_CLOEXEC) == -1 ? -1 : 0;
+}
+static int zygote_main(void *arg) {
+    zygote_args_t *args = static_cast<zygote_args_t*>(arg);
+    reset_signals();
+    if (args->net_fd >= 0 && setns(args->net_fd, CLONE_NEWNET) == -1) {
+        perror("join network namespace failed");
+        _exit(EXIT_FAILURE);
+    }
+    if (namespace_setup_isolation(&args->config) != 0) {
+        fprintf(stderr, "Failed to setup namespace isolation\n");
+        _exit(EXIT_FAILURE);
+    }
+    int channel = fcntl(args->channel_fd, F_DUPFD_CLOEXEC, ZYGOTE_SIGNAL_FD + 1);
+    int exits = fcntl(args->exit_fd, F_DUPFD_CLOEXEC, ZYGOTE_SIGNAL_FD + 1);
+    if (channel == -1 || exits == -1 || install_fd(channel, ZYGOTE_CHANNEL_FD) != 0 ||
+        install_fd(exits, ZYGOTE_EXIT_FD) != 0) {
+        _exit(EXIT_FAILURE);
+    }
+    sigset_t chld;
+    sigemptyset(&chld);
+    sigaddset(&chld, SIGCHLD);
+    sigprocmask(SIG_SETMASK, &chld, nullptr);
+    int signal_fd = signalfd(-1, &chld, SFD_CLOEXEC | SFD_NONBLOCK);
+    if (signal_fd == -1 || install_fd(signal_fd, ZYGOTE_SIGNAL_FD) != 0) {
+        _exit(EXIT_FAILURE);
+    }
+    syscall(SYS_close_range, ZYGOTE_SIGNAL_FD + 1, ~0U, 0);
+    static zygote_state_t state;
+    static char buffer[ZYGOTE_REQUEST_MAX];
+    int cgroup_ns = (args->config.flags & CLONE_NEWCGROUP) != 0;
+    char *worker_stack = args->worker_stack;
+    while (true) {
+        struct pollfd fds[3];
+        fds[0].fd = ZYGOTE_CHANNEL_FD;
+        fds[0].events = POLLIN;
+        fds[1].fd = ZYGOTE_SIGNAL_FD;
+        fds[1].events = POLLIN;
+        fds[2].fd = ZYGOTE_EXIT_FD;
+        fds[2].events = state.pending_count > 0 ? POLLOUT : 0;
+        if (poll(fds, 3, -1) < 0) {
+            if (errno == EINTR) continue;
+            _exit(EXIT_FAILURE);
+        }
+        if (fds[1].revents & POLLIN) {
+            reap_workers(&state);
+        }
+        if (fds[0].revents & (POLLIN | POLLHUP | POLLERR)) {
+            serve_request(&state, buffer, cgroup_ns, worker_stack);
+        }
+        flush_exits(&state);
+    }
+}
+zygote_t *zygote_create(const namespace_config_t *config) {
+    if (!config) {
+        fprintf(stderr, "Error: invalid parameters\n");
+        return nullptr;
+    }
+    if (config->flags & CLONE_NEWUSER) {
+        fprintf(stderr, "Error: user namespaces cannot host a zygote\n");
+        errno = EINVAL;
+        return nullptr;
+    }
+    int channel[2], exits[2];
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, channel) == -1) {
+        perror("socketpair failed");
+        return nullptr;
+    }
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, exits) == -1) {
+        perror("socketpair failed");
+        close(channel[0]);
+        close(channel[1]);
+        return nullptr;
+    }
+    int on = 1;
+    setsockopt(channel[0], SOL_SOCKET, SO_PASSCRED, &on, sizeof(on));
+    zygote_args_t args;
+    args.config = *config;
+    args.channel_fd = channel[1];
+    args.exit_fd = exits[1];
+    args.net_fd = -1;
+    args.worker_stack = nullptr;
+    pid_t pid = -1;
+    if (config->flags & CLONE_NEWNET) {
+        args.net_fd = namespace_create_detached(CLONE_NEWNET);
+        if (args.net_fd == -1) {
+            perror("create network namespace failed");
+        }
+    }
+    void *worker_stack = mmap(nullptr, ZYGOTE_WORKER_STACK_SIZE, PROT_READ | PROT_WRITE,
+                              MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+    void *stack = mmap(nullptr, ZYGOTE_STACK_SIZE, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+    if (worker_stack != MAP_FAILED && stack != MAP_FAILED && (args.net_fd >= 0 || !(config->flags & CLONE_NEWNET))) {
+        args.worker_stack = static_cast<char*>(worker_stack);
+        pid = namespace_clone_process(config->flags & ~(CLONE_NEWCGROUP | CLONE_NEWNET), stack, ZYGOTE_STACK_SIZE,
+                                      zygote_main, &args);
+    }
+    if (worker_stack != MAP_FAILED) munmap(worker_stack, ZYGOTE_WORKER_STACK_SIZE);
+    if (stack != MAP_FAILED) munmap(stack, ZYGOTE_STACK_SIZE);
+    if (args.net_fd >= 0) close(args.net_fd);
+    close(channel[1]);
+    close(exits[1]);
+    if (pid == -1) {
+        close(channel[0]);
+        close(exits[0]);
+        return nullptr;
+    }
+    zygote_t *zygote = new struct zygote();
+    zygote->pid = pid;
+    zygote->channel_fd = channel[0];
+    zygote->exit_fd = exits[0];
+    zygote->next_cookie = 0;
+    zygote->reading = false;
+    zygote->closed = false;
+    return zygote;
+}
+void zygote_destroy(zygote_t *zygote) {
+    if (!zygote) return;
+    close(zygote->channel_fd);
+    close(zygote->exit_fd);
+    while (waitpid(zygote->pid, nullptr, 0) == -1 && errno == EINTR) {
+    }
+    delete zygote;
+}
+pid_t zygote_pid(const zygote_t *zygote) {
+    return zygote ? zygote->pid : -1;
+}
+static void pack_strings(vector<char> &buffer, char **strings) {
+    for (int i = 0; strings && strings[i]; i++) {
+        buffer.insert(buffer.end(), strings[i], strings[i] + strlen(strings[i]) + 1);
+    }
+}
+static uint32_t count_strings(char **strings) {
+    uint32_t count = 0;
+    while (strings && strings[count]) {
+        count++;
+    }
+    return count;
+}
+pid_t zygote_spawn(zygote_t *zygote, char **command, char **env, const int *cgroup_fds, int cgroup_fd_count,
+                   const int *stdio_fds, int *pidfd) {
+    if (!zygote || !command || !command[0] || cgroup_fd_count < 0 || cgroup_fd_count > ZYGOTE_MAX_CGROUP_FDS ||
+        (cgroup_fd_count > 0 && !cgroup_fds)) {
+        fprintf(stderr, "Error: invalid parameters\n");
+        errno = EINVAL;
+        return -1;
+    }
+    zygote_request_t request;
+    request.argc = count_strings(command);
+    request.envc = count_strings(env);
+    request.cgroup_fd_count = (uint32_t)cgroup_fd_count;
+    request.flags = env ? 0 : ZYGOTE_INHERIT_ENV;
+    if (request.argc > ZYGOTE_ARGV_MAX || request.envc > ZYGOTE_ARGV_MAX) {
+        errno = E2BIG;
+        return -1;
+    }
+    vector<char> buffer(sizeof(request));
+    pack_strings(buffer, command);
+    pack_strings(buffer, env);
+    if (buffer.size() > ZYGOTE_REQUEST_MAX) {
+        errno = E2BIG;
+        return -1;
+    }
+    int fds[3 + ZYGOTE_MAX_CGROUP_FDS] = { STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO };
+    for (int i = 0; stdio_fds && i < 3; i++) {
+        if (stdio_fds[i] >= 0) fds[i] = stdio_fds[i];
+    }
+    for (int i = 0; i < cgroup_fd_count; i++) {
+        fds[3 + i] = cgroup_fds[i];
+    }
+    int fd_count = 3 + cgroup_fd_count;
+    char control[CMSG_SPACE(sizeof(fds))];
+    memset(control, 0, sizeof(control));
+    struct iovec iov;
+    iov.iov_len = buffer.size();
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = CMSG_SPACE(sizeof(int) * fd_count);
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int) * fd_count);
+    memcpy(CMSG_DATA(cmsg), fds, sizeof(int) * fd_count);
+    zygote_reply_t reply;
+    struct ucred cred;
+    memset(&cred, 0, sizeof(cred));
+    int worker_fd = -1;
+    ssize_t n;
+    {
+        lock_guard<mutex> guard(zygote->spawn_lock);
+        request.cookie = ++zygote->next_cookie;
+        memcpy(buffer.data(), &request, sizeof(request));
+        iov.iov_base = buffer.data();
+        do {
+            n = sendmsg(zygote->channel_fd, &msg, MSG_NOSIGNAL);
+        } while (n < 0 && errno == EINTR);
+        if (n != (ssize_t)buffer.size()) {
+            perror("send spawn request failed");
+            return -1;
+        }
+        char reply_control[CMSG_SPACE(sizeof(struct ucred)) + CMSG_SPACE(sizeof(int))];
+        struct iovec reply_iov;
+        reply_iov.iov_base = &reply;
+        reply_iov.iov_len = sizeof(reply);
+        struct msghdr reply_msg;
+        memset(&reply_msg, 0, sizeof(reply_msg));
+        reply_msg.msg_iov = &reply_iov;
+        reply_msg.msg_iovlen = 1;
+        reply_msg.msg_control = reply_control;
+        reply_msg.msg_controllen = sizeof(reply_control);
+        do {
+            n = recvmsg(zygote->channel_fd, &reply_msg, MSG_CMSG_CLOEXEC);
+        } while (n < 0 && errno == EINTR);
+        for (struct cmsghdr *reply_cmsg = n > 0 ? CMSG_FIRSTHDR(&reply_msg) : nullptr; reply_cmsg;
+             reply_cmsg = CMSG_NXTHDR(&reply_msg, reply_cmsg)) {
+            if (reply_cmsg->cmsg_level != SOL_SOCKET) {
+                continue;
+            }
+            if (reply_cmsg->cmsg_type == SCM_CREDENTIALS) {
+                memcpy(&cred, CMSG_DATA(reply_cmsg), sizeof(cred));
+            } else if (reply_cmsg->cmsg_type == SCM_RIGHTS) {
+                memcpy(&worker_fd, CMSG_DATA(reply_cmsg), sizeof(int));
+            }
+        }
+    }
+    if (pidfd) {
+        *pidfd = -1;
+    }
+    if (n != (ssize_t)sizeof(reply) || reply.cookie != request.cookie || reply.error != 0 || cred.pid <= 0 || !pidfd) {
+        if (worker_fd >= 0) {
+            close(worker_fd);
+        }
+        worker_fd = -1;
+    }
+    if (n != (ssize_t)sizeof(reply) || reply.cookie != request.cookie) {
+        fprintf(stderr, "zygote %d did not answer spawn request\n", zygote->pid);
+        errno = EPIPE;
+        return -1;
+    }
+    if (reply.error != 0) {
+        fprintf(stderr, "exec %s failed: %s\n", command[0], strerror(reply.error));
+        errno = reply.error;
+        return -1;
+    }
+    if (cred.pid <= 0) {
+        errno = ESRCH;
+        return -1;
+    }
+    if (pidfd) {
+        *pidfd = worker_fd;
+    }
+    lock_guard<mutex> guard(zygote->wait_lock);
+    zygote->cookies[cred.pid] = request.cookie;
+    return cred.pid;
+}
+static void read_exits(zygote_t *zygote, int timeout_ms, vector<zygote_reply_t> &exits, bool *closed) {
+    struct pollfd pfd;
+    pfd.fd = zygote->exit_fd;
+    pfd.events = POLLIN;
+    if (poll(&pfd, 1, timeout_ms) <= 0) {
+        return;
+    }
+    while (exits.size() < ZYGOTE_EXIT_BATCH) {
+        zygote_reply_t exit;
+        ssize_t n = recv(zygote->exit_fd, &exit, sizeof(exit), MSG_DONTWAIT);
+        if (n == (ssize_t)sizeof(exit)) {
+            exits.push_back(exit);
+            continue;
+        }
+        if (n == 0 || (n < 0 && errno != EAGAIN && errno != EINTR)) {
+            *closed = true;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        break;
+    }
+}
+int zygote_wait(zygote_t *zygote, pid_t pid, int timeout_ms, int *status) {
+    if (!zygote || pid <= 0) {
+        return -1;
+    }
+    auto deadline = chrono::steady_clock::now() + chrono::milliseconds(timeout_ms < 0 ? 0 : timeout_ms);
+    unique_lock<mutex> guard(zygote->wait_lock);
+    auto known = zygote->cookies.find(pid);
+    if (known == zygote->cookies.end()) {
+        return -1;
+    }
+    uint64_t cookie = known->second;
+    while (true) {
+        auto done = zygote->exits.find(cookie);
+        if (done != zygote->exits.end()) {
+            if (status) {
+                *status = done->second;
+            }
+            zygote->exits.erase(done);
+            zygote->cookies.erase(pid);
+            return 0;
+        }
+        if (zygote->closed) {
+            zygote->cookies.erase(pid);
+            return -1;
+        }
+        int remaining = -1;
+        if (timeout_ms >= 0) {
+            auto left = chrono::duration_cast<chrono::milliseconds>(deadline - chrono::steady_clock::now()).count();
+            if (left <= 0 && timeout_ms > 0) {
+                return 1;
+            }
+            remaining = left > 0 ? (int)left : 0;
+        }
+        if (zygote->reading) {
+            if (remaining < 0) {
+                zygote->exited.wait(guard);
+            } else {
+                zygote->exited.wait_for(guard, chrono::milliseconds(remaining));
+            }
+            continue;
+        }
+        zygote->reading = true;
+        guard.unlock();
+        vector<zygote_reply_t> exits;
+        bool closed = false;
+        read_exits(zygote, remaining, exits, &closed);
+        guard.lock();
+        zygote->reading = false;
+        for (size_t i = 0; i < exits.size(); i++) {
+            zygote->exits[exits[i].cookie] = exits[i].status;
+        }
+        if (closed) {
+            zygote->closed = true;
+        }
+        zygote->exited.notify_all();
+        if (timeout_ms == 0 && exits.empty() && !closed) {
+            return 1;
+        }
+    }
+}